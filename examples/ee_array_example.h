@@ -0,0 +1,58 @@
+#ifndef EE_ARRAY_EXAMPLE_H
+#define EE_ARRAY_EXAMPLE_H
+
+// Warning that 'fprintf' is not inlined (we do not care)
+#pragma warning(disable : 4710)
+
+#include "ee_array.h"
+
+#ifndef EE_ARRAY_EXAMPLE_LEN
+#define EE_ARRAY_EXAMPLE_LEN    (100)
+#endif
+
+// Pushes past a one element capacity, where a 1.5x byte grow alone is less than one more element
+EE_INLINE void ee_array_check_grow(size_t elem_size)
+{
+	Array array = ee_array_new(1, elem_size, NULL);
+	u8 elem[64] = { 0 };
+
+	EE_ASSERT(elem_size <= sizeof(elem), "Invalid example elem_size (%zu)", elem_size);
+
+	for (size_t i = 0; i < EE_ARRAY_EXAMPLE_LEN; ++i)
+	{
+		memset(elem, (int)(i & 0xFF), elem_size);
+
+		if (i % 3 == 0)
+			ee_array_push(&array, elem);
+		else if (i % 3 == 1)
+			memcpy(ee_array_emplace(&array), elem, elem_size);
+		else
+			ee_array_insert(&array, ee_array_len(&array), elem);
+
+		EE_ASSERT(array.top <= array.cap, "Array top (%zu) is past its capacity (%zu)", array.top, array.cap);
+		EE_ASSERT(array.cap % elem_size == 0, "Array capacity (%zu) is not a multiple of (%zu)", array.cap, elem_size);
+	}
+
+	EE_ASSERT(ee_array_len(&array) == EE_ARRAY_EXAMPLE_LEN, "Invalid Array length (%zu)", ee_array_len(&array));
+
+	for (size_t i = 0; i < EE_ARRAY_EXAMPLE_LEN; ++i)
+	{
+		EE_ASSERT(ee_array_at(&array, i)[elem_size - 1] == (u8)(i & 0xFF), "Array element (%zu) was overwritten", i);
+	}
+
+	ee_array_free(&array);
+}
+
+void run_array_grow_example(void)
+{
+	size_t sizes[] = { 1, 3, 8, 24 };
+
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+	{
+		ee_array_check_grow(sizes[s]);
+	}
+
+	EE_PRINTLN("Array grow example passed");
+}
+
+#endif // EE_ARRAY_EXAMPLE_H
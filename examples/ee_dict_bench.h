@@ -0,0 +1,606 @@
+#ifndef EE_DICT_BENCH_H
+#define EE_DICT_BENCH_H
+
+// Warning that 'fprintf' is not inlined (we do not care)
+#pragma warning(disable : 4710)
+
+// Define EE_NO_ASSERT before including this file to measure the release configuration
+
+#include "ee_dict.h"
+#include "ee_dict_io.h"
+#include "ee_random.h"
+#include "ee_profiler.h"
+
+#ifndef EE_BENCH_DICT_SIZE
+#define EE_BENCH_DICT_SIZE    (EE_NMB(4))
+#endif
+
+EE_INLINE f64 ee_bench_elapsed(ProfTicks start, ProfTicks end)
+{
+	ProfTicks freq;
+	EE_PROF_GET_FREQ(&freq);
+
+	return EE_PROF_TICKS_TO_SEC(start, end, freq);
+}
+
+EE_INLINE void ee_bench_report(const char* name, size_t ops, f64 sec)
+{
+	EE_PRINTLN("%-40s %10.3f ms  %8.2f ns/op", name, sec * 1e3, sec * 1e9 / (f64)ops);
+}
+
+// Batched lookup benchmark, compares a loop of 'ee_dict_at' calls against 'ee_dict_at_batch'
+// The table is sized well past the last level cache so every probe is a cache miss
+void run_dict_bench_at_batch(void)
+{
+	size_t count = EE_BENCH_DICT_SIZE;
+	Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+
+	Dict dict = ee_dict_def_m(count, u64, u64);
+
+	u64* keys = (u64*)malloc(count * sizeof(u64));
+	u8** ptrs = (u8**)malloc(count * sizeof(u8*));
+
+	EE_ASSERT(keys != NULL && ptrs != NULL, "Unable to allocate benchmark buffers");
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		u64 key = ee_rand_u64(&rng);
+		u64 val = (u64)i;
+
+		keys[i] = key;
+		ee_dict_set(&dict, EE_RECAST_U8(key), EE_RECAST_U8(val));
+	}
+
+	// Half of the queries miss, keys are reshuffled so the lookups do not follow insertion order
+	for (size_t i = 0; i < count; ++i)
+	{
+		size_t j = (size_t)ee_rand_u64_b(&rng, count);
+		u64 temp = keys[i];
+
+		keys[i] = keys[j];
+		keys[j] = temp;
+
+		if (i & 1)
+			keys[i] = ee_rand_u64(&rng);
+	}
+
+	ProfTicks start, end;
+	size_t found_loop = 0;
+	size_t found_batch = 0;
+
+	EE_PROF_GET_TICKS(&start);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		ptrs[i] = ee_dict_at(&dict, EE_RECAST_U8(keys[i]));
+		found_loop += (ptrs[i] != NULL);
+	}
+
+	EE_PROF_GET_TICKS(&end);
+	ee_bench_report("ee_dict_at loop", count, ee_bench_elapsed(start, end));
+
+	EE_PROF_GET_TICKS(&start);
+
+	found_batch = ee_dict_at_batch(&dict, (const u8*)keys, count, ptrs);
+
+	EE_PROF_GET_TICKS(&end);
+	ee_bench_report("ee_dict_at_batch", count, ee_bench_elapsed(start, end));
+
+	EE_ASSERT(found_loop == found_batch, "Batch lookup mismatch (%zu) vs (%zu)", found_batch, found_loop);
+
+	free(keys);
+	free(ptrs);
+	ee_dict_free(&dict);
+}
+
+// Grow latency benchmark, reports the worst single 'ee_dict_set' for full and incremental grow
+void run_dict_bench_grow_latency(void)
+{
+	const char* names[] = { "ee_dict_set max latency (full grow)", "ee_dict_set max latency (incremental)" };
+	DictGrowType types[] = { EE_DICT_GROW_FULL, EE_DICT_GROW_INCREMENTAL };
+
+	for (size_t t = 0; t < 2; ++t)
+	{
+		DictConfig config = ee_dict_config_def();
+		config.grow = types[t];
+
+		Dict dict = ee_dict_new_conf_m(EE_DICT_START_SIZE, u64, u64, config);
+		Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+
+		f64 worst = 0.0;
+		f64 total = 0.0;
+
+		for (size_t i = 0; i < EE_BENCH_DICT_SIZE; ++i)
+		{
+			u64 key = ee_rand_u64(&rng);
+			ProfTicks start, end;
+
+			EE_PROF_GET_TICKS(&start);
+			ee_dict_set(&dict, EE_RECAST_U8(key), EE_RECAST_U8(i));
+			EE_PROF_GET_TICKS(&end);
+
+			f64 sec = ee_bench_elapsed(start, end);
+
+			total += sec;
+			worst = sec > worst ? sec : worst;
+		}
+
+		ee_bench_report(names[t], 1, worst);
+		ee_bench_report("  total", EE_BENCH_DICT_SIZE, total);
+
+		ee_dict_free(&dict);
+	}
+}
+
+typedef struct BenchAllocStats
+{
+	size_t current;
+	size_t peak;
+} BenchAllocStats;
+
+EE_INLINE void* ee_bench_alloc(Allocator* allocator, size_t size)
+{
+	BenchAllocStats* stats = (BenchAllocStats*)allocator->context;
+	size_t* block = (size_t*)malloc(size + sizeof(size_t) * 2);
+
+	EE_ASSERT(block != NULL, "Unable to allocate (%zu) bytes", size);
+
+	block[0] = size;
+	stats->current += size;
+	stats->peak = stats->current > stats->peak ? stats->current : stats->peak;
+
+	return &block[2];
+}
+
+EE_INLINE void ee_bench_free(Allocator* allocator, void* buffer)
+{
+	if (buffer == NULL)
+		return;
+
+	BenchAllocStats* stats = (BenchAllocStats*)allocator->context;
+	size_t* block = (size_t*)buffer - 2;
+
+	stats->current -= block[0];
+	free(block);
+}
+
+EE_INLINE void* ee_bench_realloc(Allocator* allocator, void* buffer, size_t old_size, size_t new_size)
+{
+	void* out = ee_bench_alloc(allocator, new_size);
+
+	if (buffer != NULL)
+	{
+		memcpy(out, buffer, old_size < new_size ? old_size : new_size);
+		ee_bench_free(allocator, buffer);
+	}
+
+	return out;
+}
+
+// Old rehash strategy, builds a second table and reinserts all live entries
+EE_INLINE void ee_bench_copy_rehash(Dict* dict)
+{
+	Dict out = ee_dict_new(dict->cap, dict->key_len, dict->val_len, ee_dict_get_config(dict));
+
+	for (size_t i = 0; i < dict->cap; ++i)
+	{
+		if (dict->ctrl.buffer[i] & 0x80)
+			continue;
+
+		ee_dict_insert(&out, ee_dict_key_at(dict, i), ee_dict_val_at(dict, i));
+	}
+
+	ee_dict_free(dict);
+
+	*dict = out;
+}
+
+// Delete heavy benchmark, compares the copying tombstone rehash against the in place 'ee_dict_rehash'
+// Peak memory is tracked with a counting allocator, the in place version never holds two tables
+void run_dict_bench_rehash(void)
+{
+	const char* names[] = { "copy rehash", "in place rehash" };
+	size_t count = EE_BENCH_DICT_SIZE;
+
+	u64* keys = (u64*)malloc(count * sizeof(u64));
+	EE_ASSERT(keys != NULL, "Unable to allocate benchmark buffers");
+
+	for (size_t t = 0; t < 2; ++t)
+	{
+		BenchAllocStats stats = { 0 };
+		Allocator allocator = { ee_bench_alloc, ee_bench_realloc, ee_bench_free, &stats };
+
+		DictConfig config = ee_dict_config_def();
+		config.allocator = &allocator;
+
+		Dict dict = ee_dict_new_conf_m(count * 2, u64, u64, config);
+		Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			keys[i] = ee_rand_u64(&rng);
+			ee_dict_set(&dict, EE_RECAST_U8(keys[i]), EE_RECAST_U8(i));
+		}
+
+		// Every 8th key is removed to leave tombstones spread over the whole table
+		for (size_t i = 0; i < count; i += 8)
+			ee_dict_remove(&dict, EE_RECAST_U8(keys[i]));
+
+		size_t table_bytes = stats.current;
+		stats.peak = stats.current;
+
+		ProfTicks start, end;
+
+		EE_PROF_GET_TICKS(&start);
+
+		if (t == 0)
+			ee_bench_copy_rehash(&dict);
+		else
+			ee_dict_rehash(&dict);
+
+		EE_PROF_GET_TICKS(&end);
+
+		ee_bench_report(names[t], count, ee_bench_elapsed(start, end));
+		EE_PRINTLN("  peak memory %.2fx of table (%zu bytes)", (f64)stats.peak / (f64)table_bytes, stats.peak);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			u8* val = ee_dict_at(&dict, EE_RECAST_U8(keys[i]));
+			EE_ASSERT((val != NULL) == ((i & 7) != 0), "Entry (%zu) is corrupted after rehash", i);
+		}
+
+		ee_dict_free(&dict);
+	}
+
+	free(keys);
+}
+
+// Hit lookups for split and interleaved layouts, 'len' is the key and value size (4 or 8 bytes)
+// Interleaved slots keep the value next to the key, a hit touches the ctrl line and one slot line
+EE_INLINE void ee_bench_layout(size_t len, DictLayout layout, f64 load)
+{
+	DictConfig config = ee_dict_config_def();
+	config.layout = layout;
+
+	Dict dict = ee_dict_new(EE_BENCH_DICT_SIZE, len, len, config);
+	Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+
+	size_t count = (size_t)((f64)dict.cap * load);
+	u64* keys = (u64*)malloc(count * sizeof(u64));
+
+	EE_ASSERT(keys != NULL, "Unable to allocate benchmark buffers");
+
+	// Keys are truncated to 'len' bytes by the Dict, duplicates only overwrite
+	for (size_t i = 0; i < count; ++i)
+	{
+		keys[i] = ee_rand_u64(&rng);
+		ee_dict_set(&dict, EE_RECAST_U8(keys[i]), EE_RECAST_U8(i));
+	}
+
+	ProfTicks start, end;
+	u64 sum = 0;
+
+	EE_PROF_GET_TICKS(&start);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		size_t j = (size_t)ee_rand_u64_b(&rng, count);
+		u64 val = 0;
+
+		memcpy(&val, ee_dict_at(&dict, EE_RECAST_U8(keys[j])), len);
+		sum += val;
+	}
+
+	EE_PROF_GET_TICKS(&end);
+
+	EE_PRINTLN("u%-3zu %-12s load %.2f  %8.2f ns/op  (%llu)", len * 8, layout == EE_DICT_LAYOUT_SPLIT ? "split" : "interleaved",
+		load, ee_bench_elapsed(start, end) * 1e9 / (f64)count, (unsigned long long)(sum & 1));
+
+	free(keys);
+	ee_dict_free(&dict);
+}
+
+void run_dict_bench_layout(void)
+{
+	f64 loads[] = { 0.25, 0.50, 0.75, 0.85 };
+	DictLayout layouts[] = { EE_DICT_LAYOUT_SPLIT, EE_DICT_LAYOUT_INTERLEAVED };
+
+	for (size_t l = 0; l < sizeof(loads) / sizeof(loads[0]); ++l)
+	{
+		for (size_t t = 0; t < 2; ++t)
+			ee_bench_layout(sizeof(u32), layouts[t], loads[l]);
+
+		for (size_t t = 0; t < 2; ++t)
+			ee_bench_layout(sizeof(u64), layouts[t], loads[l]);
+	}
+}
+
+EE_INLINE i32 ee_bench_scan_visit(const u8* key, u8* val, void* context)
+{
+	EE_UNUSED(key);
+
+	*(u64*)context += *(const u64*)val;
+
+	return EE_TRUE;
+}
+
+// Full table scans at several loads: slot-by-slot 'ee_dict_iter_next_ptr', 'ee_dict_iter_sp_next_ptr',
+// group-at-a-time 'ee_dict_scan_next', 'ee_dict_for_each' and 'ee_dict_export' into Arrays
+void run_dict_bench_scan(void)
+{
+	const char* names[] = { "iter_next_ptr", "iter_sp_next_ptr", "scan_next", "for_each", "export" };
+	f64 loads[] = { 0.01, 0.10, 0.50, 0.85 };
+
+	for (size_t l = 0; l < sizeof(loads) / sizeof(loads[0]); ++l)
+	{
+		Dict dict = ee_dict_def_m(EE_BENCH_DICT_SIZE, u64, u64);
+		Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+
+		size_t count = (size_t)((f64)dict.cap * loads[l]);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			u64 key = ee_rand_u64(&rng);
+			ee_dict_set(&dict, EE_RECAST_U8(key), EE_RECAST_U8(i));
+		}
+
+		EE_PRINTLN("load %.2f (%zu entries, %zu slots)", loads[l], ee_dict_count(&dict), (size_t)dict.cap);
+
+		for (size_t t = 0; t < 5; ++t)
+		{
+			Array keys = ee_array_new(1, sizeof(u64), NULL);
+			Array vals = ee_array_new(1, sizeof(u64), NULL);
+
+			ProfTicks start, end;
+			u64 sum = 0;
+			size_t seen = 0;
+
+			EE_PROF_GET_TICKS(&start);
+
+			if (t == 4)
+			{
+				seen = ee_dict_export(&dict, &keys, &vals);
+			}
+			else if (t == 3)
+			{
+				seen = ee_dict_for_each(&dict, ee_bench_scan_visit, &sum);
+			}
+			else if (t == 2)
+			{
+				DictScan scan = ee_dict_scan_new(&dict);
+				u8* key = NULL;
+				u8* val = NULL;
+
+				while (ee_dict_scan_next(&scan, &key, &val))
+				{
+					sum += *(u64*)val;
+					seen++;
+				}
+			}
+			else
+			{
+				DictIter iter = ee_dict_iter_new(&dict);
+				u8* key = NULL;
+				u8* val = NULL;
+
+				while (t == 0 ? ee_dict_iter_next_ptr(&iter, &key, &val) : ee_dict_iter_sp_next_ptr(&iter, &key, &val))
+				{
+					sum += *(u64*)val;
+					seen++;
+				}
+			}
+
+			EE_PROF_GET_TICKS(&end);
+
+			EE_ASSERT(seen == ee_dict_count(&dict), "Scan (%s) visited (%zu) of (%zu) entries", names[t], seen, ee_dict_count(&dict));
+
+			EE_PRINTLN("  %-20s %10.3f ms  %8.2f ns/slot  (%llu)", names[t], ee_bench_elapsed(start, end) * 1e3,
+				ee_bench_elapsed(start, end) * 1e9 / (f64)dict.cap, (unsigned long long)(sum & 1));
+
+			ee_array_free(&keys);
+			ee_array_free(&vals);
+		}
+
+		ee_dict_free(&dict);
+	}
+}
+
+// Snapshot load benchmark, a loop of 'ee_dict_set' against 'ee_dict_from_arrays' with and without 'assume_unique'
+void run_dict_bench_from_arrays(void)
+{
+	const char* names[] = { "ee_dict_set loop", "ee_dict_from_arrays", "ee_dict_from_arrays (unique)" };
+	size_t count = EE_BENCH_DICT_SIZE;
+
+	Array keys = ee_array_new(count, sizeof(u64), NULL);
+	Array vals = ee_array_new(count, sizeof(u64), NULL);
+
+	// Odd multiplier is a bijection on u64, so the keys are unique
+	for (u64 i = 0; i < count; ++i)
+	{
+		u64 key = (i + 1) * 0x9E3779B97F4A7C15ull;
+
+		ee_array_push(&keys, EE_RECAST_U8(key));
+		ee_array_push(&vals, EE_RECAST_U8(i));
+	}
+
+	for (size_t t = 0; t < 3; ++t)
+	{
+		ProfTicks start, end;
+		Dict dict = { 0 };
+
+		EE_PROF_GET_TICKS(&start);
+
+		if (t == 0)
+		{
+			dict = ee_dict_def_m(EE_DICT_START_SIZE, u64, u64);
+
+			for (size_t i = 0; i < count; ++i)
+				ee_dict_set(&dict, ee_array_at(&keys, i), ee_array_at(&vals, i));
+		}
+		else
+		{
+			dict = ee_dict_from_arrays(&keys, &vals, t == 2, ee_dict_config_def());
+		}
+
+		EE_PROF_GET_TICKS(&end);
+
+		ee_bench_report(names[t], count, ee_bench_elapsed(start, end));
+
+		EE_ASSERT(ee_dict_count(&dict) == count, "Invalid Dict count (%zu), expected (%zu)", ee_dict_count(&dict), count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			u8* val = ee_dict_at(&dict, ee_array_at(&keys, i));
+			EE_ASSERT(val != NULL && *(u64*)val == i, "Entry (%zu) is missing after bulk build", i);
+		}
+
+		ee_dict_free(&dict);
+	}
+
+	ee_array_free(&keys);
+	ee_array_free(&vals);
+}
+
+EE_DICT_DEFINE(DictU64, u64, u64, ee_dict_hash_val_u64, EE_DICT_EQ_VAL)
+EE_DICT_DEFINE(DictU32, u32, u32, ee_dict_hash_val_u32, EE_DICT_EQ_VAL)
+
+// Typed variant benchmark, 'ee_dict_set'/'ee_dict_at' through function pointers against the EE_DICT_DEFINE functions
+// The table is small enough to stay in cache so the call overhead is not hidden behind misses
+void run_dict_bench_typed(void)
+{
+	size_t count = EE_NKB(256);
+	ProfTicks start, end;
+	u64 sum = 0;
+
+	Dict generic = ee_dict_def_m(EE_DICT_START_SIZE, u64, u64);
+	DictU64 typed = DictU64_new(EE_DICT_START_SIZE, NULL);
+
+	EE_PROF_GET_TICKS(&start);
+	for (u64 i = 0; i < count; ++i)
+		ee_dict_set(&generic, EE_RECAST_U8(i), EE_RECAST_U8(i));
+	EE_PROF_GET_TICKS(&end);
+	ee_bench_report("u64 ee_dict_set", count, ee_bench_elapsed(start, end));
+
+	EE_PROF_GET_TICKS(&start);
+	for (u64 i = 0; i < count; ++i)
+		DictU64_set(&typed, i, i);
+	EE_PROF_GET_TICKS(&end);
+	ee_bench_report("u64 EE_DICT_DEFINE set", count, ee_bench_elapsed(start, end));
+
+	for (size_t round = 0; round < 2; ++round)
+	{
+		EE_PROF_GET_TICKS(&start);
+		for (u64 i = 0; i < 2 * count; ++i)
+		{
+			u8* val = ee_dict_at(&generic, EE_RECAST_U8(i));
+			sum += val != NULL ? *(u64*)val : 0;
+		}
+		EE_PROF_GET_TICKS(&end);
+		ee_bench_report("u64 ee_dict_at (50% hits)", 2 * count, ee_bench_elapsed(start, end));
+
+		EE_PROF_GET_TICKS(&start);
+		for (u64 i = 0; i < 2 * count; ++i)
+		{
+			u64* val = DictU64_at(&typed, i);
+			sum -= val != NULL ? *val : 0;
+		}
+		EE_PROF_GET_TICKS(&end);
+		ee_bench_report("u64 EE_DICT_DEFINE at (50% hits)", 2 * count, ee_bench_elapsed(start, end));
+	}
+
+	EE_ASSERT(sum == 0, "Typed and generic lookups disagree");
+
+	// Both share the Dict layout and the hash, so the generic API reads the typed table
+	for (u64 i = 0; i < count; i += 3)
+		DictU64_remove(&typed, i);
+
+	for (u64 i = 0; i < count; ++i)
+	{
+		u8* val = ee_dict_at(&typed.dict, EE_RECAST_U8(i));
+		EE_ASSERT((i % 3 == 0) == (val == NULL), "Typed remove of (%llu) is not visible to ee_dict_at", (unsigned long long)i);
+		EE_UNUSED(val);
+	}
+
+	DictU32 typed_u32 = DictU32_new(EE_DICT_START_SIZE, NULL);
+
+	for (u32 i = 0; i < (u32)count; ++i)
+		DictU32_set(&typed_u32, i * 7u, i);
+
+	for (u32 i = 0; i < (u32)count; ++i)
+		EE_ASSERT(DictU32_contains(&typed_u32, i * 7u) && *DictU32_at(&typed_u32, i * 7u) == i, "Typed u32 key (%u) lost", i * 7u);
+
+	EE_ASSERT(DictU32_count(&typed_u32) == count, "Invalid typed u32 count (%zu)", DictU32_count(&typed_u32));
+
+	DictU32_free(&typed_u32);
+	DictU64_free(&typed);
+	ee_dict_free(&generic);
+}
+
+#ifndef EE_BENCH_DICT_IMAGE_PATH
+#define EE_BENCH_DICT_IMAGE_PATH    "ee_dict_bench.img"
+#endif
+
+// Restart benchmark, rebuilding a table with 'ee_dict_set' against 'ee_dict_map' of a saved image
+// Both sides then touch every key once, so the mapped run pays for its page faults
+void run_dict_bench_image(void)
+{
+	size_t count = EE_BENCH_DICT_SIZE;
+	DictLayout layouts[] = { EE_DICT_LAYOUT_SPLIT, EE_DICT_LAYOUT_INTERLEAVED };
+
+	for (size_t t = 0; t < 2; ++t)
+	{
+		ProfTicks start, end;
+		DictConfig config = ee_dict_config_def();
+
+		config.layout = layouts[t];
+
+		EE_PROF_GET_TICKS(&start);
+
+		Dict dict = ee_dict_new_conf_m(EE_DICT_START_SIZE, u64, u64, config);
+
+		for (u64 i = 0; i < count; ++i)
+		{
+			u64 key = (i + 1) * 0x9E3779B97F4A7C15ull;
+			ee_dict_set(&dict, EE_RECAST_U8(key), EE_RECAST_U8(i));
+		}
+
+		EE_PROF_GET_TICKS(&end);
+		ee_bench_report(t == 0 ? "rebuild (split)" : "rebuild (interleaved)", count, ee_bench_elapsed(start, end));
+
+		EE_PROF_GET_TICKS(&start);
+		ee_dict_save(&dict, EE_BENCH_DICT_IMAGE_PATH);
+		EE_PROF_GET_TICKS(&end);
+		ee_bench_report("ee_dict_save", count, ee_bench_elapsed(start, end));
+
+		EE_PROF_GET_TICKS(&start);
+
+		Dict mapped = ee_dict_map(EE_BENCH_DICT_IMAGE_PATH);
+		u64 sum = 0;
+
+		EE_ASSERT(mapped.image != NULL, "Unable to map Dict image (%s)", EE_BENCH_DICT_IMAGE_PATH);
+
+		for (u64 i = 0; i < count; ++i)
+		{
+			u64 key = (i + 1) * 0x9E3779B97F4A7C15ull;
+			u8* val = ee_dict_at(&mapped, EE_RECAST_U8(key));
+
+			EE_ASSERT(val != NULL && *(u64*)val == i, "Entry (%llu) is missing in the mapped Dict", (unsigned long long)i);
+			sum += *(u64*)val;
+		}
+
+		EE_PROF_GET_TICKS(&end);
+		ee_bench_report("ee_dict_map + first lookups", count, ee_bench_elapsed(start, end));
+
+		EE_ASSERT(ee_dict_count(&mapped) == count, "Invalid mapped Dict count (%zu), expected (%zu)", ee_dict_count(&mapped), count);
+		EE_ASSERT(sum == (u64)count * (count - 1) / 2, "Invalid mapped values checksum");
+
+		EE_ASSERT(ee_dict_at(&mapped, EE_CONST_MAX_U64) == NULL, "Mapped Dict found a key that was never inserted");
+
+		ee_dict_unmap(&mapped);
+		ee_dict_free(&dict);
+
+		remove(EE_BENCH_DICT_IMAGE_PATH);
+	}
+}
+
+#endif // EE_DICT_BENCH_H
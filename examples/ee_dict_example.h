@@ -8,6 +8,9 @@
 // it will increase the performance
 
 #include "ee_dict.h"
+#include "ee_strdict.h"
+#include "ee_hset.h"
+#include "ee_cache.h"
 
 // 16-byte key structure
 typedef struct
@@ -262,4 +265,222 @@ void run_dict_custom_fn_example(void)
 	ee_dict_free(&dict);
 }
 
+// Hash that keeps only the high bits of the key, sequential keys collide on the home group and on the tag
+u64 weak_hash_fn(const u8* key, size_t len)
+{
+	EE_UNUSED(len);
+
+	return *(const u64*)key >> 12;
+}
+
+void print_dict_stats(const char* name, const DictStats* stats)
+{
+	EE_PRINTLN("%s: count (%zu), cap (%zu), load (%.2f), tombs (%zu)", name, stats->count, stats->cap, stats->load, stats->tombs);
+	EE_PRINTLN("  lookups (%llu), inserts (%llu), removes (%llu)", (unsigned long long)stats->lookups, (unsigned long long)stats->inserts, (unsigned long long)stats->removes);
+	EE_PRINTLN("  tag hits (%llu), false (%.2f%%)", (unsigned long long)stats->tag_hits, stats->tag_hits ? 100.0 * (f64)stats->tag_false / (f64)stats->tag_hits : 0.0);
+	EE_PRINTLN("  grows (%llu, %.3f ms), rehashes (%llu, %.3f ms), migrations (%llu, %.3f ms)",
+		(unsigned long long)stats->grows, stats->grow_sec * 1e3,
+		(unsigned long long)stats->rehashes, stats->rehash_sec * 1e3,
+		(unsigned long long)stats->migrations, stats->migrate_sec * 1e3);
+
+	for (size_t i = 0; i < EE_DICT_STATS_PROBES; ++i)
+	{
+		if (stats->probe_lookup[i] == 0 && stats->probe_insert[i] == 0)
+			continue;
+
+		EE_PRINTLN("  probe %2zu%s: lookup (%llu), insert (%llu)", i, i == EE_DICT_STATS_PROBES - 1 ? "+" : " ",
+			(unsigned long long)stats->probe_lookup[i], (unsigned long long)stats->probe_insert[i]);
+	}
+}
+
+// Stats example, compares a weak hash against the default one
+// Occupancy is always reported, define EE_DICT_STATS before including 'ee_dict.h' to also collect the counters
+void run_dict_stats_example(void)
+{
+	DictConfig weak_config = ee_dict_config_def();
+	weak_config.hash_fn = weak_hash_fn;
+
+	Dict weak = ee_dict_new_conf_m(16, u64, u64, weak_config);
+	Dict good = ee_dict_def_m(16, u64, u64);
+
+	for (u64 i = 0; i < 20000; ++i)
+	{
+		ee_dict_set(&weak, EE_RECAST_U8(i), EE_RECAST_U8(i));
+		ee_dict_set(&good, EE_RECAST_U8(i), EE_RECAST_U8(i));
+	}
+
+	for (u64 i = 0; i < 20000; i += 4)
+	{
+		ee_dict_remove(&weak, EE_RECAST_U8(i));
+		ee_dict_remove(&good, EE_RECAST_U8(i));
+	}
+
+	for (u64 i = 0; i < 40000; ++i)
+	{
+		ee_dict_contains(&weak, EE_RECAST_U8(i));
+		ee_dict_contains(&good, EE_RECAST_U8(i));
+	}
+
+	DictStats weak_stats = ee_dict_stats(&weak);
+	DictStats good_stats = ee_dict_stats(&good);
+
+	print_dict_stats("weak hash", &weak_stats);
+	print_dict_stats("default hash", &good_stats);
+
+	ee_dict_free(&weak);
+	ee_dict_free(&good);
+}
+
+// String keys example, keys of any length are copied into the StrDict slab, slots only hold (hash, pointer, len) records
+void run_strdict_example(void)
+{
+	StrDict sdict = ee_strdict_new_m(16, u32);
+
+	const char* words[] = { "a", "hash", "map", "with", "variable", "length", "keys", "stored", "in", "a", "slab" };
+	size_t words_count = sizeof(words) / sizeof(words[0]);
+
+	// Counting words, "a" appears twice so it is inserted once and then updated in place
+	for (size_t i = 0; i < words_count; ++i)
+	{
+		u8* count_at = ee_strdict_at_cstr(&sdict, words[i]);
+		u32 count = count_at == NULL ? 1 : *(u32*)count_at + 1;
+
+		ee_strdict_set_cstr(&sdict, words[i], EE_RECAST_U8(count));
+	}
+
+	EE_ASSERT(ee_strdict_count(&sdict) == words_count - 1, "Invalid StrDict count (%zu)", ee_strdict_count(&sdict));
+	EE_ASSERT(*(u32*)ee_strdict_at_cstr(&sdict, "a") == 2, "Invalid count for \"a\"");
+
+	// Keys do not have to be NUL-terminated, here "hashmap" is looked up as "hash"
+	EE_ASSERT(ee_strdict_contains(&sdict, "hashmap", 4) == EE_TRUE, "Prefix lookup failed");
+	EE_ASSERT(ee_strdict_contains(&sdict, "hashmap", 7) == EE_FALSE, "Found a key that was never inserted");
+
+	ee_strdict_remove_cstr(&sdict, "variable");
+	ee_strdict_remove_cstr(&sdict, "length");
+
+	// Removed keys keep their slab bytes until compaction
+	EE_PRINTLN("Dead slab bytes before compaction: (%zu)", sdict.dead);
+	ee_strdict_compact(&sdict);
+
+	DictIter iter = ee_dict_iter_new(&sdict.dict);
+	const DictStrKey* key = NULL;
+	u8* val = NULL;
+
+	while (ee_strdict_iter_next(&iter, &key, &val))
+	{
+		EE_PRINTLN("(%s, %u)", key->str, *(u32*)val);
+	}
+
+	ee_strdict_free(&sdict);
+}
+
+// Hash set example, a Dict without values: batched inserts, lookups, union and intersection
+void run_hset_example(void)
+{
+	HashSet evens = ee_hset_new_m(16, u64);
+	HashSet thirds = ee_hset_new_m(16, u64);
+
+	u64 keys[300];
+
+	for (u64 i = 0; i < 300; ++i)
+	{
+		keys[i] = i * 2;
+	}
+
+	// Inserting the same keys twice adds nothing the second time
+	size_t added = ee_hset_insert_batch(&evens, (const u8*)keys, 300);
+	added += ee_hset_insert_batch(&evens, (const u8*)keys, 300);
+
+	EE_ASSERT(added == 300, "Invalid number of added keys (%zu)", added);
+
+	for (u64 i = 0; i < 200; ++i)
+	{
+		u64 key = i * 3;
+		ee_hset_insert(&thirds, EE_RECAST_U8(key));
+	}
+
+	u8 flags[300];
+	size_t found = ee_hset_contains_batch(&thirds, (const u8*)keys, 300, flags);
+
+	// Multiples of 6 below 600
+	EE_ASSERT(found == 100, "Invalid batch lookup count (%zu)", found);
+
+	HashSet both = ee_hset_new_m(16, u64);
+
+	ee_hset_union(&both, &evens);
+	ee_hset_intersect(&both, &thirds);
+
+	EE_ASSERT(ee_hset_count(&both) == 100, "Invalid intersection count (%zu)", ee_hset_count(&both));
+
+	ee_hset_union(&evens, &thirds);
+
+	// 300 evens, 200 multiples of 3 and 100 of them shared
+	EE_ASSERT(ee_hset_count(&evens) == 400, "Invalid union count (%zu)", ee_hset_count(&evens));
+
+	ee_hset_free(&both);
+	ee_hset_free(&thirds);
+	ee_hset_free(&evens);
+}
+
+static u64 _ee_cache_example_clock(void* context)
+{
+	return *(const u64*)context;
+}
+
+// Bounded cache example: CLOCK eviction keeps the referenced entries, TTLs run on a fake clock
+void run_cache_example(void)
+{
+	u64 now = 1;
+
+	DictCache cache = ee_cache_new_m(64, u64, u64, 100);
+	ee_cache_set_clock(&cache, _ee_cache_example_clock, &now);
+
+	for (u64 i = 0; i < 64; ++i)
+	{
+		u64 val = i * 10;
+		ee_cache_set(&cache, EE_RECAST_U8(i), EE_RECAST_U8(val));
+	}
+
+	// The first eviction takes a full CLOCK round that clears every reference byte, keys touched after it survive
+	u64 extra = 1000;
+	ee_cache_set(&cache, EE_RECAST_U8(extra), EE_RECAST_U8(extra));
+
+	u8 touched[8];
+
+	for (u64 i = 0; i < 8; ++i)
+	{
+		touched[i] = (u8)ee_cache_contains(&cache, EE_RECAST_U8(i));
+	}
+
+	for (u64 i = 2000; i < 2032; ++i)
+	{
+		ee_cache_set(&cache, EE_RECAST_U8(i), EE_RECAST_U8(i));
+	}
+
+	EE_ASSERT(ee_cache_count(&cache) == 64, "Invalid cache count (%zu)", ee_cache_count(&cache));
+
+	for (u64 i = 0; i < 8; ++i)
+	{
+		EE_ASSERT(!touched[i] || ee_cache_contains(&cache, EE_RECAST_U8(i)), "Referenced key (%llu) was evicted", (unsigned long long)i);
+	}
+
+	// Entries without a TTL outlive the default one
+	u64 pinned = 5000;
+	ee_cache_set_ttl(&cache, EE_RECAST_U8(pinned), EE_RECAST_U8(pinned), EE_CACHE_NO_TTL);
+
+	now += 100;
+
+	size_t expired = ee_cache_expire(&cache);
+
+	EE_ASSERT(expired == 63, "Invalid number of expired entries (%zu)", expired);
+	EE_ASSERT(ee_cache_contains(&cache, EE_RECAST_U8(pinned)), "Entry without TTL has expired");
+
+	DictCacheStats stats = ee_cache_stats(&cache);
+	EE_PRINTLN("cache count %zu/%zu, hits %llu, misses %llu, evictions %llu, expirations %llu, hit rate %.2f",
+		stats.count, stats.max_entries, (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+		(unsigned long long)stats.evictions, (unsigned long long)stats.expirations, stats.hit_rate);
+
+	ee_cache_free(&cache);
+}
+
 #endif // EE_DICT_EXAMPLE_H
@@ -0,0 +1,67 @@
+#ifndef EE_DICT_MT_BENCH_H
+#define EE_DICT_MT_BENCH_H
+
+// Warning that 'fprintf' is not inlined (we do not care)
+#pragma warning(disable : 4710)
+
+#include "ee_dict_mt.h"
+#include "ee_dict_bench.h"
+
+#ifndef EE_BENCH_DICT_MT_SIZE
+#define EE_BENCH_DICT_MT_SIZE    (EE_NMB(16))
+#endif
+
+// Bulk build and doubling of a large table on 1..cpu count threads, one thread falls back to the serial paths
+void run_dict_bench_mt(void)
+{
+	size_t count = EE_BENCH_DICT_MT_SIZE;
+	size_t cpus = (size_t)ee_get_cpu_count();
+
+	u64* keys = (u64*)malloc(count * sizeof(u64));
+	u64* vals = (u64*)malloc(count * sizeof(u64));
+
+	EE_ASSERT(keys != NULL && vals != NULL, "Unable to allocate benchmark buffers");
+
+	for (u64 i = 0; i < count; ++i)
+	{
+		keys[i] = (i + 1) * 0x9E3779B97F4A7C15ull;
+		vals[i] = i;
+	}
+
+	EE_PRINTLN("cpu count %zu", cpus);
+
+	for (size_t threads = 1; threads <= cpus; threads *= 2)
+	{
+		char name[64];
+		ProfTicks start, end;
+
+		EE_PROF_GET_TICKS(&start);
+		Dict dict = ee_dict_from_buffers_mt((const u8*)keys, (const u8*)vals, count, sizeof(u64), sizeof(u64), EE_TRUE, ee_dict_config_def(), threads);
+		EE_PROF_GET_TICKS(&end);
+
+		snprintf(name, sizeof(name), "from_buffers_mt (%zu threads)", threads);
+		ee_bench_report(name, count, ee_bench_elapsed(start, end));
+
+		EE_PROF_GET_TICKS(&start);
+		ee_dict_grow_mt(&dict, dict.cap * 2, threads);
+		EE_PROF_GET_TICKS(&end);
+
+		snprintf(name, sizeof(name), "grow_mt (%zu threads)", threads);
+		ee_bench_report(name, count, ee_bench_elapsed(start, end));
+
+		EE_ASSERT(ee_dict_count(&dict) == count, "Invalid Dict count (%zu), expected (%zu)", ee_dict_count(&dict), count);
+
+		for (size_t i = 0; i < count; i += 97)
+		{
+			u8* val = ee_dict_at(&dict, EE_RECAST_U8(keys[i]));
+			EE_ASSERT(val != NULL && *(u64*)val == i, "Entry (%zu) is missing after parallel build", i);
+		}
+
+		ee_dict_free(&dict);
+	}
+
+	free(keys);
+	free(vals);
+}
+
+#endif // EE_DICT_MT_BENCH_H
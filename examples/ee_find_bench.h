@@ -0,0 +1,83 @@
+#ifndef EE_FIND_BENCH_H
+#define EE_FIND_BENCH_H
+
+// Warning that 'fprintf' is not inlined (we do not care)
+#pragma warning(disable : 4710)
+
+#include "ee_array.h"
+#include "ee_dict_bench.h"
+
+#ifndef EE_BENCH_FIND_SIZE
+#define EE_BENCH_FIND_SIZE    (EE_NMB(1))
+#endif
+
+// Counts and collects the copies of one id in EE_BENCH_FIND_SIZE random 'elem_size' byte ids,
+// at the scalar level and at the detected one. Times are per scanned element
+EE_INLINE void ee_bench_find(size_t elem_size)
+{
+	size_t count = EE_BENCH_FIND_SIZE;
+	Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+	Array array = ee_array_new(count, elem_size, NULL);
+	Array found = ee_array_new(EE_NKB(1), sizeof(size_t), NULL);
+	i32 levels[] = { EE_SIMD_LEVEL_NONE, ee_simd_level() };
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		u8* elem = ee_array_emplace(&array);
+
+		for (size_t b = 0; b < elem_size; b += sizeof(u64))
+		{
+			u64 bits = ee_rand_u64(&rng);
+			memcpy(&elem[b], &bits, ee_min_u64(sizeof(u64), elem_size - b));
+		}
+	}
+
+	// Every 4096th element is the needle
+	u8* target = ee_array_at(&array, 0);
+
+	for (size_t i = 4096; i < count; i += 4096)
+	{
+		ee_array_set(&array, i, target);
+	}
+
+	for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); ++l)
+	{
+		ProfTicks start, end;
+		char label[64];
+
+		ee_simd_force_level(levels[l]);
+
+		EE_PROF_GET_TICKS(&start);
+		size_t hits = ee_array_count(&array, target);
+		EE_PROF_GET_TICKS(&end);
+
+		snprintf(label, sizeof(label), "%zu B count, level %d", elem_size, levels[l]);
+		ee_bench_report(label, count, ee_bench_elapsed(start, end));
+
+		ee_array_clear(&found);
+
+		EE_PROF_GET_TICKS(&start);
+		size_t pushed = ee_array_find_all(&array, target, &found);
+		EE_PROF_GET_TICKS(&end);
+
+		snprintf(label, sizeof(label), "%zu B find all, level %d", elem_size, levels[l]);
+		ee_bench_report(label, count, ee_bench_elapsed(start, end));
+
+		EE_ASSERT(hits == (count - 1) / 4096 + 1 && pushed == hits, "Find mismatch, counted (%zu) found (%zu)", hits, pushed);
+	}
+
+	ee_array_free(&array);
+	ee_array_free(&found);
+}
+
+void run_array_bench_find(void)
+{
+	size_t sizes[] = { 4, 8, 12, 16, 24, 32 };
+
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+	{
+		ee_bench_find(sizes[s]);
+	}
+}
+
+#endif // EE_FIND_BENCH_H
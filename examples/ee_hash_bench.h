@@ -0,0 +1,443 @@
+#ifndef EE_HASH_BENCH_H
+#define EE_HASH_BENCH_H
+
+// Warning that 'fprintf' is not inlined (we do not care)
+#pragma warning(disable : 4710)
+
+// Define EE_NO_ASSERT before including this file to measure the release configuration
+
+#include "ee_dict_bench.h"
+
+#ifndef EE_BENCH_HASH_BYTES
+#define EE_BENCH_HASH_BYTES        (EE_NMB(64))
+#endif
+
+#ifndef EE_BENCH_HASH_DICT_SIZE
+#define EE_BENCH_HASH_DICT_SIZE    (EE_NMB(1))
+#endif
+
+#define EE_BENCH_HASH_BUF          (EE_NMB(1))
+#define EE_BENCH_HASH_TRIALS       (4096)
+#define EE_BENCH_HASH_BUCKETS      (4096)
+
+// Key sets whose bucket chi^2 / df is past this are not inserted, every probe would walk one long cluster
+#define EE_BENCH_HASH_DEGENERATE   (64.0)
+
+typedef struct BenchHash
+{
+	const char* name;
+	DictHash    fn;
+	size_t      key_len; // 0 for any length
+} BenchHash;
+
+typedef enum BenchKeys
+{
+	EE_BENCH_KEYS_SEQ,
+	EE_BENCH_KEYS_RANDOM,
+	EE_BENCH_KEYS_STRIDE_4K,
+	EE_BENCH_KEYS_STRIDE_4G,
+	EE_BENCH_KEYS_COUNT,
+} BenchKeys;
+
+static const char* ee_bench_keys_names[EE_BENCH_KEYS_COUNT] = { "sequential", "random", "stride 2^12", "stride 2^32" };
+
+static const BenchHash ee_bench_hashes[] =
+{
+	{ "ee_hash_u32_fast",    ee_hash_u32_fast,    sizeof(u32) },
+	{ "ee_hash_u32_safe",    ee_hash_u32_safe,    sizeof(u32) },
+	{ "ee_hash_mm_u32_fast", ee_hash_mm_u32_fast, sizeof(u32) },
+	{ "ee_hash_mm_u32_safe", ee_hash_mm_u32_safe, sizeof(u32) },
+	{ "ee_hash_u64_fast",    ee_hash_u64_fast,    sizeof(u64) },
+	{ "ee_hash_u64_safe",    ee_hash_u64_safe,    sizeof(u64) },
+	{ "ee_hash_mm_u64_fast", ee_hash_mm_u64_fast, sizeof(u64) },
+	{ "ee_hash_mm_u64_safe", ee_hash_mm_u64_safe, sizeof(u64) },
+	{ "ee_hash_u128_fast",   ee_hash_u128_fast,   2 * sizeof(u64) },
+	{ "ee_hash_u128_safe",   ee_hash_u128_safe,   2 * sizeof(u64) },
+	{ "ee_hash_u256_fast",   ee_hash_u256_fast,   4 * sizeof(u64) },
+	{ "ee_hash_u256_safe",   ee_hash_u256_safe,   4 * sizeof(u64) },
+	{ "ee_hash_mm",          ee_hash_mm,          0 },
+	{ "ee_hash_fast",        ee_hash_fast,        0 },
+	{ "ee_hash_safe",        ee_hash_safe,        0 },
+};
+
+#define EE_BENCH_HASH_COUNT    (sizeof(ee_bench_hashes) / sizeof(ee_bench_hashes[0]))
+
+// TSC ticks, close to core cycles on CPUs with an invariant TSC
+EE_INLINE u64 ee_bench_cycles(void)
+{
+	return (u64)__rdtsc();
+}
+
+// Buffer aligned to EE_MAX_ALIGN, 'ee_hash_fast' uses aligned loads
+EE_INLINE u8* ee_bench_hash_align(u8* raw)
+{
+	return (u8*)(((uintptr_t)raw + EE_MAX_ALIGN - 1) & ~(uintptr_t)(EE_MAX_ALIGN - 1));
+}
+
+EE_INLINE u64 ee_bench_key(BenchKeys type, u64 i, Rng* rng)
+{
+	switch (type)
+	{
+	case EE_BENCH_KEYS_SEQ:       return i;
+	case EE_BENCH_KEYS_RANDOM:    return ee_rand_u64(rng);
+	case EE_BENCH_KEYS_STRIDE_4K: return i << 12;
+	case EE_BENCH_KEYS_STRIDE_4G: return i << 32;
+	default:                      return i;
+	}
+}
+
+// Hashes 'len' byte keys laid out back to back in a cache resident buffer
+EE_INLINE void ee_bench_hash_speed(const BenchHash* hash, const u8* data, size_t len)
+{
+	size_t per_pass = EE_BENCH_HASH_BUF / len;
+	size_t passes = ee_max_u64(EE_BENCH_HASH_BYTES / EE_BENCH_HASH_BUF, 1);
+	u64 sink = 0;
+
+	ProfTicks start, end;
+	EE_PROF_GET_TICKS(&start);
+	u64 cycles = ee_bench_cycles();
+
+	for (size_t p = 0; p < passes; ++p)
+	{
+		for (size_t i = 0; i < per_pass; ++i)
+		{
+			sink += hash->fn(&data[i * len], len);
+		}
+	}
+
+	cycles = ee_bench_cycles() - cycles;
+	EE_PROF_GET_TICKS(&end);
+
+	f64 keys = (f64)(per_pass * passes);
+	f64 sec = ee_bench_elapsed(start, end);
+
+	EE_PRINTLN("%-20s %5zu B  %8.2f ns/key  %7.2f B/cycle  %8.2f GB/s  (%llu)", hash->name, len, sec * 1e9 / keys,
+		keys * (f64)len / (f64)cycles, keys * (f64)len / sec * 1e-9, (unsigned long long)(sink & 1));
+}
+
+typedef void (*BenchHashMany)(const u8* keys, size_t n, u64* out);
+
+// Scalar hash per key against the bulk kernel on the EE_SIMD_MAX_LEVEL lanes and, when the CPU has it, on AVX-512
+EE_INLINE void ee_bench_hash_many(const char* name, BenchHashMany many, DictHash one, const u8* data, size_t len)
+{
+	static const char* level_names[] = { "lanes", "avx512" };
+
+	size_t count = EE_BENCH_HASH_BUF / len;
+	size_t passes = ee_max_u64(EE_BENCH_HASH_BYTES / EE_BENCH_HASH_BUF, 1);
+	u64* out = (u64*)malloc(count * sizeof(u64));
+	u64 sink = 0;
+
+	EE_ASSERT(out != NULL, "Unable to allocate benchmark buffers");
+
+	ProfTicks start, end;
+	EE_PROF_GET_TICKS(&start);
+
+	for (size_t p = 0; p < passes; ++p)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			out[i] = one(&data[i * len], len);
+		}
+
+		sink += out[p % count];
+	}
+
+	EE_PROF_GET_TICKS(&end);
+	EE_PRINTLN("%-20s %-8s %8.3f ns/key  (%llu)", name, "loop", ee_bench_elapsed(start, end) * 1e9 / (f64)(count * passes),
+		(unsigned long long)(sink & 1));
+
+	i32 top = ee_simd_level();
+
+	for (i32 run = 0; run < 2; ++run)
+	{
+		if (run == 1 && top < EE_SIMD_LEVEL_AVX512)
+			break;
+
+		ee_simd_force_level(run == 0 ? EE_SIMD_LEVEL_AVX : top);
+
+		EE_PROF_GET_TICKS(&start);
+
+		for (size_t p = 0; p < passes; ++p)
+		{
+			many(data, count, out);
+			sink += out[p % count];
+		}
+
+		EE_PROF_GET_TICKS(&end);
+		EE_PRINTLN("%-20s %-8s %8.3f ns/key  (%llu)", name, level_names[run], ee_bench_elapsed(start, end) * 1e9 / (f64)(count * passes),
+			(unsigned long long)(sink & 1));
+	}
+
+	ee_simd_force_level(top);
+	free(out);
+}
+
+// Flips every input bit of random keys and counts how often each output bit changes, an ideal hash flips
+// every output bit with probability 1/2. Bias is |2p - 1|, 'dict bits' are the tag and home index of a 2^20 slot table
+EE_INLINE void ee_bench_hash_avalanche(const BenchHash* hash, size_t len)
+{
+	EE_ALIGNAS(EE_MAX_ALIGN) u8 key[4 * sizeof(u64)];
+	EE_ALIGNAS(EE_MAX_ALIGN) u8 flipped[4 * sizeof(u64)];
+
+	u32* flips = (u32*)calloc(len * 8 * 64, sizeof(u32));
+	Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+
+	EE_ASSERT(flips != NULL, "Unable to allocate avalanche matrix");
+	EE_ASSERT(len <= sizeof(key), "Invalid avalanche key length (%zu)", len);
+
+	for (size_t t = 0; t < EE_BENCH_HASH_TRIALS; ++t)
+	{
+		for (size_t i = 0; i < sizeof(key); i += sizeof(u64))
+		{
+			u64 word = ee_rand_u64(&rng);
+			memcpy(&key[i], &word, sizeof(word));
+		}
+
+		u64 base = hash->fn(key, len);
+
+		for (size_t bit = 0; bit < len * 8; ++bit)
+		{
+			memcpy(flipped, key, sizeof(key));
+			flipped[bit >> 3] ^= (u8)(1u << (bit & 7));
+
+			u64 diff = base ^ hash->fn(flipped, len);
+
+			for (size_t out = 0; out < 64; ++out)
+			{
+				flips[bit * 64 + out] += (u32)((diff >> out) & 1);
+			}
+		}
+	}
+
+	f64 worst = 0.0;
+	f64 worst_dict = 0.0;
+	f64 mean = 0.0;
+
+	for (size_t bit = 0; bit < len * 8; ++bit)
+	{
+		for (size_t out = 0; out < 64; ++out)
+		{
+			f64 bias = fabs(2.0 * (f64)flips[bit * 64 + out] / (f64)EE_BENCH_HASH_TRIALS - 1.0);
+
+			mean += bias;
+			worst = bias > worst ? bias : worst;
+
+			if (out < 7 + 20 && bias > worst_dict)
+				worst_dict = bias;
+		}
+	}
+
+	mean /= (f64)(len * 8 * 64);
+
+	EE_PRINTLN("%-20s %5zu B  mean bias %.4f  worst %.4f  worst dict bits %.4f", hash->name, len, mean, worst, worst_dict);
+
+	free(flips);
+}
+
+// Spreads 16 keys per bucket over the home index bits the Dict uses, chi^2 / (buckets - 1) is close to 1.0
+// for a uniform hash, larger values mean longer probe sequences. Returns chi^2 / (buckets - 1)
+EE_INLINE f64 ee_bench_hash_buckets(const BenchHash* hash, BenchKeys type)
+{
+	size_t count = EE_BENCH_HASH_BUCKETS * 16;
+	u32* buckets = (u32*)calloc(EE_BENCH_HASH_BUCKETS, sizeof(u32));
+	Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+
+	EE_ASSERT(buckets != NULL, "Unable to allocate buckets");
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		EE_ALIGNAS(EE_MAX_ALIGN) u64 key[4] = { 0 };
+
+		key[0] = ee_bench_key(type, i, &rng);
+		buckets[(hash->fn((const u8*)key, sizeof(u64)) >> 7) & (EE_BENCH_HASH_BUCKETS - 1)]++;
+	}
+
+	f64 expected = (f64)count / EE_BENCH_HASH_BUCKETS;
+	f64 chi = 0.0;
+	u32 max_load = 0;
+
+	for (size_t b = 0; b < EE_BENCH_HASH_BUCKETS; ++b)
+	{
+		f64 d = (f64)buckets[b] - expected;
+
+		chi += d * d / expected;
+		max_load = buckets[b] > max_load ? buckets[b] : max_load;
+	}
+
+	EE_PRINTLN("%-20s %-12s chi2/df %8.3f  max load %5u (expected %.0f)", hash->name, ee_bench_keys_names[type],
+		chi / (EE_BENCH_HASH_BUCKETS - 1), max_load, expected);
+
+	free(buckets);
+
+	return chi / (EE_BENCH_HASH_BUCKETS - 1);
+}
+
+// Inserts, hit lookups in shuffled order and misses for one hash and key set
+EE_INLINE void ee_bench_hash_dict(const BenchHash* hash, BenchKeys type)
+{
+	size_t count = EE_BENCH_HASH_DICT_SIZE;
+	Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+
+	u64* keys = (u64*)malloc(2 * count * sizeof(u64));
+
+	EE_ASSERT(keys != NULL, "Unable to allocate benchmark buffers");
+
+	// Second half is never inserted and is used for misses
+	for (size_t i = 0; i < 2 * count; ++i)
+	{
+		keys[i] = ee_bench_key(type, (u64)i, &rng);
+	}
+
+	DictConfig config = ee_dict_config_def();
+	config.hash_fn = hash->fn;
+
+	Dict dict = ee_dict_new_conf_m(EE_DICT_START_SIZE, u64, u64, config);
+
+	ProfTicks start, end;
+	u64 sum = 0;
+
+	EE_PROF_GET_TICKS(&start);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		ee_dict_set(&dict, EE_RECAST_U8(keys[i]), EE_RECAST_U8(i));
+	}
+
+	EE_PROF_GET_TICKS(&end);
+	f64 insert = ee_bench_elapsed(start, end);
+
+	for (size_t i = count - 1; i > 0; --i)
+	{
+		size_t j = (size_t)ee_rand_u64_b(&rng, i + 1);
+		u64 temp = keys[i];
+
+		keys[i] = keys[j];
+		keys[j] = temp;
+	}
+
+	EE_PROF_GET_TICKS(&start);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		sum += *(u64*)ee_dict_at(&dict, EE_RECAST_U8(keys[i]));
+	}
+
+	EE_PROF_GET_TICKS(&end);
+	f64 hit = ee_bench_elapsed(start, end);
+
+	EE_PROF_GET_TICKS(&start);
+
+	for (size_t i = count; i < 2 * count; ++i)
+	{
+		sum += ee_dict_at(&dict, EE_RECAST_U8(keys[i])) != NULL;
+	}
+
+	EE_PROF_GET_TICKS(&end);
+	f64 miss = ee_bench_elapsed(start, end);
+
+	EE_PRINTLN("%-20s %-12s insert %7.2f ns  hit %7.2f ns  miss %7.2f ns  (%llu)", hash->name, ee_bench_keys_names[type],
+		insert * 1e9 / (f64)count, hit * 1e9 / (f64)count, miss * 1e9 / (f64)count, (unsigned long long)(sum & 1));
+
+	free(keys);
+	ee_dict_free(&dict);
+}
+
+// Speed, avalanche, bucket distribution and Dict throughput of every shipped hash.
+// Hashes are passed through 'DictConfig.hash_fn', so one build covers every EE_HASH_SAFETY_TYPE / EE_HASH_COMP_TYPE pair
+void run_hash_bench(void)
+{
+	static const size_t lens[] = { 8, 16, 32, 64, 128, 256, 1024, 4096 };
+
+	u8* raw = (u8*)malloc(EE_BENCH_HASH_BUF + EE_MAX_ALIGN);
+	Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+
+	EE_ASSERT(raw != NULL, "Unable to allocate benchmark buffers");
+
+	u8* data = ee_bench_hash_align(raw);
+
+	for (size_t i = 0; i < EE_BENCH_HASH_BUF; i += sizeof(u64))
+	{
+		u64 word = ee_rand_u64(&rng);
+		memcpy(&data[i], &word, sizeof(word));
+	}
+
+	EE_PRINTLN("selected: EE_HASH_SAFETY_TYPE %d, EE_HASH_COMP_TYPE %d", EE_HASH_SAFETY_TYPE, EE_HASH_COMP_TYPE);
+
+	EE_PRINTLN("\n-- throughput --");
+
+	for (size_t h = 0; h < EE_BENCH_HASH_COUNT; ++h)
+	{
+		const BenchHash* hash = &ee_bench_hashes[h];
+
+		if (hash->key_len != 0)
+		{
+			ee_bench_hash_speed(hash, data, hash->key_len);
+			continue;
+		}
+
+		for (size_t l = 0; l < sizeof(lens) / sizeof(lens[0]); ++l)
+			ee_bench_hash_speed(hash, data, lens[l]);
+	}
+
+	EE_PRINTLN("\n-- bulk hashing --");
+
+	ee_bench_hash_many("ee_hash_u32_many", ee_hash_u32_many, ee_hash_u32_safe, data, sizeof(u32));
+	ee_bench_hash_many("ee_hash_mm_u32_many", ee_hash_mm_u32_many, ee_hash_mm_u32_safe, data, sizeof(u32));
+	ee_bench_hash_many("ee_hash_u64_many", ee_hash_u64_many, ee_hash_u64_safe, data, sizeof(u64));
+	ee_bench_hash_many("ee_hash_mm_u64_many", ee_hash_mm_u64_many, ee_hash_mm_u64_safe, data, sizeof(u64));
+	ee_bench_hash_many("ee_hash_u128_many", ee_hash_u128_many, ee_hash_u128_safe, data, 2 * sizeof(u64));
+	ee_bench_hash_many("ee_hash_u256_many", ee_hash_u256_many, ee_hash_u256_safe, data, 4 * sizeof(u64));
+
+	EE_PRINTLN("\n-- avalanche --");
+
+	for (size_t h = 0; h < EE_BENCH_HASH_COUNT; ++h)
+	{
+		const BenchHash* hash = &ee_bench_hashes[h];
+
+		if (hash->key_len != 0)
+		{
+			ee_bench_hash_avalanche(hash, hash->key_len);
+			continue;
+		}
+
+		ee_bench_hash_avalanche(hash, sizeof(u64));
+		ee_bench_hash_avalanche(hash, 4 * sizeof(u64));
+	}
+
+	// Key sets are u64, hashes of other fixed widths are skipped
+	f64 chi[EE_BENCH_HASH_COUNT][EE_BENCH_KEYS_COUNT] = { { 0 } };
+
+	EE_PRINTLN("\n-- bucket distribution --");
+
+	for (size_t h = 0; h < EE_BENCH_HASH_COUNT; ++h)
+	{
+		if (ee_bench_hashes[h].key_len != 0 && ee_bench_hashes[h].key_len != sizeof(u64))
+			continue;
+
+		for (i32 k = 0; k < EE_BENCH_KEYS_COUNT; ++k)
+			chi[h][k] = ee_bench_hash_buckets(&ee_bench_hashes[h], (BenchKeys)k);
+	}
+
+	EE_PRINTLN("\n-- dict throughput --");
+
+	for (size_t h = 0; h < EE_BENCH_HASH_COUNT; ++h)
+	{
+		if (ee_bench_hashes[h].key_len != 0 && ee_bench_hashes[h].key_len != sizeof(u64))
+			continue;
+
+		for (i32 k = 0; k < EE_BENCH_KEYS_COUNT; ++k)
+		{
+			if (chi[h][k] > EE_BENCH_HASH_DEGENERATE)
+			{
+				EE_PRINTLN("%-20s %-12s skipped, degenerate distribution", ee_bench_hashes[h].name, ee_bench_keys_names[k]);
+				continue;
+			}
+
+			ee_bench_hash_dict(&ee_bench_hashes[h], (BenchKeys)k);
+		}
+	}
+
+	free(raw);
+}
+
+#endif // EE_HASH_BENCH_H
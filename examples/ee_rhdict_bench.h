@@ -0,0 +1,105 @@
+#ifndef EE_RHDICT_BENCH_H
+#define EE_RHDICT_BENCH_H
+
+// Warning that 'fprintf' is not inlined (we do not care)
+#pragma warning(disable : 4710)
+
+#include "ee_rhdict.h"
+#include "ee_dict_bench.h"
+
+#ifndef EE_BENCH_RHDICT_SLOTS
+#define EE_BENCH_RHDICT_SLOTS    (EE_NMB(2))
+#endif
+
+EE_INLINE void ee_bench_dense_report(const char* name, size_t count, size_t cap, size_t mem, f64 hit, f64 miss)
+{
+	EE_PRINTLN("%-22s load %.3f  %6.2f B/entry  hit %7.2f ns  miss %7.2f ns", name, (f64)count / (f64)cap,
+		(f64)mem / (f64)count, hit * 1e9 / (f64)count, miss * 1e9 / (f64)count);
+}
+
+// Memory per entry and lookup latency of the Dict against RhDict thresholds, for 93% of EE_BENCH_RHDICT_SLOTS
+// random u64 -> u64 entries: past the Dict threshold, so the Dict has doubled while the dense tables have not
+void run_dict_bench_dense(void)
+{
+	f64 loads[] = { 0.875, 0.95, 0.97 };
+	size_t count = (size_t)((f64)EE_BENCH_RHDICT_SLOTS * 0.93);
+	Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+
+	u64* keys = (u64*)malloc(2 * count * sizeof(u64));
+
+	EE_ASSERT(keys != NULL, "Unable to allocate benchmark buffers");
+
+	// Second half is never inserted and is used for misses
+	for (size_t i = 0; i < 2 * count; ++i)
+	{
+		keys[i] = ee_rand_u64(&rng);
+	}
+
+	ProfTicks start, end;
+	u64 sum = 0;
+
+	{
+		Dict dict = ee_dict_def_m(EE_DICT_START_SIZE, u64, u64);
+
+		for (size_t i = 0; i < count; ++i)
+			ee_dict_set(&dict, EE_RECAST_U8(keys[i]), EE_RECAST_U8(i));
+
+		EE_PROF_GET_TICKS(&start);
+
+		for (size_t i = 0; i < count; ++i)
+			sum += *(u64*)ee_dict_at(&dict, EE_RECAST_U8(keys[(i * 7919) % count]));
+
+		EE_PROF_GET_TICKS(&end);
+		f64 hit = ee_bench_elapsed(start, end);
+
+		EE_PROF_GET_TICKS(&start);
+
+		for (size_t i = count; i < 2 * count; ++i)
+			sum += ee_dict_at(&dict, EE_RECAST_U8(keys[i])) != NULL;
+
+		EE_PROF_GET_TICKS(&end);
+		f64 miss = ee_bench_elapsed(start, end);
+
+		ee_bench_dense_report("Dict", count, dict.cap, dict.cap * (dict.key_len + dict.val_len + 1), hit, miss);
+
+		ee_dict_free(&dict);
+	}
+
+	for (size_t l = 0; l < sizeof(loads) / sizeof(loads[0]); ++l)
+	{
+		char name[64];
+		RhDict dict = ee_rhdict_new_m(EE_DICT_START_SIZE, u64, u64, loads[l]);
+
+		for (size_t i = 0; i < count; ++i)
+			ee_rhdict_set(&dict, EE_RECAST_U8(keys[i]), EE_RECAST_U8(i));
+
+		EE_PROF_GET_TICKS(&start);
+
+		for (size_t i = 0; i < count; ++i)
+			sum += *(u64*)ee_rhdict_at(&dict, EE_RECAST_U8(keys[(i * 7919) % count]));
+
+		EE_PROF_GET_TICKS(&end);
+		f64 hit = ee_bench_elapsed(start, end);
+
+		EE_PROF_GET_TICKS(&start);
+
+		for (size_t i = count; i < 2 * count; ++i)
+			sum += ee_rhdict_contains(&dict, EE_RECAST_U8(keys[i]));
+
+		EE_PROF_GET_TICKS(&end);
+		f64 miss = ee_bench_elapsed(start, end);
+
+		snprintf(name, sizeof(name), "RhDict (max load %.3f)", loads[l]);
+		ee_bench_dense_report(name, count, dict.cap, ee_rhdict_mem(&dict), hit, miss);
+
+		EE_ASSERT(ee_rhdict_count(&dict) == count, "Invalid RhDict count (%zu), expected (%zu)", ee_rhdict_count(&dict), count);
+
+		ee_rhdict_free(&dict);
+	}
+
+	EE_PRINTLN("(%llu)", (unsigned long long)(sum & 1));
+
+	free(keys);
+}
+
+#endif // EE_RHDICT_BENCH_H
@@ -0,0 +1,138 @@
+#ifndef EE_SDICT_BENCH_H
+#define EE_SDICT_BENCH_H
+
+// Warning that 'fprintf' is not inlined (we do not care)
+#pragma warning(disable : 4710)
+
+#include "ee_sdict.h"
+#include "ee_thread.h"
+#include "ee_dict_bench.h"
+
+#ifndef EE_BENCH_SDICT_OPS
+#define EE_BENCH_SDICT_OPS        (EE_NMB(1))
+#endif
+
+#ifndef EE_BENCH_SDICT_THREADS
+#define EE_BENCH_SDICT_THREADS    (32)
+#endif
+
+typedef struct SdictBenchCtx
+{
+	ShardedDict* sdict;
+	Dict*        dict;
+	u32*         lock;
+	const u64*   keys;
+	size_t       keys_count;
+	u64          seed;
+	size_t       found;
+} SdictBenchCtx;
+
+// Baseline, one Dict behind one lock
+EE_INLINE void ee_bench_locked_worker(void* context)
+{
+	SdictBenchCtx* ctx = (SdictBenchCtx*)context;
+	Rng rng = ee_rng_new(ctx->seed);
+
+	for (size_t i = 0; i < EE_BENCH_SDICT_OPS; ++i)
+	{
+		u64 key = ctx->keys[ee_rand_u64_b(&rng, ctx->keys_count)];
+		u64 val = 0;
+		i32 write = ee_rand_u64_b(&rng, 10) == 0;
+
+		while (ee_atomic_xchg_u32(ctx->lock, 1) != 0)
+			ee_cpu_pause();
+
+		if (write)
+		{
+			ee_dict_set(ctx->dict, EE_RECAST_U8(key), EE_RECAST_U8(i));
+		}
+		else
+		{
+			u8* ptr = ee_dict_at(ctx->dict, EE_RECAST_U8(key));
+
+			if (ptr != NULL)
+				memcpy(&val, ptr, sizeof(val));
+
+			ctx->found += (ptr != NULL);
+		}
+
+		ee_atomic_store_u32(ctx->lock, 0);
+	}
+}
+
+EE_INLINE void ee_bench_sharded_worker(void* context)
+{
+	SdictBenchCtx* ctx = (SdictBenchCtx*)context;
+	Rng rng = ee_rng_new(ctx->seed);
+
+	for (size_t i = 0; i < EE_BENCH_SDICT_OPS; ++i)
+	{
+		u64 key = ctx->keys[ee_rand_u64_b(&rng, ctx->keys_count)];
+		u64 val = 0;
+
+		if (ee_rand_u64_b(&rng, 10) == 0)
+			ee_sdict_set(ctx->sdict, EE_RECAST_U8(key), EE_RECAST_U8(i));
+		else
+			ctx->found += ee_sdict_get(ctx->sdict, EE_RECAST_U8(key), EE_RECAST_U8(val));
+	}
+}
+
+// Mixed 90% read / 10% write traffic, one locked Dict against a ShardedDict for 1..32 threads
+void run_dict_bench_sharded(void)
+{
+	size_t count = EE_NMB(1);
+	Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+
+	u64* keys = (u64*)malloc(count * sizeof(u64));
+	EE_ASSERT(keys != NULL, "Unable to allocate benchmark buffers");
+
+	Dict dict = ee_dict_def_m(count * 2, u64, u64);
+	ShardedDict sdict = ee_sdict_def_m(count * 2, u64, u64);
+	u32 lock = 0;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		keys[i] = ee_rand_u64(&rng);
+
+		ee_dict_set(&dict, EE_RECAST_U8(keys[i]), EE_RECAST_U8(i));
+		ee_sdict_set(&sdict, EE_RECAST_U8(keys[i]), EE_RECAST_U8(i));
+	}
+
+	EE_PRINTLN("cpu count %d", ee_get_cpu_count());
+
+	Thread threads[EE_BENCH_SDICT_THREADS];
+	SdictBenchCtx ctxs[EE_BENCH_SDICT_THREADS];
+
+	for (size_t n = 1; n <= EE_BENCH_SDICT_THREADS; n *= 2)
+	{
+		for (size_t mode = 0; mode < 2; ++mode)
+		{
+			ProfTicks start, end;
+			EE_PROF_GET_TICKS(&start);
+
+			for (size_t t = 0; t < n; ++t)
+			{
+				SdictBenchCtx ctx = { &sdict, &dict, &lock, keys, count, EE_RNG_SEED_DEF + t, 0 };
+				ctxs[t] = ctx;
+
+				ee_thread_start(&threads[t], mode ? ee_bench_sharded_worker : ee_bench_locked_worker, &ctxs[t]);
+			}
+
+			for (size_t t = 0; t < n; ++t)
+				ee_thread_join(&threads[t]);
+
+			EE_PROF_GET_TICKS(&end);
+
+			f64 sec = ee_bench_elapsed(start, end);
+			size_t ops = n * EE_BENCH_SDICT_OPS;
+
+			EE_PRINTLN("%-16s threads %2zu  %8.2f Mops/s", mode ? "sharded" : "single lock", n, (f64)ops / sec * 1e-6);
+		}
+	}
+
+	free(keys);
+	ee_dict_free(&dict);
+	ee_sdict_free(&sdict);
+}
+
+#endif // EE_SDICT_BENCH_H
@@ -0,0 +1,181 @@
+#ifndef EE_SIMD_EXAMPLE_H
+#define EE_SIMD_EXAMPLE_H
+
+// Warning that 'fprintf' is not inlined (we do not care)
+#pragma warning(disable : 4710)
+
+#include "ee_array.h"
+#include "ee_string.h"
+#include "ee_dict.h"
+#include "ee_random.h"
+
+#ifndef EE_SIMD_EXAMPLE_LEN
+#define EE_SIMD_EXAMPLE_LEN    (1000)
+#endif
+
+EE_INLINE const char* ee_simd_level_name(i32 level)
+{
+	switch (level)
+	{
+	case EE_SIMD_LEVEL_NONE:   return "NONE";
+	case EE_SIMD_LEVEL_SSE:    return "SSE2";
+	case EE_SIMD_LEVEL_AVX:    return "AVX2";
+	case EE_SIMD_LEVEL_AVX512: return "AVX-512BW";
+	default:                   return "UNKNOWN";
+	}
+}
+
+// Every find width, every start offset modulo the widest group and targets at the head, body and tail
+EE_INLINE void ee_simd_check_array_find(Rng* rng, size_t elem_size)
+{
+	Array array = ee_array_new(EE_SIMD_EXAMPLE_LEN, elem_size, NULL);
+	u64 val = 0;
+
+	for (size_t i = 0; i < EE_SIMD_EXAMPLE_LEN; ++i)
+	{
+		// Small alphabet so misses and repeated values both show up
+		val = ee_rand_u64_b(rng, 64) | 0x0101010101010100ull;
+		ee_array_push(&array, (const u8*)&val);
+	}
+
+	for (size_t low = 0; low < 64; ++low)
+	{
+		for (u64 target = 0x0101010101010100ull; target < 0x0101010101010100ull + 72; target += 3)
+		{
+			size_t expected = EE_ARRAY_INVALID;
+
+			for (size_t i = low; i < EE_SIMD_EXAMPLE_LEN; ++i)
+			{
+				if (memcmp(&array.buffer[i * elem_size], &target, elem_size) == 0)
+				{
+					expected = i;
+					break;
+				}
+			}
+
+			size_t found = ee_array_find_b(&array, (const u8*)&target, low, EE_SIMD_EXAMPLE_LEN);
+
+			EE_ASSERT(found == expected, "Array find (%zu-byte, low %zu): got (%zu), expected (%zu)", elem_size, low, found, expected);
+		}
+	}
+
+	ee_array_free(&array);
+}
+
+EE_INLINE void ee_simd_check_str(Rng* rng)
+{
+	Str str = ee_str_new(EE_SIMD_EXAMPLE_LEN, NULL);
+
+	for (size_t i = 0; i < EE_SIMD_EXAMPLE_LEN; ++i)
+	{
+		ee_str_push(&str, (char)('a' + ee_rand_u32_b(rng, 3)));
+	}
+
+	const char* patterns[] = { "a", "ab", "aba", "cccc", "abcab", "z" };
+
+	for (size_t p = 0; p < sizeof(patterns) / sizeof(patterns[0]); ++p)
+	{
+		Str target = ee_str_from_cstr(patterns[p], NULL);
+		size_t len = target.top;
+
+		for (size_t low = 0; low < 40; ++low)
+		{
+			size_t expected_find = EE_STR_INVALID;
+			size_t expected_count = 0;
+
+			for (size_t i = low; i + len <= str.top; ++i)
+			{
+				if (memcmp(&str.buffer[i], target.buffer, len) == 0)
+				{
+					if (expected_find == EE_STR_INVALID)
+						expected_find = i;
+
+					expected_count++;
+					i += len - 1;
+				}
+			}
+
+			size_t found = ee_str_find_b(&str, &target, low, str.top);
+			size_t count = ee_str_count_b(&str, &target, low, str.top);
+
+			EE_ASSERT(found == expected_find, "Str find (%s, low %zu): got (%zu), expected (%zu)", patterns[p], low, found, expected_find);
+			EE_ASSERT(count == expected_count, "Str count (%s, low %zu): got (%zu), expected (%zu)", patterns[p], low, count, expected_count);
+		}
+
+		ee_str_free(&target);
+	}
+
+	ee_str_free(&str);
+}
+
+// 16 and 32 byte keys go through the dispatched 'eq_safe' kernels, every probe through the dispatched group match
+EE_INLINE void ee_simd_check_dict(Rng* rng)
+{
+	typedef struct { u64 v[4]; } Key256;
+
+	Dict dict_128 = ee_dict_new(16, 16, sizeof(u64), (DictConfig){ 0 });
+	Dict dict_256 = ee_dict_new(16, sizeof(Key256), sizeof(u64), (DictConfig){ 0 });
+
+	Key256 key = { { 0 } };
+
+	for (u64 i = 0; i < EE_SIMD_EXAMPLE_LEN; ++i)
+	{
+		key.v[0] = i;
+		key.v[1] = ee_rand_u64(rng);
+		key.v[2] = ~i;
+		key.v[3] = i * 3;
+
+		ee_dict_set(&dict_128, (const u8*)&key, (const u8*)&i);
+		ee_dict_set(&dict_256, (const u8*)&key, (const u8*)&i);
+
+		u8* at_128 = ee_dict_at(&dict_128, (const u8*)&key);
+		u8* at_256 = ee_dict_at(&dict_256, (const u8*)&key);
+
+		EE_ASSERT(at_128 != NULL && *(u64*)at_128 == i, "16-byte key (%llu) lost", (unsigned long long)i);
+		EE_ASSERT(at_256 != NULL && *(u64*)at_256 == i, "32-byte key (%llu) lost", (unsigned long long)i);
+
+		// Same low 16 bytes, different high half, must miss in the 32-byte table only
+		key.v[3] ^= 1;
+
+		EE_ASSERT(ee_dict_contains(&dict_256, (const u8*)&key) == EE_FALSE, "32-byte key compared only partially");
+		EE_ASSERT(ee_dict_contains(&dict_128, (const u8*)&key) == EE_TRUE, "16-byte key compared past its length");
+	}
+
+	EE_ASSERT(dict_128.count == EE_SIMD_EXAMPLE_LEN, "Invalid 16-byte dict count (%zu)", (size_t)dict_128.count);
+	EE_ASSERT(dict_256.count == EE_SIMD_EXAMPLE_LEN, "Invalid 32-byte dict count (%zu)", (size_t)dict_256.count);
+
+	ee_dict_free(&dict_128);
+	ee_dict_free(&dict_256);
+}
+
+// Forces every dispatch level the machine supports and runs the same checks against scalar reference results
+void run_simd_dispatch_example(void)
+{
+	i32 detected = ee_simd_detect_level();
+
+	EE_PRINTLN("Detected SIMD level: %s", ee_simd_level_name(detected));
+
+	for (i32 level = EE_SIMD_LEVEL_NONE; level <= detected; ++level)
+	{
+		Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+
+		i32 forced = ee_simd_force_level(level);
+
+		EE_ASSERT(forced == level, "Failed to force level (%s), got (%s)", ee_simd_level_name(level), ee_simd_level_name(forced));
+
+		ee_simd_check_array_find(&rng, 1);
+		ee_simd_check_array_find(&rng, 2);
+		ee_simd_check_array_find(&rng, 4);
+		ee_simd_check_array_find(&rng, 8);
+		ee_simd_check_array_find(&rng, 3);
+
+		ee_simd_check_str(&rng);
+		ee_simd_check_dict(&rng);
+
+		EE_PRINTLN("Level %-10s passed", ee_simd_level_name(level));
+	}
+
+	ee_simd_force_level(detected);
+}
+
+#endif // EE_SIMD_EXAMPLE_H
@@ -0,0 +1,258 @@
+#ifndef EE_SORT_BENCH_H
+#define EE_SORT_BENCH_H
+
+// Warning that 'fprintf' is not inlined (we do not care)
+#pragma warning(disable : 4710)
+
+#include "ee_array.h"
+#include "ee_array_ext.h"
+#include "ee_array_mt.h"
+#include "ee_dict_bench.h"
+
+#ifndef EE_BENCH_SORT_SIZE
+#define EE_BENCH_SORT_SIZE    (EE_NMB(4))
+#endif
+
+// Key after the payload, sorted with the key offset variant
+typedef struct BenchRecord
+{
+	u64 payload;
+	u64 key;
+} BenchRecord;
+
+EE_INLINE int ee_bench_cmp_u32(const void* a, const void* b)
+{
+	u32 x = *(const u32*)a, y = *(const u32*)b;
+	return (x > y) - (x < y);
+}
+
+EE_INLINE int ee_bench_cmp_u64(const void* a, const void* b)
+{
+	u64 x = *(const u64*)a, y = *(const u64*)b;
+	return (x > y) - (x < y);
+}
+
+EE_INLINE int ee_bench_cmp_i64(const void* a, const void* b)
+{
+	i64 x = *(const i64*)a, y = *(const i64*)b;
+	return (x > y) - (x < y);
+}
+
+EE_INLINE int ee_bench_cmp_f32(const void* a, const void* b)
+{
+	f32 x = *(const f32*)a, y = *(const f32*)b;
+	return (x > y) - (x < y);
+}
+
+EE_INLINE int ee_bench_cmp_record(const void* a, const void* b)
+{
+	u64 x = ((const BenchRecord*)a)->key, y = ((const BenchRecord*)b)->key;
+	return (x > y) - (x < y);
+}
+
+// Sorts one random array with EE_SORT_INTRO and copies of it with radix sort and, for plain 4 and 8 byte numbers,
+// the numeric sort. Outputs are checked against the introsort one by key (introsort is not stable, the record
+// payloads may differ)
+EE_INLINE void ee_bench_sort(const char* name, size_t elem_size, size_t key_off, size_t key_len, ArrayRadixType type, BinCmp cmp)
+{
+	size_t count = EE_BENCH_SORT_SIZE;
+	Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+	Array intro = ee_array_new(count, elem_size, NULL);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		u8* elem = ee_array_emplace(&intro);
+
+		for (size_t b = 0; b < elem_size; b += sizeof(u32))
+		{
+			u32 bits = (u32)ee_rand_u64(&rng);
+
+			// Finite floats of both signs, NaNs have no order under the comparison
+			if (type == EE_RADIX_FLOAT)
+			{
+				f32 val = (f32)(i32)bits * 1e-3f;
+				memcpy(&bits, &val, sizeof(bits));
+			}
+
+			memcpy(&elem[b], &bits, ee_min_u64(sizeof(u32), elem_size - b));
+		}
+	}
+
+	Array radix = ee_array_copy(&intro, NULL);
+	Array num = ee_array_copy(&intro, NULL);
+	i32 numeric = key_len == elem_size && key_len >= sizeof(u32);
+	ProfTicks start, end;
+	char label[64];
+
+	EE_PROF_GET_TICKS(&start);
+	ee_array_sort(&intro, cmp, EE_SORT_INTRO);
+	EE_PROF_GET_TICKS(&end);
+
+	snprintf(label, sizeof(label), "%s introsort", name);
+	ee_bench_report(label, count, ee_bench_elapsed(start, end));
+
+	EE_PROF_GET_TICKS(&start);
+	ee_array_radix_sort_key(&radix, key_off, key_len, type);
+	EE_PROF_GET_TICKS(&end);
+
+	snprintf(label, sizeof(label), "%s radix", name);
+	ee_bench_report(label, count, ee_bench_elapsed(start, end));
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		EE_ASSERT(cmp(ee_array_at(&intro, i), ee_array_at(&radix, i)) == 0, "Radix sort mismatch at (%zu)", i);
+	}
+
+	if (numeric)
+	{
+		EE_PROF_GET_TICKS(&start);
+		ee_array_sort_num(&num, type);
+		EE_PROF_GET_TICKS(&end);
+
+		snprintf(label, sizeof(label), "%s numeric sort", name);
+		ee_bench_report(label, count, ee_bench_elapsed(start, end));
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			EE_ASSERT(cmp(ee_array_at(&intro, i), ee_array_at(&num, i)) == 0, "Numeric sort mismatch at (%zu)", i);
+		}
+	}
+
+	ee_array_free(&intro);
+	ee_array_free(&radix);
+	ee_array_free(&num);
+}
+
+// Radix and numeric sorts against EE_SORT_INTRO on EE_BENCH_SORT_SIZE random elements, times are per element
+void run_sort_bench_radix(void)
+{
+	ee_bench_sort("u32", sizeof(u32), 0, sizeof(u32), EE_RADIX_UNSIGNED, ee_bench_cmp_u32);
+	ee_bench_sort("u64", sizeof(u64), 0, sizeof(u64), EE_RADIX_UNSIGNED, ee_bench_cmp_u64);
+	ee_bench_sort("i64", sizeof(i64), 0, sizeof(i64), EE_RADIX_SIGNED, ee_bench_cmp_i64);
+	ee_bench_sort("f32", sizeof(f32), 0, sizeof(f32), EE_RADIX_FLOAT, ee_bench_cmp_f32);
+	ee_bench_sort("record (u64 key)", sizeof(BenchRecord), sizeof(u64), sizeof(u64), EE_RADIX_UNSIGNED, ee_bench_cmp_record);
+}
+
+// Parallel merge sort against EE_SORT_INTRO on EE_BENCH_SORT_SIZE random u64, for 1, 2, 4 ... up to every core
+void run_sort_bench_parallel(void)
+{
+	size_t count = EE_BENCH_SORT_SIZE;
+	size_t cores = (size_t)ee_get_cpu_count();
+	Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+	Array source = ee_array_new(count, sizeof(u64), NULL);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		u64 val = ee_rand_u64(&rng);
+		ee_array_push(&source, EE_RECAST_U8(val));
+	}
+
+	ProfTicks start, end;
+	char label[64];
+
+	{
+		Array array = ee_array_copy(&source, NULL);
+
+		EE_PROF_GET_TICKS(&start);
+		ee_array_sort(&array, ee_bench_cmp_u64, EE_SORT_INTRO);
+		EE_PROF_GET_TICKS(&end);
+
+		ee_bench_report("u64 introsort", count, ee_bench_elapsed(start, end));
+		ee_array_free(&array);
+	}
+
+	for (size_t threads = 1; ; threads *= 2)
+	{
+		threads = ee_min_u64(threads, cores);
+
+		Array array = ee_array_copy(&source, NULL);
+
+		EE_PROF_GET_TICKS(&start);
+		ee_array_sort_parallel(&array, ee_bench_cmp_u64, threads);
+		EE_PROF_GET_TICKS(&end);
+
+		snprintf(label, sizeof(label), "u64 parallel sort, %zu threads", threads);
+		ee_bench_report(label, count, ee_bench_elapsed(start, end));
+
+		for (size_t i = 1; i < count; ++i)
+		{
+			EE_ASSERT(*(u64*)ee_array_at(&array, i - 1) <= *(u64*)ee_array_at(&array, i), "Parallel sort order broken at (%zu)", i);
+		}
+
+		ee_array_free(&array);
+
+		if (threads == cores)
+			break;
+	}
+
+	ee_array_free(&source);
+}
+
+// Checks the order of the external sort output as it streams by
+typedef struct BenchExtCheck
+{
+	u64    last;
+	size_t count;
+} BenchExtCheck;
+
+EE_INLINE void ee_bench_ext_check(void* context, const u8* elems, size_t count)
+{
+	BenchExtCheck* check = (BenchExtCheck*)context;
+	const BenchRecord* records = (const BenchRecord*)elems;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		EE_ASSERT(check->last <= records[i].key, "External sort order broken at (%zu)", check->count + i);
+		check->last = records[i].key;
+	}
+
+	check->count += count;
+}
+
+// Stable merge sort in memory against the external sort with an eighth of the data as budget,
+// on EE_BENCH_SORT_SIZE random records. Runs go to tmpfile()
+void run_sort_bench_external(void)
+{
+	size_t count = EE_BENCH_SORT_SIZE;
+	Rng rng = ee_rng_new(EE_RNG_SEED_DEF);
+	Array source = ee_array_new(count, sizeof(BenchRecord), NULL);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		BenchRecord record = { i, ee_rand_u64(&rng) };
+		ee_array_push(&source, EE_RECAST_U8(record));
+	}
+
+	ProfTicks start, end;
+
+	{
+		Array array = ee_array_copy(&source, NULL);
+
+		EE_PROF_GET_TICKS(&start);
+		ee_array_sort(&array, ee_bench_cmp_record, EE_SORT_MERGE);
+		EE_PROF_GET_TICKS(&end);
+
+		ee_bench_report("record merge sort", count, ee_bench_elapsed(start, end));
+		ee_array_free(&array);
+	}
+
+	{
+		ArrayExtSort ext = ee_array_ext_new(sizeof(BenchRecord), count * sizeof(BenchRecord) / 8, ee_bench_cmp_record, NULL, NULL);
+		BenchExtCheck check = { 0 };
+
+		EE_PROF_GET_TICKS(&start);
+		ee_array_ext_push_n(&ext, source.buffer, count);
+		ee_array_ext_finish(&ext, ee_bench_ext_check, &check);
+		EE_PROF_GET_TICKS(&end);
+
+		ee_bench_report("record external sort", count, ee_bench_elapsed(start, end));
+
+		EE_ASSERT(check.count == count, "External sort lost elements (%zu) of (%zu)", check.count, count);
+
+		ee_array_ext_free(&ext);
+	}
+
+	ee_array_free(&source);
+}
+
+#endif // EE_SORT_BENCH_H
@@ -7,6 +7,17 @@
 
 #define EE_ARRAY_INVALID                         (0xffffffffffffffffull)
 #define EE_ARRAY_SORT_TH                         (16)
+// Elements matched per kernel call by the find, find-all and count scans, one bit each in a u64
+#define EE_ARRAY_MATCH_CHUNK                     (64)
+// Largest sorting network of the numeric sort, smaller partitions are finished by it
+#define EE_ARRAY_SORT_NET_TH                     (32)
+// Partitions of at least this many elements use the vectorized partition of the numeric sort
+#ifndef EE_ARRAY_SORT_VEC_TH
+#define EE_ARRAY_SORT_VEC_TH                     (128)
+#endif
+#ifndef EE_ARRAY_RADIX_PREFETCH
+#define EE_ARRAY_RADIX_PREFETCH                  (16)
+#endif
 #define EE_ARRAY_RECAST(v_ptr, i, dtype)         ((dtype*)ee_array_at(v_ptr, i))
 #define EE_ARRAY_PTR_GET(v_ptr, i, d_ptr)        (memcpy(d_ptr, ee_array_at(v_ptr, i), v_ptr->elem_size))
 #define EE_ARRAY_GET(v, i, d)                    (memcpy(&d, ee_array_at(&v, i), v.elem_size))
@@ -40,8 +51,17 @@ typedef enum ArraySortType
 	EE_SORT_QUICK   = 2,
 	EE_SORT_HEAP    = 3,
 	EE_SORT_INTRO   = 4,
+	EE_SORT_MERGE   = 5,
 } ArraySortType;
 
+// How radix sort reads a key: little-endian unsigned, two's complement signed or IEEE float (4 or 8 bytes)
+typedef enum ArrayRadixType
+{
+	EE_RADIX_UNSIGNED = 0,
+	EE_RADIX_SIGNED   = 1,
+	EE_RADIX_FLOAT    = 2,
+} ArrayRadixType;
+
 EE_EXTERN_C_START
 
 EE_INLINE Array ee_array_new(size_t size, size_t elem_size, const Allocator* allocator)
@@ -81,7 +101,7 @@ EE_INLINE int ee_array_full(const Array* array)
 {
 	EE_ASSERT(array != NULL, "Trying to check NULL Array");
 
-	return array->top >= array->cap;
+	return array->top + array->elem_size > array->cap;
 }
 
 EE_INLINE int ee_array_empty(const Array* array)
@@ -139,7 +159,11 @@ EE_INLINE void ee_array_grow(Array* array)
 	EE_ASSERT(array != NULL, "Trying to grow NULL Array");
 	EE_ASSERT(array->buffer != NULL, "Trying to reallocate NULL Array.buffer");
 
-	size_t new_cap = array->cap + (array->cap >> 1);
+	// 1.5x in bytes, but always room for one more element and a whole number of elements
+	size_t new_cap = ee_max_u64(array->cap + (array->cap >> 1), array->top + array->elem_size);
+
+	new_cap = ((new_cap + array->elem_size - 1) / array->elem_size) * array->elem_size;
+
 	u8* new_buffer = (u8*)array->allocator.realloc_fn(&array->allocator, array->buffer, array->cap, new_cap);
 	
 	EE_ASSERT(new_buffer != NULL, "Unable to reallocate (%zu) bytes for Array.buffer", new_cap);
@@ -237,133 +261,154 @@ EE_INLINE size_t ee_array_find_b(const Array* array, const u8* target, size_t lo
 	EE_ASSERT(target != NULL, "Trying to find a NULL value");
 	EE_ASSERT(low < high, "Invalid bounds (%zu, %zu)", low, high);
 
-	size_t low_b = low * array->elem_size;
-	size_t high_b = high * array->elem_size;
-
-	EE_ASSERT(high_b <= array->top, "Invalid index (%zu) for array with size (%zu)", high, ee_array_len(array));
+	EE_ASSERT(high * array->elem_size <= array->top, "Invalid index (%zu) for array with size (%zu)", high, ee_array_len(array));
 
-	size_t low_tail = (low_b + EE_SIMD_BYTES - 1) & ~(EE_SIMD_BYTES - 1);
-	size_t high_tail = high_b & ~(EE_SIMD_BYTES - 1);
-	size_t i = low_b;
-
-	for (; i < low_tail; i += array->elem_size)
-	{
-		if (ee_eq_def(target, &array->buffer[i], array->elem_size))
-		{
-			return i / array->elem_size;
-		}
-	}
+	const SimdKernels* kernels = ee_simd_kernels();
+	const u8* buffer = &array->buffer[low * array->elem_size];
+	size_t len = high - low;
+	size_t found = len;
 
 	switch (array->elem_size)
 	{
-	case 1:
+	case 1: found = kernels->find_8(buffer, len, target); break;
+	case 2: found = kernels->find_16(buffer, len, target); break;
+	case 4: found = kernels->find_32(buffer, len, target); break;
+	case 8: found = kernels->find_64(buffer, len, target); break;
+	default:
 	{
-		ee_simd_i pattern = ee_set1_epi8(target[0]);
-
-		for (; i < high_tail; i += EE_SIMD_BYTES)
+		for (size_t i = 0; i < len; i += EE_ARRAY_MATCH_CHUNK)
 		{
-			ee_simd_i group = ee_loadu_si((const ee_simd_i*)&array->buffer[i]);
-			ee_simd_i match = ee_cmpeq_epi8(pattern, group);
-
-			i32 mask = ee_movemask_epi8(match);
+			size_t count = ee_min_u64(len - i, EE_ARRAY_MATCH_CHUNK);
+			u64 mask = kernels->match_wide(&buffer[i * array->elem_size], count, target, array->elem_size);
 
 			if (mask)
 			{
-				i32 first = ee_first_bit_u32(mask);
-
-				return i + first;
+				found = i + ee_first_bit_u64(mask);
+				break;
 			}
 		}
 	} break;
-	case 2:
+	}
+
+	if (found < len)
 	{
-		u16 a;
-		memcpy(&a, target, sizeof(a));
+		return low + found;
+	}
 
-		ee_simd_i pattern = ee_set1_epi16(a);
+	return EE_ARRAY_INVALID;
+}
 
-		for (; i < high_tail; i += EE_SIMD_BYTES)
-		{
-			ee_simd_i group = ee_loadu_si((const ee_simd_i*)&array->buffer[i]);
-			ee_simd_i match = ee_cmpeq_epi16(pattern, group);
+// Bit i is set when element i of 'buffer[0, count)' equals 'target', 'count' is at most EE_ARRAY_MATCH_CHUNK
+EE_INLINE u64 _ee_array_match(const SimdKernels* kernels, const u8* buffer, size_t count, const u8* target, size_t elem_size)
+{
+	switch (elem_size)
+	{
+	case 1:  return kernels->match_8(buffer, count, target);
+	case 2:  return kernels->match_16(buffer, count, target);
+	case 4:  return kernels->match_32(buffer, count, target);
+	case 8:  return kernels->match_64(buffer, count, target);
+	default: return kernels->match_wide(buffer, count, target, elem_size);
+	}
+}
 
-			i32 mask = ee_movemask_epi8(match);
+// Pushes the index of every element of [low, high) equal to 'target' into 'out' (an Array of size_t),
+// returns how many were pushed
+EE_INLINE size_t ee_array_find_all_b(const Array* array, const u8* target, size_t low, size_t high, Array* out)
+{
+	EE_ASSERT(array != NULL, "Trying to find in NULL Array");
+	EE_ASSERT(target != NULL, "Trying to find a NULL value");
+	EE_ASSERT(out != NULL && out->elem_size == sizeof(size_t), "Found indices go to an Array of size_t");
+	EE_ASSERT(low <= high, "Invalid bounds (%zu, %zu)", low, high);
+	EE_ASSERT(high * array->elem_size <= array->top, "Invalid index (%zu) for array with size (%zu)", high, ee_array_len(array));
 
-			if (mask)
-			{
-				i32 first = ee_first_bit_u32(mask);
+	const SimdKernels* kernels = ee_simd_kernels();
+	size_t found = 0;
 
-				return (i >> 1) + (first >> 1);
-			}
-		}
-	} break;
-	case 4:
+	for (size_t i = low; i < high; i += EE_ARRAY_MATCH_CHUNK)
 	{
-		u32 a;
-		memcpy(&a, target, sizeof(a));
-
-		ee_simd_i pattern = ee_set1_epi32(a);
+		size_t count = ee_min_u64(high - i, EE_ARRAY_MATCH_CHUNK);
+		u64 mask = _ee_array_match(kernels, &array->buffer[i * array->elem_size], count, target, array->elem_size);
 
-		for (; i < high_tail; i += EE_SIMD_BYTES)
+		while (mask)
 		{
-			ee_simd_i group = ee_loadu_si((const ee_simd_i*)&array->buffer[i]);
-			ee_simd_i match = ee_cmpeq_epi32(pattern, group);
-
-			i32 mask = ee_movemask_epi8(match);
+			size_t index = i + ee_first_bit_u64(mask);
 
-			if (mask)
-			{
-				i32 first = ee_first_bit_u32(mask);
+			ee_array_push(out, EE_RECAST_U8(index));
+			found++;
 
-				return (i >> 2) + (first >> 2);
-			}
+			mask &= mask - 1;
 		}
-	} break;
-	case 8:
+	}
+
+	return found;
+}
+
+EE_INLINE size_t ee_array_find_all(const Array* array, const u8* target, Array* out)
+{
+	return ee_array_find_all_b(array, target, 0, ee_array_len(array), out);
+}
+
+EE_INLINE size_t ee_array_count_b(const Array* array, const u8* target, size_t low, size_t high)
+{
+	EE_ASSERT(array != NULL, "Trying to count in NULL Array");
+	EE_ASSERT(target != NULL, "Trying to count a NULL value");
+	EE_ASSERT(low <= high, "Invalid bounds (%zu, %zu)", low, high);
+	EE_ASSERT(high * array->elem_size <= array->top, "Invalid index (%zu) for array with size (%zu)", high, ee_array_len(array));
+
+	const SimdKernels* kernels = ee_simd_kernels();
+	size_t found = 0;
+
+	for (size_t i = low; i < high; i += EE_ARRAY_MATCH_CHUNK)
 	{
-		u64 a;
-		memcpy(&a, target, sizeof(a));
+		size_t count = ee_min_u64(high - i, EE_ARRAY_MATCH_CHUNK);
 
-		ee_simd_i pattern = ee_set1_epi64(a);
+		found += ee_popcnt_u64(_ee_array_match(kernels, &array->buffer[i * array->elem_size], count, target, array->elem_size));
+	}
 
-		for (; i < high_tail; i += EE_SIMD_BYTES)
-		{
-			ee_simd_i group = ee_loadu_si((const ee_simd_i*)&array->buffer[i]);
-			ee_simd_i match = ee_cmpeq_epi64(pattern, group);
+	return found;
+}
 
-			i32 mask = ee_movemask_epi8(match);
+EE_INLINE size_t ee_array_count(const Array* array, const u8* target)
+{
+	return ee_array_count_b(array, target, 0, ee_array_len(array));
+}
 
-			if (mask)
-			{
-				i32 first = ee_first_bit_u32(mask);
+// Index of the first element of [low, high) equal to any of the 'targets_count' needles stored back to back
+// in 'targets', EE_ARRAY_INVALID if there is none. Every chunk is matched against all needles before moving on
+EE_INLINE size_t ee_array_find_any_b(const Array* array, const u8* targets, size_t targets_count, size_t low, size_t high)
+{
+	EE_ASSERT(array != NULL, "Trying to find in NULL Array");
+	EE_ASSERT(targets != NULL, "Trying to find NULL values");
+	EE_ASSERT(low <= high, "Invalid bounds (%zu, %zu)", low, high);
+	EE_ASSERT(high * array->elem_size <= array->top, "Invalid index (%zu) for array with size (%zu)", high, ee_array_len(array));
 
-				return (i >> 3) + (first >> 3);
-			}
-		}
-	} break;
-	default:
+	const SimdKernels* kernels = ee_simd_kernels();
+
+	for (size_t i = low; i < high; i += EE_ARRAY_MATCH_CHUNK)
 	{
-		for (; i < high_b; i += array->elem_size)
+		size_t count = ee_min_u64(high - i, EE_ARRAY_MATCH_CHUNK);
+		const u8* buffer = &array->buffer[i * array->elem_size];
+		u64 mask = 0;
+
+		for (size_t t = 0; t < targets_count; ++t)
 		{
-			if (memcmp(target, &array->buffer[i], array->elem_size) == 0)
-			{
-				return i / array->elem_size;
-			}
+			mask |= _ee_array_match(kernels, buffer, count, &targets[t * array->elem_size], array->elem_size);
 		}
-	} break;
-	}
 
-	for (; i < array->top; i += array->elem_size)
-	{
-		if (ee_eq_def(target, &array->buffer[i], array->elem_size))
+		if (mask)
 		{
-			return i / array->elem_size;
+			return i + ee_first_bit_u64(mask);
 		}
 	}
 
 	return EE_ARRAY_INVALID;
 }
 
+EE_INLINE size_t ee_array_find_any(const Array* array, const u8* targets, size_t targets_count)
+{
+	return ee_array_find_any_b(array, targets, targets_count, 0, ee_array_len(array));
+}
+
 EE_INLINE size_t ee_array_find_pred_b(const Array* array, const u8* target, BinCmp predicate, size_t low, size_t high)
 {
 	EE_ASSERT(array != NULL, "Trying to find in NULL Array");
@@ -697,6 +742,93 @@ EE_INLINE void ee_array_introsort(Array* array, BinCmp cmp, i64 low, i64 high, i
 	}
 }
 
+// Merges sorted 'a' and 'b' into 'out', ties take 'a' first
+EE_INLINE void _ee_array_merge(const u8* a, size_t a_len, const u8* b, size_t b_len, u8* out, size_t elem_size, BinCmp cmp)
+{
+	size_t i = 0, j = 0;
+
+	while (i < a_len && j < b_len)
+	{
+		if (cmp(&b[j * elem_size], &a[i * elem_size]) < 0)
+		{
+			memcpy(out, &b[j * elem_size], elem_size);
+			j++;
+		}
+		else
+		{
+			memcpy(out, &a[i * elem_size], elem_size);
+			i++;
+		}
+
+		out += elem_size;
+	}
+
+	memcpy(out, &a[i * elem_size], (a_len - i) * elem_size);
+	out += (a_len - i) * elem_size;
+
+	memcpy(out, &b[j * elem_size], (b_len - j) * elem_size);
+}
+
+// Stable merge sort: runs of EE_ARRAY_SORT_TH elements are insertion sorted, then merged bottom up between
+// the array and a scratch copy from its allocator. Neighbouring runs that are already in order are only copied
+EE_INLINE void ee_array_merge_sort(Array* array, BinCmp cmp)
+{
+	EE_ASSERT(array != NULL, "Trying to sort a NULL Array");
+	EE_ASSERT(cmp != NULL, "Trying to sort with a NULL BinCmp");
+
+	size_t n = ee_array_len(array);
+	size_t elem_size = array->elem_size;
+
+	for (size_t lo = 0; lo < n; lo += EE_ARRAY_SORT_TH)
+	{
+		size_t hi = ee_min_u64(lo + EE_ARRAY_SORT_TH, n);
+
+		ee_array_insertsort(array, cmp, (i64)(lo * elem_size), (i64)((hi - 1) * elem_size));
+	}
+
+	if (n <= EE_ARRAY_SORT_TH)
+	{
+		return;
+	}
+
+	u8* scratch = (u8*)array->allocator.alloc_fn(&array->allocator, n * elem_size);
+
+	EE_ASSERT(scratch != NULL, "Unable to allocate (%zu) bytes for merge sort", n * elem_size);
+
+	u8* src = array->buffer;
+	u8* dst = scratch;
+
+	for (size_t width = EE_ARRAY_SORT_TH; width < n; width <<= 1)
+	{
+		for (size_t lo = 0; lo < n; lo += 2 * width)
+		{
+			size_t mid = ee_min_u64(lo + width, n);
+			size_t hi  = ee_min_u64(lo + 2 * width, n);
+
+			if (mid == hi || cmp(&src[(mid - 1) * elem_size], &src[mid * elem_size]) <= 0)
+			{
+				memcpy(&dst[lo * elem_size], &src[lo * elem_size], (hi - lo) * elem_size);
+			}
+			else
+			{
+				_ee_array_merge(&src[lo * elem_size], mid - lo, &src[mid * elem_size], hi - mid, &dst[lo * elem_size], elem_size, cmp);
+			}
+		}
+
+		u8* temp = src;
+
+		src = dst;
+		dst = temp;
+	}
+
+	if (src != array->buffer)
+	{
+		memcpy(array->buffer, src, n * elem_size);
+	}
+
+	array->allocator.free_fn(&array->allocator, scratch);
+}
+
 EE_INLINE void ee_array_sort(Array* array, BinCmp cmp, ArraySortType type)
 {
 	switch (type)
@@ -713,6 +845,10 @@ EE_INLINE void ee_array_sort(Array* array, BinCmp cmp, ArraySortType type)
 		{
 		ee_array_heapsort(array, cmp, 0, ee_array_size(array) - array->elem_size);
 		} break;
+	case EE_SORT_MERGE:
+		{
+		ee_array_merge_sort(array, cmp);
+		} break;
 	case EE_SORT_DEFAULT:
 	case EE_SORT_INTRO:
 		{
@@ -729,6 +865,670 @@ EE_INLINE void ee_array_sort(Array* array, BinCmp cmp, ArraySortType type)
 	}
 }
 
+EE_INLINE u64 _ee_radix_load(const u8* key, size_t key_len)
+{
+	switch (key_len)
+	{
+	case 1: return *key;
+	case 2: { u16 v; memcpy(&v, key, sizeof(v)); return v; }
+	case 4: { u32 v; memcpy(&v, key, sizeof(v)); return v; }
+	default: { u64 v; memcpy(&v, key, sizeof(v)); return v; }
+	}
+}
+
+EE_INLINE void _ee_radix_store(u8* key, size_t key_len, u64 val)
+{
+	switch (key_len)
+	{
+	case 1: *key = (u8)val; break;
+	case 2: { u16 v = (u16)val; memcpy(key, &v, sizeof(v)); } break;
+	case 4: { u32 v = (u32)val; memcpy(key, &v, sizeof(v)); } break;
+	default: memcpy(key, &val, sizeof(val)); break;
+	}
+}
+
+// Maps a key to an unsigned value with the same order, 'sign' is the top bit of the key.
+// Negative floats order backwards: every bit of those is flipped, only the sign of the rest
+EE_INLINE u64 _ee_radix_flip(u64 key, u64 sign, ArrayRadixType type)
+{
+	if (type == EE_RADIX_FLOAT && (key & sign))
+		return key ^ (sign | (sign - 1));
+
+	return type == EE_RADIX_UNSIGNED ? key : key ^ sign;
+}
+
+EE_INLINE u64 _ee_radix_unflip(u64 key, u64 sign, ArrayRadixType type)
+{
+	if (type == EE_RADIX_FLOAT && !(key & sign))
+		return key ^ (sign | (sign - 1));
+
+	return type == EE_RADIX_UNSIGNED ? key : key ^ sign;
+}
+
+// One LSD pass over keys already flipped to unsigned, 'offsets' holds the first output index of every digit.
+// The destination of the element EE_ARRAY_RADIX_PREFETCH places ahead is prefetched
+#define _EE_RADIX_SCATTER(elem_len, key_type)                                                                 \
+	for (size_t i = 0; i < n; ++i)                                                                            \
+	{                                                                                                         \
+		const u8* elem = &src[i * (elem_len)];                                                                \
+		key_type key;                                                                                         \
+                                                                                                              \
+		if (i + EE_ARRAY_RADIX_PREFETCH < n)                                                                  \
+		{                                                                                                     \
+			memcpy(&key, &elem[EE_ARRAY_RADIX_PREFETCH * (elem_len) + key_off], sizeof(key));                 \
+			eed_prefetch((const char*)&dst[offsets[(key >> shift) & 0xFF] * (elem_len)], EED_SIMD_PREFETCH_T0); \
+		}                                                                                                     \
+                                                                                                              \
+		memcpy(&key, &elem[key_off], sizeof(key));                                                            \
+		memcpy(&dst[offsets[(key >> shift) & 0xFF]++ * (elem_len)], elem, (elem_len));                        \
+	}
+
+// Stable LSD radix sort on the 'key_len' byte key at 'key_off' inside every element, 8 bits per pass.
+// Signed and float keys are flipped to unsigned in place before the passes and back after them.
+// All digit histograms come from one read, passes where every key has the same digit are skipped.
+// Needs a scratch copy of the array from its allocator. Floats sort -NaN first and NaN last, -0 before 0
+EE_INLINE void ee_array_radix_sort_key(Array* array, size_t key_off, size_t key_len, ArrayRadixType type)
+{
+	EE_ASSERT(array != NULL, "Trying to sort a NULL Array");
+	EE_ASSERT(key_len == 1 || key_len == 2 || key_len == 4 || key_len == 8, "Invalid radix key length (%zu)", key_len);
+	EE_ASSERT(key_off + key_len <= array->elem_size, "Radix key (%zu, %zu) is out of the element (%zu)", key_off, key_len, array->elem_size);
+	EE_ASSERT(type != EE_RADIX_FLOAT || key_len >= 4, "Float radix keys should be 4 or 8 bytes, got (%zu)", key_len);
+
+	size_t n = ee_array_len(array);
+	size_t elem_size = array->elem_size;
+	u64 sign = 1ull << (8 * key_len - 1);
+
+	if (n < 2)
+	{
+		return;
+	}
+
+	size_t hist[8][256];
+
+	memset(hist, 0, key_len * sizeof(hist[0]));
+
+	for (size_t i = 0; i < n; ++i)
+	{
+		u8* elem = &array->buffer[i * elem_size + key_off];
+		u64 key = _ee_radix_load(elem, key_len);
+
+		if (type != EE_RADIX_UNSIGNED)
+		{
+			key = _ee_radix_flip(key, sign, type);
+			_ee_radix_store(elem, key_len, key);
+		}
+
+		for (size_t pass = 0; pass < key_len; ++pass)
+		{
+			hist[pass][(key >> (8 * pass)) & 0xFF]++;
+		}
+	}
+
+	u8* scratch = (u8*)array->allocator.alloc_fn(&array->allocator, n * elem_size);
+
+	EE_ASSERT(scratch != NULL, "Unable to allocate (%zu) bytes for radix sort", n * elem_size);
+
+	u8* src = array->buffer;
+	u8* dst = scratch;
+
+	u64 first = _ee_radix_load(&array->buffer[key_off], key_len);
+
+	for (size_t pass = 0; pass < key_len; ++pass)
+	{
+		u32 shift = (u32)(8 * pass);
+		size_t* offsets = hist[pass];
+
+		if (offsets[(first >> shift) & 0xFF] == n)
+			continue;
+
+		size_t sum = 0;
+
+		for (size_t d = 0; d < 256; ++d)
+		{
+			size_t count = offsets[d];
+
+			offsets[d] = sum;
+			sum += count;
+		}
+
+		// Plain arrays get a fixed element size, records only a fixed key type
+		if (elem_size == key_len)
+		{
+			switch (key_len)
+			{
+			case 1:  _EE_RADIX_SCATTER(1, u8) break;
+			case 2:  _EE_RADIX_SCATTER(2, u16) break;
+			case 4:  _EE_RADIX_SCATTER(4, u32) break;
+			default: _EE_RADIX_SCATTER(8, u64) break;
+			}
+		}
+		else
+		{
+			switch (key_len)
+			{
+			case 1:  _EE_RADIX_SCATTER(elem_size, u8) break;
+			case 2:  _EE_RADIX_SCATTER(elem_size, u16) break;
+			case 4:  _EE_RADIX_SCATTER(elem_size, u32) break;
+			default: _EE_RADIX_SCATTER(elem_size, u64) break;
+			}
+		}
+
+		u8* temp = src;
+
+		src = dst;
+		dst = temp;
+	}
+
+	if (src != array->buffer)
+	{
+		memcpy(array->buffer, src, n * elem_size);
+	}
+
+	array->allocator.free_fn(&array->allocator, scratch);
+
+	if (type != EE_RADIX_UNSIGNED)
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			u8* elem = &array->buffer[i * elem_size + key_off];
+
+			_ee_radix_store(elem, key_len, _ee_radix_unflip(_ee_radix_load(elem, key_len), sign, type));
+		}
+	}
+}
+
+// Radix sort of an array of 1/2/4/8 byte numbers
+EE_INLINE void ee_array_radix_sort(Array* array, ArrayRadixType type)
+{
+	EE_ASSERT(array != NULL, "Trying to sort a NULL Array");
+
+	ee_array_radix_sort_key(array, 0, array->elem_size, type);
+}
+
+// Maps 4 and 8 byte numbers to signed integers with the same order: unsigned flips the sign bit, negative floats
+// every other bit. Mapping twice gives the number back
+EE_INLINE void _ee_sort_num_flip(u8* buffer, size_t n, size_t elem_size, ArrayRadixType type)
+{
+	if (elem_size == sizeof(u32))
+	{
+		u32* keys = (u32*)buffer;
+
+		if (type == EE_RADIX_UNSIGNED)
+			for (size_t i = 0; i < n; ++i) keys[i] ^= 0x80000000u;
+		else if (type == EE_RADIX_FLOAT)
+			for (size_t i = 0; i < n; ++i) keys[i] ^= (u32)((i32)keys[i] >> 31) >> 1;
+	}
+	else
+	{
+		u64* keys = (u64*)buffer;
+
+		if (type == EE_RADIX_UNSIGNED)
+			for (size_t i = 0; i < n; ++i) keys[i] ^= 0x8000000000000000ull;
+		else if (type == EE_RADIX_FLOAT)
+			for (size_t i = 0; i < n; ++i) keys[i] ^= (u64)((i64)keys[i] >> 63) >> 1;
+	}
+}
+
+// Scalar kernels of the numeric introsort for i32 and i64
+#define _EE_SORT_NUM_DEFINE(bits)                                                               \
+EE_INLINE void _ee_sort_insert_i##bits(i##bits* a, size_t n)                                    \
+{                                                                                               \
+	for (size_t i = 1; i < n; ++i)                                                              \
+	{                                                                                           \
+		i##bits x = a[i];                                                                       \
+		size_t j = i;                                                                           \
+                                                                                                \
+		for (; j > 0 && a[j - 1] > x; --j)                                                      \
+			a[j] = a[j - 1];                                                                    \
+                                                                                                \
+		a[j] = x;                                                                               \
+	}                                                                                           \
+}                                                                                               \
+                                                                                                \
+EE_INLINE void _ee_sort_sift_i##bits(i##bits* a, size_t root, size_t n)                         \
+{                                                                                               \
+	i##bits x = a[root];                                                                        \
+                                                                                                \
+	for (size_t child = 2 * root + 1; child < n; child = 2 * root + 1)                          \
+	{                                                                                           \
+		if (child + 1 < n && a[child] < a[child + 1])                                           \
+			child++;                                                                            \
+                                                                                                \
+		if (a[child] <= x)                                                                      \
+			break;                                                                              \
+                                                                                                \
+		a[root] = a[child];                                                                     \
+		root = child;                                                                           \
+	}                                                                                           \
+                                                                                                \
+	a[root] = x;                                                                                \
+}                                                                                               \
+                                                                                                \
+EE_INLINE void _ee_sort_heap_i##bits(i##bits* a, size_t n)                                      \
+{                                                                                               \
+	for (size_t start = n >> 1; start-- > 0; )                                                  \
+		_ee_sort_sift_i##bits(a, start, n);                                                     \
+                                                                                                \
+	for (size_t end = n - 1; end > 0; --end)                                                    \
+	{                                                                                           \
+		i##bits x = a[0];                                                                       \
+                                                                                                \
+		a[0] = a[end];                                                                          \
+		a[end] = x;                                                                             \
+                                                                                                \
+		_ee_sort_sift_i##bits(a, 0, end);                                                       \
+	}                                                                                           \
+}                                                                                               \
+                                                                                                \
+/* Moves the elements below 'pivot' (at most 'pivot' with 'le') to the front, returns their count */ \
+EE_INLINE size_t _ee_sort_partition_i##bits(i##bits* a, size_t n, i##bits pivot, i32 le)         \
+{                                                                                               \
+	size_t i = 0, j = n;                                                                        \
+                                                                                                \
+	while (EE_TRUE)                                                                             \
+	{                                                                                           \
+		while (i < j && (a[i] < pivot || (le && a[i] == pivot)))                                \
+			i++;                                                                                \
+                                                                                                \
+		while (i < j && !(a[j - 1] < pivot || (le && a[j - 1] == pivot)))                       \
+			j--;                                                                                \
+                                                                                                \
+		if (i >= j)                                                                             \
+			break;                                                                              \
+                                                                                                \
+		i##bits x = a[i];                                                                       \
+                                                                                                \
+		a[i++] = a[--j];                                                                        \
+		a[j] = x;                                                                               \
+	}                                                                                           \
+                                                                                                \
+	return i;                                                                                   \
+}
+
+_EE_SORT_NUM_DEFINE(32)
+_EE_SORT_NUM_DEFINE(64)
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX
+
+// Lane order for the vectorized partition, lanes with their mask bit set go first. One index byte per 32 bit lane
+static const u64 _ee_sort_perm_i32[256] =
+{
+	0x0706050403020100ull, 0x0706050403020100ull, 0x0706050403020001ull, 0x0706050403020100ull,
+	0x0706050403010002ull, 0x0706050403010200ull, 0x0706050403000201ull, 0x0706050403020100ull,
+	0x0706050402010003ull, 0x0706050402010300ull, 0x0706050402000301ull, 0x0706050402030100ull,
+	0x0706050401000302ull, 0x0706050401030200ull, 0x0706050400030201ull, 0x0706050403020100ull,
+	0x0706050302010004ull, 0x0706050302010400ull, 0x0706050302000401ull, 0x0706050302040100ull,
+	0x0706050301000402ull, 0x0706050301040200ull, 0x0706050300040201ull, 0x0706050304020100ull,
+	0x0706050201000403ull, 0x0706050201040300ull, 0x0706050200040301ull, 0x0706050204030100ull,
+	0x0706050100040302ull, 0x0706050104030200ull, 0x0706050004030201ull, 0x0706050403020100ull,
+	0x0706040302010005ull, 0x0706040302010500ull, 0x0706040302000501ull, 0x0706040302050100ull,
+	0x0706040301000502ull, 0x0706040301050200ull, 0x0706040300050201ull, 0x0706040305020100ull,
+	0x0706040201000503ull, 0x0706040201050300ull, 0x0706040200050301ull, 0x0706040205030100ull,
+	0x0706040100050302ull, 0x0706040105030200ull, 0x0706040005030201ull, 0x0706040503020100ull,
+	0x0706030201000504ull, 0x0706030201050400ull, 0x0706030200050401ull, 0x0706030205040100ull,
+	0x0706030100050402ull, 0x0706030105040200ull, 0x0706030005040201ull, 0x0706030504020100ull,
+	0x0706020100050403ull, 0x0706020105040300ull, 0x0706020005040301ull, 0x0706020504030100ull,
+	0x0706010005040302ull, 0x0706010504030200ull, 0x0706000504030201ull, 0x0706050403020100ull,
+	0x0705040302010006ull, 0x0705040302010600ull, 0x0705040302000601ull, 0x0705040302060100ull,
+	0x0705040301000602ull, 0x0705040301060200ull, 0x0705040300060201ull, 0x0705040306020100ull,
+	0x0705040201000603ull, 0x0705040201060300ull, 0x0705040200060301ull, 0x0705040206030100ull,
+	0x0705040100060302ull, 0x0705040106030200ull, 0x0705040006030201ull, 0x0705040603020100ull,
+	0x0705030201000604ull, 0x0705030201060400ull, 0x0705030200060401ull, 0x0705030206040100ull,
+	0x0705030100060402ull, 0x0705030106040200ull, 0x0705030006040201ull, 0x0705030604020100ull,
+	0x0705020100060403ull, 0x0705020106040300ull, 0x0705020006040301ull, 0x0705020604030100ull,
+	0x0705010006040302ull, 0x0705010604030200ull, 0x0705000604030201ull, 0x0705060403020100ull,
+	0x0704030201000605ull, 0x0704030201060500ull, 0x0704030200060501ull, 0x0704030206050100ull,
+	0x0704030100060502ull, 0x0704030106050200ull, 0x0704030006050201ull, 0x0704030605020100ull,
+	0x0704020100060503ull, 0x0704020106050300ull, 0x0704020006050301ull, 0x0704020605030100ull,
+	0x0704010006050302ull, 0x0704010605030200ull, 0x0704000605030201ull, 0x0704060503020100ull,
+	0x0703020100060504ull, 0x0703020106050400ull, 0x0703020006050401ull, 0x0703020605040100ull,
+	0x0703010006050402ull, 0x0703010605040200ull, 0x0703000605040201ull, 0x0703060504020100ull,
+	0x0702010006050403ull, 0x0702010605040300ull, 0x0702000605040301ull, 0x0702060504030100ull,
+	0x0701000605040302ull, 0x0701060504030200ull, 0x0700060504030201ull, 0x0706050403020100ull,
+	0x0605040302010007ull, 0x0605040302010700ull, 0x0605040302000701ull, 0x0605040302070100ull,
+	0x0605040301000702ull, 0x0605040301070200ull, 0x0605040300070201ull, 0x0605040307020100ull,
+	0x0605040201000703ull, 0x0605040201070300ull, 0x0605040200070301ull, 0x0605040207030100ull,
+	0x0605040100070302ull, 0x0605040107030200ull, 0x0605040007030201ull, 0x0605040703020100ull,
+	0x0605030201000704ull, 0x0605030201070400ull, 0x0605030200070401ull, 0x0605030207040100ull,
+	0x0605030100070402ull, 0x0605030107040200ull, 0x0605030007040201ull, 0x0605030704020100ull,
+	0x0605020100070403ull, 0x0605020107040300ull, 0x0605020007040301ull, 0x0605020704030100ull,
+	0x0605010007040302ull, 0x0605010704030200ull, 0x0605000704030201ull, 0x0605070403020100ull,
+	0x0604030201000705ull, 0x0604030201070500ull, 0x0604030200070501ull, 0x0604030207050100ull,
+	0x0604030100070502ull, 0x0604030107050200ull, 0x0604030007050201ull, 0x0604030705020100ull,
+	0x0604020100070503ull, 0x0604020107050300ull, 0x0604020007050301ull, 0x0604020705030100ull,
+	0x0604010007050302ull, 0x0604010705030200ull, 0x0604000705030201ull, 0x0604070503020100ull,
+	0x0603020100070504ull, 0x0603020107050400ull, 0x0603020007050401ull, 0x0603020705040100ull,
+	0x0603010007050402ull, 0x0603010705040200ull, 0x0603000705040201ull, 0x0603070504020100ull,
+	0x0602010007050403ull, 0x0602010705040300ull, 0x0602000705040301ull, 0x0602070504030100ull,
+	0x0601000705040302ull, 0x0601070504030200ull, 0x0600070504030201ull, 0x0607050403020100ull,
+	0x0504030201000706ull, 0x0504030201070600ull, 0x0504030200070601ull, 0x0504030207060100ull,
+	0x0504030100070602ull, 0x0504030107060200ull, 0x0504030007060201ull, 0x0504030706020100ull,
+	0x0504020100070603ull, 0x0504020107060300ull, 0x0504020007060301ull, 0x0504020706030100ull,
+	0x0504010007060302ull, 0x0504010706030200ull, 0x0504000706030201ull, 0x0504070603020100ull,
+	0x0503020100070604ull, 0x0503020107060400ull, 0x0503020007060401ull, 0x0503020706040100ull,
+	0x0503010007060402ull, 0x0503010706040200ull, 0x0503000706040201ull, 0x0503070604020100ull,
+	0x0502010007060403ull, 0x0502010706040300ull, 0x0502000706040301ull, 0x0502070604030100ull,
+	0x0501000706040302ull, 0x0501070604030200ull, 0x0500070604030201ull, 0x0507060403020100ull,
+	0x0403020100070605ull, 0x0403020107060500ull, 0x0403020007060501ull, 0x0403020706050100ull,
+	0x0403010007060502ull, 0x0403010706050200ull, 0x0403000706050201ull, 0x0403070605020100ull,
+	0x0402010007060503ull, 0x0402010706050300ull, 0x0402000706050301ull, 0x0402070605030100ull,
+	0x0401000706050302ull, 0x0401070605030200ull, 0x0400070605030201ull, 0x0407060503020100ull,
+	0x0302010007060504ull, 0x0302010706050400ull, 0x0302000706050401ull, 0x0302070605040100ull,
+	0x0301000706050402ull, 0x0301070605040200ull, 0x0300070605040201ull, 0x0307060504020100ull,
+	0x0201000706050403ull, 0x0201070605040300ull, 0x0200070605040301ull, 0x0207060504030100ull,
+	0x0100070605040302ull, 0x0107060504030200ull, 0x0007060504030201ull, 0x0706050403020100ull,
+};
+
+// Same for 64 bit lanes, every lane is a pair of 32 bit indices
+static const u64 _ee_sort_perm_i64[16] =
+{
+	0x0706050403020100ull, 0x0706050403020100ull, 0x0706050401000302ull, 0x0706050403020100ull,
+	0x0706030201000504ull, 0x0706030205040100ull, 0x0706010005040302ull, 0x0706050403020100ull,
+	0x0504030201000706ull, 0x0504030207060100ull, 0x0504010007060302ull, 0x0504070603020100ull,
+	0x0302010007060504ull, 0x0302070605040100ull, 0x0100070605040302ull, 0x0706050403020100ull,
+};
+
+// One compare-exchange layer inside a register, 'w' holds the partner of every lane of 'v'.
+// Lanes set in the immediate 'hi' keep the larger value of the pair
+#define _EE_SORT_LAYER_I32(v, w, hi) \
+	_mm256_blend_epi32(_mm256_min_epi32(v, w), _mm256_max_epi32(v, w), hi)
+
+#define _EE_SORT_LAYER_I64(v, w, hi)                                                \
+	_mm256_blend_epi32(_mm256_blendv_epi8(v, w, _mm256_cmpgt_epi64(v, w)),          \
+	                   _mm256_blendv_epi8(w, v, _mm256_cmpgt_epi64(v, w)), hi)
+
+// Last three layers of a bitonic merge, the register holds a bitonic sequence
+EE_TARGET("avx2") EE_INLINE __m256i _ee_sort_merge_i32_avx2(__m256i v)
+{
+	v = _EE_SORT_LAYER_I32(v, _mm256_permute2x128_si256(v, v, 0x01), 0xF0);
+	v = _EE_SORT_LAYER_I32(v, _mm256_shuffle_epi32(v, 0x4E), 0xCC);
+	v = _EE_SORT_LAYER_I32(v, _mm256_shuffle_epi32(v, 0xB1), 0xAA);
+
+	return v;
+}
+
+// Bitonic network of 8 lanes, ascending
+EE_TARGET("avx2") EE_INLINE __m256i _ee_sort_reg_i32_avx2(__m256i v)
+{
+	v = _EE_SORT_LAYER_I32(v, _mm256_shuffle_epi32(v, 0xB1), 0x66);
+	v = _EE_SORT_LAYER_I32(v, _mm256_shuffle_epi32(v, 0x4E), 0x3C);
+	v = _EE_SORT_LAYER_I32(v, _mm256_shuffle_epi32(v, 0xB1), 0x5A);
+
+	return _ee_sort_merge_i32_avx2(v);
+}
+
+EE_TARGET("avx2") EE_INLINE __m256i _ee_sort_rev_i32_avx2(__m256i v)
+{
+	return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+EE_TARGET("avx2") EE_INLINE void _ee_sort_minmax_i32_avx2(__m256i* a, __m256i* b)
+{
+	__m256i lo = _mm256_min_epi32(*a, *b);
+
+	*b = _mm256_max_epi32(*a, *b);
+	*a = lo;
+}
+
+EE_TARGET("avx2") EE_INLINE u32 _ee_sort_mask_i32_avx2(__m256i v)
+{
+	return (u32)_mm256_movemask_ps(_mm256_castsi256_ps(v));
+}
+
+EE_TARGET("avx2") EE_INLINE __m256i _ee_sort_merge_i64_avx2(__m256i v)
+{
+	v = _EE_SORT_LAYER_I64(v, _mm256_permute2x128_si256(v, v, 0x01), 0xF0);
+	v = _EE_SORT_LAYER_I64(v, _mm256_shuffle_epi32(v, 0x4E), 0xCC);
+
+	return v;
+}
+
+// Bitonic network of 4 lanes, ascending
+EE_TARGET("avx2") EE_INLINE __m256i _ee_sort_reg_i64_avx2(__m256i v)
+{
+	v = _EE_SORT_LAYER_I64(v, _mm256_shuffle_epi32(v, 0x4E), 0x3C);
+
+	return _ee_sort_merge_i64_avx2(v);
+}
+
+EE_TARGET("avx2") EE_INLINE __m256i _ee_sort_rev_i64_avx2(__m256i v)
+{
+	return _mm256_permute4x64_epi64(v, 0x1B);
+}
+
+EE_TARGET("avx2") EE_INLINE void _ee_sort_minmax_i64_avx2(__m256i* a, __m256i* b)
+{
+	__m256i gt = _mm256_cmpgt_epi64(*a, *b);
+	__m256i lo = _mm256_blendv_epi8(*a, *b, gt);
+
+	*b = _mm256_blendv_epi8(*b, *a, gt);
+	*a = lo;
+}
+
+EE_TARGET("avx2") EE_INLINE u32 _ee_sort_mask_i64_avx2(__m256i v)
+{
+	return (u32)_mm256_movemask_pd(_mm256_castsi256_pd(v));
+}
+
+// AVX2 kernels of the numeric introsort:
+//   Sorting network - every register is sorted on its own, then sorted runs of registers are merged pairwise:
+//                     the second run is reversed so the pair is bitonic, compare-exchange across registers
+//                     halves the distance down to one register, the in-register layers finish. No branches
+//                     on the data, the tail of the last register is padded with the largest value
+//   Partition       - every register is compared with the pivot, a permutation from the movemask puts the lower
+//                     lanes first and the same register is stored at both write ends. Reads come from the end
+//                     with less free space, the first and last registers are held back so writes never overtake them
+#define _EE_SORT_AVX2_DEFINE(bits, lanes, max, set1)                                            \
+EE_TARGET("avx2") EE_INLINE void _ee_sort_small_i##bits##_avx2(i##bits* a, size_t n)            \
+{                                                                                               \
+	i##bits buf[EE_ARRAY_SORT_NET_TH];                                                          \
+	__m256i v[EE_ARRAY_SORT_NET_TH / (lanes)];                                                  \
+	size_t regs = 1;                                                                            \
+                                                                                                \
+	while (regs * (lanes) < n)                                                                  \
+		regs <<= 1;                                                                             \
+                                                                                                \
+	memcpy(buf, a, n * sizeof(*a));                                                             \
+                                                                                                \
+	for (size_t i = n; i < regs * (lanes); ++i)                                                 \
+		buf[i] = (max);                                                                         \
+                                                                                                \
+	for (size_t r = 0; r < regs; ++r)                                                           \
+		v[r] = _ee_sort_reg_i##bits##_avx2(_mm256_loadu_si256((const __m256i*)&buf[r * (lanes)])); \
+                                                                                                \
+	for (size_t width = 1; width < regs; width <<= 1)                                           \
+	{                                                                                           \
+		for (size_t base = 0; base < regs; base += 2 * width)                                   \
+		{                                                                                       \
+			__m256i* run = &v[base + width];                                                    \
+                                                                                                \
+			for (size_t r = 0; r < width / 2; ++r)                                              \
+			{                                                                                   \
+				__m256i temp = run[r];                                                          \
+                                                                                                \
+				run[r] = run[width - 1 - r];                                                    \
+				run[width - 1 - r] = temp;                                                      \
+			}                                                                                   \
+                                                                                                \
+			for (size_t r = 0; r < width; ++r)                                                  \
+				run[r] = _ee_sort_rev_i##bits##_avx2(run[r]);                                   \
+                                                                                                \
+			for (size_t step = width; step > 0; step >>= 1)                                     \
+				for (size_t r = 0; r < 2 * width; ++r)                                          \
+					if ((r & step) == 0)                                                        \
+						_ee_sort_minmax_i##bits##_avx2(&v[base + r], &v[base + r + step]);      \
+                                                                                                \
+			for (size_t r = base; r < base + 2 * width; ++r)                                    \
+				v[r] = _ee_sort_merge_i##bits##_avx2(v[r]);                                     \
+		}                                                                                       \
+	}                                                                                           \
+                                                                                                \
+	for (size_t r = 0; r < regs; ++r)                                                           \
+		_mm256_storeu_si256((__m256i*)&buf[r * (lanes)], v[r]);                                 \
+                                                                                                \
+	memcpy(a, buf, n * sizeof(*a));                                                             \
+}                                                                                               \
+                                                                                                \
+/* Same result as _ee_sort_partition_i##bits, needs at least two registers of elements */      \
+EE_TARGET("avx2") EE_INLINE size_t _ee_sort_partition_i##bits##_avx2(i##bits* a, size_t n, i##bits pivot, i32 le) \
+{                                                                                               \
+	__m256i p = set1(pivot);                                                                     \
+	__m256i first = _mm256_loadu_si256((const __m256i*)a);                                      \
+	__m256i last = _mm256_loadu_si256((const __m256i*)&a[n - (lanes)]);                         \
+	u32 flip = le ? (1u << (lanes)) - 1 : 0;                                                    \
+                                                                                                \
+	/* Written are [0, l) and [r, n), unread is [read_l, read_r) */                             \
+	size_t l = 0, r = n;                                                                        \
+	size_t read_l = (lanes), read_r = n - (lanes);                                              \
+                                                                                                \
+	while (read_r - read_l >= (lanes))                                                          \
+	{                                                                                           \
+		__m256i v;                                                                              \
+                                                                                                \
+		if (read_l - l <= r - read_r)                                                           \
+		{                                                                                       \
+			v = _mm256_loadu_si256((const __m256i*)&a[read_l]);                                 \
+			read_l += (lanes);                                                                  \
+		}                                                                                       \
+		else                                                                                    \
+		{                                                                                       \
+			read_r -= (lanes);                                                                  \
+			v = _mm256_loadu_si256((const __m256i*)&a[read_r]);                                 \
+		}                                                                                       \
+                                                                                                \
+		__m256i gt = le ? _mm256_cmpgt_epi##bits(v, p) : _mm256_cmpgt_epi##bits(p, v);          \
+		u32 mask = _ee_sort_mask_i##bits##_avx2(gt) ^ flip;                                     \
+		__m256i perm = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)&_ee_sort_perm_i##bits[mask])); \
+		size_t count = (size_t)ee_popcnt_u32(mask);                                             \
+                                                                                                \
+		v = _mm256_permutevar8x32_epi32(v, perm);                                               \
+                                                                                                \
+		_mm256_storeu_si256((__m256i*)&a[l], v);                                                \
+		_mm256_storeu_si256((__m256i*)&a[r - (lanes)], v);                                      \
+                                                                                                \
+		l += count;                                                                             \
+		r -= (lanes) - count;                                                                   \
+	}                                                                                           \
+                                                                                                \
+	/* Unread tail and the held back registers fill the gap one by one */                       \
+	i##bits rest[3 * (lanes)];                                                                  \
+	size_t rest_len = read_r - read_l;                                                          \
+                                                                                                \
+	memcpy(rest, &a[read_l], rest_len * sizeof(*a));                                            \
+	_mm256_storeu_si256((__m256i*)&rest[rest_len], first);                                      \
+	_mm256_storeu_si256((__m256i*)&rest[rest_len + (lanes)], last);                             \
+                                                                                                \
+	for (size_t i = 0; i < rest_len + 2 * (lanes); ++i)                                         \
+	{                                                                                           \
+		if (rest[i] < pivot || (le && rest[i] == pivot))                                        \
+			a[l++] = rest[i];                                                                   \
+		else                                                                                    \
+			a[--r] = rest[i];                                                                   \
+	}                                                                                           \
+                                                                                                \
+	return l;                                                                                   \
+}
+
+_EE_SORT_AVX2_DEFINE(32, 8, INT32_MAX, _mm256_set1_epi32)
+_EE_SORT_AVX2_DEFINE(64, 4, INT64_MAX, _mm256_set1_epi64x)
+
+#endif // EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX
+
+// Introsort on numbers mapped to signed integers, 'simd' selects the AVX2 kernels. When the pivot is the smallest
+// element nothing goes left of it, its copies are split off instead and are already in place
+#define _EE_SORT_INTRO_DEFINE(bits)                                                             \
+EE_INLINE void _ee_sort_small_i##bits(i##bits* a, size_t n, i32 simd)                           \
+{                                                                                               \
+	_EE_SORT_AVX2_CALL(simd, _ee_sort_small_i##bits##_avx2(a, n); return;)                       \
+	_ee_sort_insert_i##bits(a, n);                                                              \
+}                                                                                               \
+                                                                                                \
+EE_INLINE size_t _ee_sort_split_i##bits(i##bits* a, size_t n, i##bits pivot, i32 le, i32 simd) \
+{                                                                                               \
+	_EE_SORT_AVX2_CALL(simd && n >= EE_ARRAY_SORT_VEC_TH, return _ee_sort_partition_i##bits##_avx2(a, n, pivot, le);) \
+	return _ee_sort_partition_i##bits(a, n, pivot, le);                                         \
+}                                                                                               \
+                                                                                                \
+EE_INLINE void _ee_sort_intro_i##bits(i##bits* a, size_t n, i32 depth, i32 simd)               \
+{                                                                                               \
+	while (n > EE_ARRAY_SORT_NET_TH)                                                            \
+	{                                                                                           \
+		if (depth-- <= 0)                                                                       \
+		{                                                                                       \
+			_ee_sort_heap_i##bits(a, n);                                                        \
+			return;                                                                             \
+		}                                                                                       \
+                                                                                                \
+		i##bits x = a[0], y = a[n >> 1], z = a[n - 1];                                          \
+		i##bits lo = x < y ? x : y;                                                             \
+		i##bits hi = x < y ? y : x;                                                             \
+		i##bits pivot = z < lo ? lo : (z > hi ? hi : z);                                        \
+                                                                                                \
+		size_t left = _ee_sort_split_i##bits(a, n, pivot, 0, simd);                             \
+                                                                                                \
+		if (left == 0)                                                                          \
+		{                                                                                       \
+			left = _ee_sort_split_i##bits(a, n, pivot, 1, simd);                                \
+			a += left;                                                                          \
+			n -= left;                                                                          \
+			continue;                                                                           \
+		}                                                                                       \
+                                                                                                \
+		/* Recursion takes the smaller side, the loop the larger one */                         \
+		if (left < n - left)                                                                    \
+		{                                                                                       \
+			_ee_sort_intro_i##bits(a, left, depth, simd);                                       \
+			a += left;                                                                          \
+			n -= left;                                                                          \
+		}                                                                                       \
+		else                                                                                    \
+		{                                                                                       \
+			_ee_sort_intro_i##bits(&a[left], n - left, depth, simd);                            \
+			n = left;                                                                           \
+		}                                                                                       \
+	}                                                                                           \
+                                                                                                \
+	_ee_sort_small_i##bits(a, n, simd);                                                         \
+}
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX
+#define _EE_SORT_AVX2_CALL(cond, stmt) if (cond) { stmt }
+#else
+#define _EE_SORT_AVX2_CALL(cond, stmt)
+#endif
+
+_EE_SORT_INTRO_DEFINE(32)
+_EE_SORT_INTRO_DEFINE(64)
+
+// Unstable sort of an array of 4 or 8 byte numbers without a comparison callback, same order as radix sort.
+// Partitions of up to EE_ARRAY_SORT_NET_TH elements are finished by a branchless bitonic sorting network and
+// partitions of EE_ARRAY_SORT_VEC_TH and more are split by a vectorized partition when the CPU has AVX2,
+// insertion sort and a scalar partition otherwise. Unsigned and float numbers are mapped in place during the sort
+EE_INLINE void ee_array_sort_num(Array* array, ArrayRadixType type)
+{
+	EE_ASSERT(array != NULL, "Trying to sort a NULL Array");
+	EE_ASSERT(array->elem_size == 4 || array->elem_size == 8, "Numeric sort needs 4 or 8 byte elements, got (%zu)", array->elem_size);
+
+	size_t n = ee_array_len(array);
+
+	if (n < 2)
+	{
+		return;
+	}
+
+	i32 depth = ee_log2_u32((u32)ee_min_u64(n, 0xFFFFFFFFu)) * 2;
+	i32 simd = ee_simd_level() >= EE_SIMD_LEVEL_AVX;
+
+	_ee_sort_num_flip(array->buffer, n, array->elem_size, type);
+
+	if (array->elem_size == sizeof(i32))
+		_ee_sort_intro_i32((i32*)array->buffer, n, depth, simd);
+	else
+		_ee_sort_intro_i64((i64*)array->buffer, n, depth, simd);
+
+	_ee_sort_num_flip(array->buffer, n, array->elem_size, type);
+}
+
 EE_INLINE void ee_array_fill(Array* array, const u8* val, size_t a, size_t b)
 {
 	EE_ASSERT(array != NULL, "Trying to fill a NULL Array");
@@ -0,0 +1,429 @@
+#pragma once
+
+#ifndef EE_ARRAY_EXT_H
+#define EE_ARRAY_EXT_H
+
+#include "stdio.h"
+#include "ee_array.h"
+#include "ee_heap.h"
+
+// Most runs merged at once, more runs are merged in groups of this many into longer runs first
+#ifndef EE_ARRAY_EXT_FAN_IN
+#define EE_ARRAY_EXT_FAN_IN      (64)
+#endif
+
+// Smallest read buffer per merged run, in elements
+#ifndef EE_ARRAY_EXT_MIN_READ
+#define EE_ARRAY_EXT_MIN_READ    (64)
+#endif
+
+#define EE_ARRAY_EXT_PATH_MAX    (512)
+
+// Receives the sorted output in order, 'count' elements at a time
+typedef void (*ArrayExtOutFn)(void* context, const u8* elems, size_t count);
+
+// Sorted run spilled to a temporary file
+typedef struct ArrayExtRun
+{
+	FILE*  file;
+	size_t id;
+	u64    len;
+} ArrayExtRun;
+
+// External merge sort of fixed-size elements:
+//   1. Pushed elements fill a buffer of half the memory budget, a full buffer is merge sorted and spilled as a run
+//   2. Runs are k-way merged through a Heap of run heads, the buffer memory is split between the run readers
+//      and the output. Above the fan-in, neighbouring groups of runs are merged into longer runs first
+// Stable: runs hold consecutive input and equal heads are taken from the older run.
+// Runs go to tmpfile() or, with 'temp_dir', to ee_ext_<id>.run files there that are removed once merged
+typedef struct ArrayExtSort
+{
+	Array       buffer;
+	Array       runs;
+	BinCmp      cmp;
+	const char* temp_dir;
+	size_t      fan_in;
+	size_t      next_id;
+} ArrayExtSort;
+
+typedef struct ArrayExtHead
+{
+	BinCmp    cmp;
+	const u8* elem;
+	size_t    run;
+} ArrayExtHead;
+
+typedef struct ArrayExtReader
+{
+	ArrayExtRun* run;
+	u8*          buffer;
+	size_t       pos;
+	size_t       len;
+	u64          left;
+} ArrayExtReader;
+
+typedef struct ArrayExtFileOut
+{
+	FILE*  file;
+	size_t elem_size;
+} ArrayExtFileOut;
+
+EE_EXTERN_C_START
+
+// 'budget' bytes of memory in total, half of it buffers a run and the other half is the merge sort scratch
+EE_INLINE ArrayExtSort ee_array_ext_new(size_t elem_size, size_t budget, BinCmp cmp, const char* temp_dir, const Allocator* allocator)
+{
+	EE_ASSERT(cmp != NULL, "Trying to set NULL comparator");
+
+	ArrayExtSort out = { 0 };
+	size_t run_len = budget / (2 * elem_size);
+
+	EE_ASSERT(run_len >= 3 * EE_ARRAY_EXT_MIN_READ, "External sort budget (%zu) is too small for (%zu) byte elements", budget, elem_size);
+
+	out.buffer   = ee_array_new(run_len, elem_size, allocator);
+	out.runs     = ee_array_new(EE_ARRAY_EXT_FAN_IN, sizeof(ArrayExtRun), allocator);
+	out.cmp      = cmp;
+	out.temp_dir = temp_dir;
+	out.fan_in   = ee_min_u64(EE_ARRAY_EXT_FAN_IN, run_len / EE_ARRAY_EXT_MIN_READ - 1);
+
+	return out;
+}
+
+EE_INLINE void _ee_array_ext_path(const ArrayExtSort* ext, size_t id, char* path)
+{
+	snprintf(path, EE_ARRAY_EXT_PATH_MAX, "%s/ee_ext_%zu.run", ext->temp_dir, id);
+}
+
+EE_INLINE ArrayExtRun _ee_array_ext_open(ArrayExtSort* ext)
+{
+	ArrayExtRun run = { 0 };
+
+	if (ext->temp_dir == NULL)
+	{
+		run.file = tmpfile();
+
+		EE_ASSERT(run.file != NULL, "Unable to create a temporary file for an external sort run");
+
+		return run;
+	}
+
+	char path[EE_ARRAY_EXT_PATH_MAX];
+
+	// Exclusive create skips names taken by another sort in the same directory
+	for (size_t attempt = 0; attempt < 1024 && run.file == NULL; ++attempt)
+	{
+		run.id = ext->next_id++;
+		_ee_array_ext_path(ext, run.id, path);
+		run.file = fopen(path, "w+bx");
+	}
+
+	EE_ASSERT(run.file != NULL, "Unable to create an external sort run in (%s)", ext->temp_dir);
+
+	return run;
+}
+
+EE_INLINE void _ee_array_ext_close(ArrayExtSort* ext, ArrayExtRun* run)
+{
+	fclose(run->file);
+
+	if (ext->temp_dir != NULL)
+	{
+		char path[EE_ARRAY_EXT_PATH_MAX];
+
+		_ee_array_ext_path(ext, run->id, path);
+		remove(path);
+	}
+
+	run->file = NULL;
+}
+
+EE_INLINE void _ee_array_ext_write_fn(void* context, const u8* elems, size_t count)
+{
+	ArrayExtFileOut* out = (ArrayExtFileOut*)context;
+	size_t wrote = fwrite(elems, out->elem_size, count, out->file);
+
+	EE_ASSERT(wrote == count, "Unable to write (%zu) elements of external sort output", count);
+	EE_UNUSED(wrote);
+}
+
+EE_INLINE int _ee_array_ext_head_cmp(const void* a, const void* b)
+{
+	const ArrayExtHead* x = (const ArrayExtHead*)a;
+	const ArrayExtHead* y = (const ArrayExtHead*)b;
+
+	int res = x->cmp(x->elem, y->elem);
+
+	if (res != 0)
+		return res;
+
+	return (x->run > y->run) - (x->run < y->run);
+}
+
+// Sorts the buffered elements and writes them out as a new run
+EE_INLINE void _ee_array_ext_spill(ArrayExtSort* ext)
+{
+	size_t len = ee_array_len(&ext->buffer);
+
+	if (len == 0)
+	{
+		return;
+	}
+
+	ee_array_merge_sort(&ext->buffer, ext->cmp);
+
+	ArrayExtRun run = _ee_array_ext_open(ext);
+	ArrayExtFileOut out = { run.file, ext->buffer.elem_size };
+
+	_ee_array_ext_write_fn(&out, ext->buffer.buffer, len);
+	run.len = len;
+
+	ee_array_push(&ext->runs, EE_RECAST_U8(run));
+	ee_array_clear(&ext->buffer);
+}
+
+EE_INLINE void _ee_array_ext_refill(ArrayExtReader* reader, size_t cap, size_t elem_size)
+{
+	size_t count = (size_t)ee_min_u64(cap, reader->left);
+	size_t got = fread(reader->buffer, elem_size, count, reader->run->file);
+
+	EE_ASSERT(got == count, "Unable to read (%zu) elements of an external sort run, got (%zu)", count, got);
+
+	reader->pos = 0;
+	reader->len = got;
+	reader->left -= got;
+}
+
+// Merges 'count' runs starting at 'first' into 'out_fn' and closes them, the buffer memory is split into
+// one read buffer per run plus the output buffer
+EE_INLINE void _ee_array_ext_merge(ArrayExtSort* ext, ArrayExtRun* first, size_t count, ArrayExtOutFn out_fn, void* context)
+{
+	size_t elem_size = ext->buffer.elem_size;
+	size_t cap = ext->buffer.cap / elem_size / (count + 1);
+
+	ArrayExtReader readers[EE_ARRAY_EXT_FAN_IN];
+	Heap heap = ee_heap_new(count, sizeof(ArrayExtHead), _ee_array_ext_head_cmp, &ext->buffer.allocator);
+
+	u8* out = &ext->buffer.buffer[count * cap * elem_size];
+	size_t out_len = 0;
+
+	for (size_t r = 0; r < count; ++r)
+	{
+		ArrayExtReader* reader = &readers[r];
+
+		reader->run    = &first[r];
+		reader->buffer = &ext->buffer.buffer[r * cap * elem_size];
+		reader->left   = first[r].len;
+
+		rewind(reader->run->file);
+		_ee_array_ext_refill(reader, cap, elem_size);
+
+		if (reader->len > 0)
+		{
+			ArrayExtHead head = { ext->cmp, reader->buffer, r };
+
+			ee_heap_push(&heap, EE_RECAST_U8(head));
+		}
+	}
+
+	while (!ee_heap_empty(&heap))
+	{
+		ArrayExtHead* head = (ArrayExtHead*)ee_heap_top(&heap);
+		ArrayExtReader* reader = &readers[head->run];
+
+		memcpy(&out[out_len * elem_size], head->elem, elem_size);
+
+		if (++out_len == cap)
+		{
+			out_fn(context, out, out_len);
+			out_len = 0;
+		}
+
+		if (++reader->pos == reader->len)
+		{
+			_ee_array_ext_refill(reader, cap, elem_size);
+
+			if (reader->len == 0)
+			{
+				ee_heap_pop(&heap, NULL);
+				continue;
+			}
+		}
+
+		// The next element of the same run replaces the top, cheaper than a pop and a push
+		head->elem = &reader->buffer[reader->pos * elem_size];
+		ee_heap_down(&heap, 0);
+	}
+
+	if (out_len > 0)
+	{
+		out_fn(context, out, out_len);
+	}
+
+	for (size_t r = 0; r < count; ++r)
+	{
+		_ee_array_ext_close(ext, &first[r]);
+	}
+
+	ee_heap_free(&heap);
+}
+
+EE_INLINE void ee_array_ext_push(ArrayExtSort* ext, const u8* elem)
+{
+	EE_ASSERT(ext != NULL, "Trying to push into NULL external sort");
+
+	if (ee_array_full(&ext->buffer))
+	{
+		_ee_array_ext_spill(ext);
+	}
+
+	ee_array_push(&ext->buffer, elem);
+}
+
+EE_INLINE void ee_array_ext_push_n(ArrayExtSort* ext, const u8* elems, size_t count)
+{
+	EE_ASSERT(ext != NULL, "Trying to push into NULL external sort");
+
+	Array* buffer = &ext->buffer;
+
+	while (count > 0)
+	{
+		if (ee_array_full(buffer))
+		{
+			_ee_array_ext_spill(ext);
+		}
+
+		size_t room = (buffer->cap - buffer->top) / buffer->elem_size;
+		size_t chunk = ee_min_u64(room, count);
+
+		memcpy(&buffer->buffer[buffer->top], elems, chunk * buffer->elem_size);
+
+		buffer->top += chunk * buffer->elem_size;
+		elems += chunk * buffer->elem_size;
+		count -= chunk;
+	}
+}
+
+// Streams every pushed element in order to 'out_fn', the sorter is empty afterwards and can be reused.
+// Without a spilled run the buffer is sorted in memory and handed over in one call
+EE_INLINE void ee_array_ext_finish(ArrayExtSort* ext, ArrayExtOutFn out_fn, void* context)
+{
+	EE_ASSERT(ext != NULL, "Trying to finish NULL external sort");
+	EE_ASSERT(out_fn != NULL, "Trying to finish external sort with NULL output");
+
+	if (ee_array_empty(&ext->runs))
+	{
+		size_t len = ee_array_len(&ext->buffer);
+
+		if (len > 0)
+		{
+			ee_array_merge_sort(&ext->buffer, ext->cmp);
+			out_fn(context, ext->buffer.buffer, len);
+			ee_array_clear(&ext->buffer);
+		}
+
+		return;
+	}
+
+	_ee_array_ext_spill(ext);
+
+	ArrayExtRun* runs = (ArrayExtRun*)ext->runs.buffer;
+
+	while (ee_array_len(&ext->runs) > ext->fan_in)
+	{
+		size_t count = ee_array_len(&ext->runs);
+		size_t merged = 0;
+
+		// Groups keep their order so ties still resolve to the older run
+		for (size_t first = 0; first < count; first += ext->fan_in)
+		{
+			size_t group = ee_min_u64(ext->fan_in, count - first);
+			ArrayExtRun run = _ee_array_ext_open(ext);
+			ArrayExtFileOut out = { run.file, ext->buffer.elem_size };
+
+			for (size_t r = first; r < first + group; ++r)
+			{
+				run.len += runs[r].len;
+			}
+
+			_ee_array_ext_merge(ext, &runs[first], group, _ee_array_ext_write_fn, &out);
+			runs[merged++] = run;
+		}
+
+		ext->runs.top = merged * sizeof(ArrayExtRun);
+	}
+
+	_ee_array_ext_merge(ext, runs, ee_array_len(&ext->runs), out_fn, context);
+	ee_array_clear(&ext->runs);
+}
+
+EE_INLINE void ee_array_ext_finish_file(ArrayExtSort* ext, FILE* file)
+{
+	EE_ASSERT(file != NULL, "Trying to write external sort output to NULL file");
+
+	ArrayExtFileOut out = { file, ext->buffer.elem_size };
+
+	ee_array_ext_finish(ext, _ee_array_ext_write_fn, &out);
+}
+
+EE_INLINE void ee_array_ext_free(ArrayExtSort* ext)
+{
+	EE_ASSERT(ext != NULL, "Trying to free NULL external sort");
+
+	ArrayExtRun* runs = (ArrayExtRun*)ext->runs.buffer;
+
+	for (size_t r = 0; r < ee_array_len(&ext->runs); ++r)
+	{
+		_ee_array_ext_close(ext, &runs[r]);
+	}
+
+	ee_array_free(&ext->buffer);
+	ee_array_free(&ext->runs);
+	memset(ext, 0, sizeof(ArrayExtSort));
+}
+
+// Sorts the file of 'elem_size' byte records at 'in_path' into 'out_path' with 'budget' bytes of memory
+EE_INLINE void ee_array_ext_sort_file(const char* in_path, const char* out_path, size_t elem_size, BinCmp cmp, size_t budget, const char* temp_dir)
+{
+	EE_ASSERT(in_path != NULL && out_path != NULL, "Trying to sort a NULL file path");
+
+	FILE* in = fopen(in_path, "rb");
+
+	EE_ASSERT(in != NULL, "Unable to open file (%s)", in_path);
+
+	ArrayExtSort ext = ee_array_ext_new(elem_size, budget, cmp, temp_dir, NULL);
+	Array* buffer = &ext.buffer;
+
+	// Reads straight into the run buffer
+	while (EE_TRUE)
+	{
+		if (ee_array_full(buffer))
+		{
+			_ee_array_ext_spill(&ext);
+		}
+
+		size_t room = (buffer->cap - buffer->top) / elem_size;
+		size_t got = fread(&buffer->buffer[buffer->top], elem_size, room, in);
+
+		buffer->top += got * elem_size;
+
+		if (got < room)
+			break;
+	}
+
+	EE_ASSERT(!ferror(in), "Unable to read file (%s)", in_path);
+
+	fclose(in);
+
+	FILE* out = fopen(out_path, "wb");
+
+	EE_ASSERT(out != NULL, "Unable to open file (%s)", out_path);
+
+	ee_array_ext_finish_file(&ext, out);
+	fclose(out);
+
+	ee_array_ext_free(&ext);
+}
+
+EE_EXTERN_C_END
+
+#endif // EE_ARRAY_EXT_H
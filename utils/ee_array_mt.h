@@ -0,0 +1,253 @@
+#pragma once
+
+#ifndef EE_ARRAY_MT_H
+#define EE_ARRAY_MT_H
+
+#include "ee_array.h"
+#include "ee_thread.h"
+
+#define EE_ARRAY_MT_THREADS_MAX    (64)
+
+// Elements per thread below which spawning more threads does not pay off
+#ifndef EE_ARRAY_MT_MIN_CHUNK
+#define EE_ARRAY_MT_MIN_CHUNK      (EE_NKB(64))
+#endif
+
+// Parallel merge sort:
+//   1. The array is split into one run per thread, each thread introsorts its run in place
+//   2. Neighbouring runs are merged pairwise into a scratch buffer and back, one round per halving of the run count.
+//      Every round splits the whole output into equal slices, a slice that starts inside a merge finds its
+//      input positions with a binary search (merge path), so every thread stays busy down to the last merge
+// Runs are copied to the scratch buffer after step 1 when the round count is odd, the last round then lands in the array
+typedef struct ArrayMtJob
+{
+	Array* array;
+	BinCmp cmp;
+
+	u8* src;
+	u8* dst;
+	u8* scratch;
+
+	size_t bounds[EE_ARRAY_MT_THREADS_MAX + 1];
+	size_t runs;
+	size_t len;
+	size_t threads;
+	i32    copy_runs;
+} ArrayMtJob;
+
+typedef struct ArrayMtTask
+{
+	ArrayMtJob* job;
+	size_t      id;
+} ArrayMtTask;
+
+EE_EXTERN_C_START
+
+EE_INLINE size_t _ee_array_mt_threads(size_t len, size_t threads)
+{
+	if (threads == 0)
+	{
+		threads = (size_t)ee_get_cpu_count();
+	}
+
+	threads = ee_min_u64(threads, EE_ARRAY_MT_THREADS_MAX);
+
+	return ee_min_u64(threads, ee_max_u64(len / EE_ARRAY_MT_MIN_CHUNK, 1));
+}
+
+EE_INLINE void _ee_array_mt_run(ArrayMtTask* tasks, size_t count, ThreadFn fn)
+{
+	Thread threads[EE_ARRAY_MT_THREADS_MAX];
+
+	for (size_t t = 1; t < count; ++t)
+	{
+		ee_thread_start(&threads[t], fn, &tasks[t]);
+	}
+
+	// The calling thread takes the first share instead of idling in join
+	fn(&tasks[0]);
+
+	for (size_t t = 1; t < count; ++t)
+	{
+		ee_thread_join(&threads[t]);
+	}
+}
+
+EE_INLINE void _ee_array_mt_sort_run(void* context)
+{
+	ArrayMtTask* task = (ArrayMtTask*)context;
+	ArrayMtJob* job = task->job;
+	Array* array = job->array;
+
+	size_t lo = job->bounds[task->id];
+	size_t hi = job->bounds[task->id + 1];
+	size_t elem_size = array->elem_size;
+
+	i32 max_depth = ee_log2_u32((u32)ee_min_u64(hi - lo, 0xFFFFFFFFu)) * 2;
+
+	ee_array_introsort(array, job->cmp, (i64)(lo * elem_size), (i64)((hi - 1) * elem_size), max_depth);
+
+	if (job->copy_runs)
+	{
+		memcpy(&job->scratch[lo * elem_size], &array->buffer[lo * elem_size], (hi - lo) * elem_size);
+	}
+}
+
+// Number of elements of 'a' among the first 'k' outputs of a stable merge of 'a' and 'b', ties take 'a' first
+EE_INLINE size_t _ee_array_mt_corank(const u8* a, size_t a_len, const u8* b, size_t b_len, size_t k, size_t elem_size, BinCmp cmp)
+{
+	size_t lo = k > b_len ? k - b_len : 0;
+	size_t hi = ee_min_u64(k, a_len);
+
+	while (lo < hi)
+	{
+		size_t mid = lo + ((hi - lo) >> 1);
+
+		if (cmp(&a[mid * elem_size], &b[(k - mid - 1) * elem_size]) > 0)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return lo;
+}
+
+EE_INLINE void _ee_array_mt_merge_slice(void* context)
+{
+	ArrayMtTask* task = (ArrayMtTask*)context;
+	ArrayMtJob* job = task->job;
+
+	size_t elem_size = job->array->elem_size;
+	size_t out_lo = job->len * task->id / job->threads;
+	size_t out_hi = job->len * (task->id + 1) / job->threads;
+
+	for (size_t pair = 0; 2 * pair < job->runs; ++pair)
+	{
+		size_t lo  = job->bounds[2 * pair];
+		size_t mid = job->bounds[ee_min_u64(2 * pair + 1, job->runs)];
+		size_t hi  = job->bounds[ee_min_u64(2 * pair + 2, job->runs)];
+
+		if (hi <= out_lo || lo >= out_hi)
+			continue;
+
+		size_t from = ee_max_u64(out_lo, lo) - lo;
+		size_t to   = ee_min_u64(out_hi, hi) - lo;
+
+		const u8* a = &job->src[lo * elem_size];
+		const u8* b = &job->src[mid * elem_size];
+		size_t a_len = mid - lo;
+		size_t b_len = hi - mid;
+
+		size_t i = _ee_array_mt_corank(a, a_len, b, b_len, from, elem_size, job->cmp);
+		size_t j = from - i;
+		size_t i_end = _ee_array_mt_corank(a, a_len, b, b_len, to, elem_size, job->cmp);
+		size_t j_end = to - i_end;
+
+		u8* out = &job->dst[(lo + from) * elem_size];
+
+		while (i < i_end && j < j_end)
+		{
+			if (job->cmp(&b[j * elem_size], &a[i * elem_size]) < 0)
+			{
+				memcpy(out, &b[j * elem_size], elem_size);
+				j++;
+			}
+			else
+			{
+				memcpy(out, &a[i * elem_size], elem_size);
+				i++;
+			}
+
+			out += elem_size;
+		}
+
+		memcpy(out, &a[i * elem_size], (i_end - i) * elem_size);
+		out += (i_end - i) * elem_size;
+
+		memcpy(out, &b[j * elem_size], (j_end - j) * elem_size);
+	}
+}
+
+// Sorts on 'threads' threads, 0 uses every core. Not stable, same as EE_SORT_INTRO which it falls back to
+// below EE_ARRAY_MT_MIN_CHUNK elements per thread. Needs a scratch copy of the array from its allocator
+EE_INLINE void ee_array_sort_parallel(Array* array, BinCmp cmp, size_t threads)
+{
+	EE_ASSERT(array != NULL, "Trying to sort a NULL Array");
+	EE_ASSERT(cmp != NULL, "Trying to sort with a NULL BinCmp");
+
+	size_t len = ee_array_len(array);
+
+	threads = _ee_array_mt_threads(len, threads);
+
+	if (threads == 1)
+	{
+		if (len > 1)
+			ee_array_sort(array, cmp, EE_SORT_INTRO);
+
+		return;
+	}
+
+	ArrayMtJob job = { 0 };
+	ArrayMtTask tasks[EE_ARRAY_MT_THREADS_MAX];
+
+	size_t rounds = 0;
+
+	while (((size_t)1 << rounds) < threads)
+	{
+		rounds++;
+	}
+
+	job.array     = array;
+	job.cmp       = cmp;
+	job.len       = len;
+	job.threads   = threads;
+	job.runs      = threads;
+	job.copy_runs = rounds & 1;
+	job.scratch   = (u8*)array->allocator.alloc_fn(&array->allocator, len * array->elem_size);
+
+	EE_ASSERT(job.scratch != NULL, "Unable to allocate (%zu) bytes for parallel sort", len * array->elem_size);
+
+	for (size_t t = 0; t <= threads; ++t)
+	{
+		job.bounds[t] = len * t / threads;
+	}
+
+	for (size_t t = 0; t < threads; ++t)
+	{
+		tasks[t].job = &job;
+		tasks[t].id  = t;
+	}
+
+	_ee_array_mt_run(tasks, threads, _ee_array_mt_sort_run);
+
+	job.src = job.copy_runs ? job.scratch : array->buffer;
+	job.dst = job.copy_runs ? array->buffer : job.scratch;
+
+	while (job.runs > 1)
+	{
+		_ee_array_mt_run(tasks, threads, _ee_array_mt_merge_slice);
+
+		// Every pair became one run
+		size_t runs = (job.runs + 1) >> 1;
+
+		for (size_t r = 1; r <= runs; ++r)
+		{
+			job.bounds[r] = job.bounds[ee_min_u64(2 * r, job.runs)];
+		}
+
+		job.runs = runs;
+
+		u8* temp = job.src;
+
+		job.src = job.dst;
+		job.dst = temp;
+	}
+
+	EE_ASSERT(job.src == array->buffer, "Parallel sort finished outside of the array");
+
+	array->allocator.free_fn(&array->allocator, job.scratch);
+}
+
+EE_EXTERN_C_END
+
+#endif // EE_ARRAY_MT_H
@@ -0,0 +1,385 @@
+#pragma once
+
+#ifndef EE_CACHE_H
+#define EE_CACHE_H
+
+#include "ee_dict.h"
+
+#define EE_CACHE_NO_TTL    (0)
+
+#define ee_cache_new_m(max_entries, key_type, val_type, ttl)    ee_cache_new(max_entries, sizeof(key_type), sizeof(val_type), ttl, (DictConfig){ 0 })
+
+// Current time in the units TTLs are given in
+typedef u64 (*CacheClock)(void* context);
+
+typedef struct DictCacheStats
+{
+	u64 hits;
+	u64 misses;
+	u64 inserts;
+	u64 evictions;
+	u64 expirations;
+
+	size_t count;
+	size_t max_entries;
+	f64    hit_rate;
+} DictCacheStats;
+
+// Bounded cache on the Dict probing engine, the table is sized once for 'max_entries' and never grows.
+// Every value slot is followed by a u64 holding the expiry time (0 means never) above the CLOCK reference bit,
+// so in-place rehashes carry both along. A metadata byte array beside 'ctrl' would be cheaper per slot, but
+// 'ee_dict_rehash' does not know about it and the expiry needs the 64 bits anyway.
+// The bit is set on access and cleared by the passing hand, an entry is evicted when the hand finds it
+// unreferenced or expired. The table keeps 1/8 of 'max_entries' as room for the tombstones evictions leave,
+// it is rehashed in place once live entries and tombstones together reach the load threshold
+typedef struct DictCache
+{
+	Dict dict;
+
+	size_t max_entries;
+	size_t val_len;
+	size_t hand;
+	size_t tombs;
+
+	u64        ttl;
+	CacheClock clock_fn;
+	void*      clock_context;
+
+	DictCacheStats stats;
+} DictCache;
+
+EE_EXTERN_C_START
+
+// Milliseconds of 'ee_monotonic_ns', the origin is arbitrary so only expiry comparisons are meaningful.
+// Outside Windows it is clock_gettime(CLOCK_MONOTONIC): strict C99 builds need _POSIX_C_SOURCE >= 199309L
+// before the first <time.h>, 'ee_core.h' defines it when it is included first
+EE_INLINE u64 ee_cache_clock_ms(void* context)
+{
+	EE_UNUSED(context);
+
+	return ee_monotonic_ns() / 1000000ull;
+}
+
+// 'ttl' is the default time to live in clock units (milliseconds unless 'ee_cache_set_clock' is used),
+// EE_CACHE_NO_TTL keeps entries until they are evicted
+EE_INLINE DictCache ee_cache_new(size_t max_entries, size_t key_len, size_t val_len, u64 ttl, DictConfig config)
+{
+	EE_ASSERT(max_entries > 0, "Invalid max_entries (%zu)", max_entries);
+
+	DictCache out = { 0 };
+
+	config.val_cpy_fn = NULL;
+	config.grow       = EE_DICT_GROW_FULL;
+
+	out.dict = ee_dict_new(_ee_dict_bulk_size(max_entries + (max_entries >> 3)), key_len, val_len + sizeof(u64), config);
+
+	out.max_entries   = max_entries;
+	out.val_len       = val_len;
+	out.hand          = 0;
+	out.tombs         = 0;
+	out.ttl           = ttl;
+	out.clock_fn      = ee_cache_clock_ms;
+	out.clock_context = NULL;
+
+	return out;
+}
+
+EE_INLINE void ee_cache_free(DictCache* cache)
+{
+	EE_ASSERT(cache != NULL, "Trying to free NULL DictCache");
+
+	ee_dict_free(&cache->dict);
+
+	memset(cache, 0, sizeof(*cache));
+}
+
+EE_INLINE void ee_cache_set_clock(DictCache* cache, CacheClock clock_fn, void* context)
+{
+	EE_ASSERT(cache != NULL, "Trying to dereference NULL DictCache");
+	EE_ASSERT(clock_fn != NULL, "Trying to set NULL cache clock");
+
+	cache->clock_fn      = clock_fn;
+	cache->clock_context = context;
+}
+
+EE_INLINE size_t ee_cache_count(const DictCache* cache)
+{
+	EE_ASSERT(cache != NULL, "Trying to dereference NULL DictCache");
+
+	return cache->dict.count;
+}
+
+// (expiry << 1) | reference bit
+EE_INLINE u64 _ee_cache_meta(const DictCache* cache, size_t slot)
+{
+	u64 out;
+	memcpy(&out, ee_dict_val_at(&cache->dict, slot) + cache->val_len, sizeof(out));
+
+	return out;
+}
+
+EE_INLINE void _ee_cache_set_meta(DictCache* cache, size_t slot, u64 meta)
+{
+	memcpy(ee_dict_val_at(&cache->dict, slot) + cache->val_len, &meta, sizeof(meta));
+}
+
+EE_INLINE i32 _ee_cache_expired(u64 meta, u64 now)
+{
+	u64 expiry = meta >> 1;
+
+	return expiry != 0 && expiry <= now;
+}
+
+EE_INLINE void _ee_cache_erase(DictCache* cache, size_t slot)
+{
+	Dict* dict = &cache->dict;
+
+	dict->ctrl.buffer[slot] = EE_SLOT_DELETED;
+	dict->count--;
+
+	cache->tombs++;
+}
+
+// Tombstones are purged here rather than by EE_DICT_TOMBS_REHASH, which would move slots under the reference bytes.
+// Both live entries and tombstones use up the EMPTY slots that end a miss, so they are bounded together
+EE_INLINE void _ee_cache_purge(DictCache* cache)
+{
+	Dict* dict = &cache->dict;
+
+	if (cache->tombs == 0 || dict->count + cache->tombs < dict->th)
+	{
+		return;
+	}
+
+	ee_dict_rehash(dict);
+
+	cache->tombs = 0;
+}
+
+EE_INLINE size_t _ee_cache_find(const DictCache* cache, const u8* key, u64 hash)
+{
+	const Dict* dict = &cache->dict;
+	u8* val = ee_dict_at_hash(dict, key, hash);
+
+	if (val == NULL)
+	{
+		return (size_t)-1;
+	}
+
+	return (size_t)(val - dict->vals.buffer) / dict->val_stride;
+}
+
+// Advances the CLOCK hand until one entry is gone, expired entries go regardless of their reference byte
+EE_INLINE void _ee_cache_evict(DictCache* cache, u64 now)
+{
+	Dict* dict = &cache->dict;
+
+	EE_ASSERT(dict->count > 0, "Trying to evict from an empty DictCache");
+
+	while (EE_TRUE)
+	{
+		size_t slot = cache->hand;
+
+		cache->hand = (cache->hand + 1) & dict->mask;
+
+		if (dict->ctrl.buffer[slot] & 0x80)
+			continue;
+
+		u64 meta = _ee_cache_meta(cache, slot);
+
+		if (_ee_cache_expired(meta, now))
+		{
+			cache->stats.expirations++;
+			_ee_cache_erase(cache, slot);
+
+			return;
+		}
+
+		if (meta & 1)
+		{
+			_ee_cache_set_meta(cache, slot, meta & ~1ull);
+			continue;
+		}
+
+		cache->stats.evictions++;
+		_ee_cache_erase(cache, slot);
+
+		return;
+	}
+}
+
+// Returns the value of a live entry and marks it referenced, expired entries are removed and count as misses.
+// The pointer stays valid until the next modification
+EE_INLINE u8* ee_cache_at(DictCache* cache, const u8* key)
+{
+	EE_ASSERT(cache != NULL, "Trying to dereference NULL DictCache");
+	EE_ASSERT(key != NULL, "Trying to dereference NULL key");
+
+	Dict* dict = &cache->dict;
+	size_t slot = _ee_cache_find(cache, key, dict->hash_fn(key, dict->key_len));
+
+	if (slot == (size_t)-1)
+	{
+		cache->stats.misses++;
+		return NULL;
+	}
+
+	u64 meta = _ee_cache_meta(cache, slot);
+
+	if ((meta >> 1) != 0 && _ee_cache_expired(meta, cache->clock_fn(cache->clock_context)))
+	{
+		cache->stats.expirations++;
+		cache->stats.misses++;
+
+		_ee_cache_erase(cache, slot);
+
+		return NULL;
+	}
+
+	cache->stats.hits++;
+
+	if (!(meta & 1))
+	{
+		_ee_cache_set_meta(cache, slot, meta | 1);
+	}
+
+	return ee_dict_val_at(dict, slot);
+}
+
+EE_INLINE i32 ee_cache_contains(DictCache* cache, const u8* key)
+{
+	return ee_cache_at(cache, key) != NULL;
+}
+
+// Inserts or overwrites, 'ttl' replaces the default for this entry (EE_CACHE_NO_TTL for none).
+// A full cache evicts one entry first, the table itself never grows
+EE_INLINE void ee_cache_set_ttl(DictCache* cache, const u8* key, const u8* val, u64 ttl)
+{
+	EE_ASSERT(cache != NULL, "Trying to insert to NULL DictCache");
+	EE_ASSERT(key != NULL, "Trying to insert NULL key");
+	EE_ASSERT(val != NULL || cache->val_len == 0, "Trying to insert NULL value");
+
+	Dict* dict = &cache->dict;
+
+	u64 hash = dict->hash_fn(key, dict->key_len);
+	u64 expiry = 0;
+
+	// The clock is only read when something depends on it
+	if (ttl != EE_CACHE_NO_TTL)
+	{
+		expiry = cache->clock_fn(cache->clock_context) + ttl;
+	}
+
+	size_t slot = _ee_cache_find(cache, key, hash);
+
+	if (slot == (size_t)-1)
+	{
+		if (dict->count >= cache->max_entries)
+		{
+			_ee_cache_evict(cache, cache->clock_fn(cache->clock_context));
+		}
+
+		// Only an insert takes an EMPTY slot, so this is the one place the bound is checked
+		_ee_cache_purge(cache);
+
+		slot = _ee_dict_first_free(dict, hash);
+
+		EE_ASSERT(slot != (size_t)-1, "DictCache has no free slot");
+
+		if (dict->ctrl.buffer[slot] == EE_SLOT_DELETED)
+			cache->tombs--;
+
+		dict->key_cpy_fn(ee_dict_key_at(dict, slot), key, dict->key_len);
+		dict->ctrl.buffer[slot] = hash & 0x7F;
+		dict->count++;
+
+		cache->stats.inserts++;
+	}
+
+	if (cache->val_len > 0)
+		memcpy(ee_dict_val_at(dict, slot), val, cache->val_len);
+
+	_ee_cache_set_meta(cache, slot, (expiry << 1) | 1);
+}
+
+EE_INLINE void ee_cache_set(DictCache* cache, const u8* key, const u8* val)
+{
+	EE_ASSERT(cache != NULL, "Trying to insert to NULL DictCache");
+
+	ee_cache_set_ttl(cache, key, val, cache->ttl);
+}
+
+EE_INLINE i32 ee_cache_remove(DictCache* cache, const u8* key)
+{
+	EE_ASSERT(cache != NULL, "Trying to remove from NULL DictCache");
+	EE_ASSERT(key != NULL, "Trying to remove NULL key");
+
+	Dict* dict = &cache->dict;
+	size_t slot = _ee_cache_find(cache, key, dict->hash_fn(key, dict->key_len));
+
+	if (slot == (size_t)-1)
+	{
+		return EE_FALSE;
+	}
+
+	_ee_cache_erase(cache, slot);
+
+	return EE_TRUE;
+}
+
+// Removes every expired entry, group at a time, returns how many were removed
+EE_INLINE size_t ee_cache_expire(DictCache* cache)
+{
+	EE_ASSERT(cache != NULL, "Trying to expire NULL DictCache");
+
+	Dict* dict = &cache->dict;
+	u64 now = cache->clock_fn(cache->clock_context);
+	size_t removed = 0;
+
+	for (size_t group = 0; group < dict->cap; group += EE_GROUP_SIZE)
+	{
+		eed_mask mask = _ee_dict_group_used(dict, group);
+
+		while (mask)
+		{
+			size_t slot = group + (size_t)eed_mask_first(mask);
+
+			mask &= mask - 1;
+
+			if (!_ee_cache_expired(_ee_cache_meta(cache, slot), now))
+				continue;
+
+			_ee_cache_erase(cache, slot);
+			removed++;
+		}
+	}
+
+	cache->stats.expirations += removed;
+
+	return removed;
+}
+
+EE_INLINE DictCacheStats ee_cache_stats(const DictCache* cache)
+{
+	EE_ASSERT(cache != NULL, "Trying to dereference NULL DictCache");
+
+	DictCacheStats out = cache->stats;
+	u64 lookups = out.hits + out.misses;
+
+	out.count       = cache->dict.count;
+	out.max_entries = cache->max_entries;
+	out.hit_rate    = lookups > 0 ? (f64)out.hits / (f64)lookups : 0.0;
+
+	return out;
+}
+
+EE_INLINE void ee_cache_stats_reset(DictCache* cache)
+{
+	EE_ASSERT(cache != NULL, "Trying to dereference NULL DictCache");
+
+	memset(&cache->stats, 0, sizeof(cache->stats));
+}
+
+EE_EXTERN_C_END
+
+#endif // EE_CACHE_H
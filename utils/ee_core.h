@@ -1,6 +1,12 @@
 #ifndef EE_CORE_H
 #define EE_CORE_H
 
+// clock_gettime and CLOCK_MONOTONIC are POSIX, strict ISO modes (-std=c99) hide them unless this is defined
+// before the first system header. The GNU modes expose them already and are left alone
+#if !defined(_WIN32) && defined(__STRICT_ANSI__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
 #include "stdlib.h"
 #include "string.h"
 #include "stdint.h"
@@ -9,6 +15,12 @@
 #include "intrin.h"
 #endif
 
+#ifdef _WIN32
+#include "windows.h"
+#else
+#include <time.h>
+#endif
+
 
 //
 // Basic
@@ -202,6 +214,91 @@ _Static_assert(sizeof(double) == 8, "f64: sizeof(double) != 8");
 
 #endif // EE_TYPES
 
+//
+// CPU features
+//
+
+#ifndef EE_CPU_FEATURES
+#define EE_CPU_FEATURES
+
+#define EE_CPU_SSE2        (1u << 0)
+#define EE_CPU_AVX2        (1u << 1)
+#define EE_CPU_AVX512BW    (1u << 2)
+#define EE_CPU_AVX512DQ    (1u << 3)
+#define EE_CPU_DETECTED    (1u << 31)
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define EE_CPU_X86
+#endif
+
+#if defined(EE_CPU_X86) && (defined(__GNUC__) || defined(__clang__))
+#include "cpuid.h"
+#define EE_TARGET(x)    __attribute__((target(x)))
+#else
+#define EE_TARGET(x)
+#endif
+
+EE_INLINE u32 ee_cpu_detect(void)
+{
+    u32 out = EE_CPU_DETECTED;
+
+#if defined(EE_CPU_X86)
+    u32 regs[4] = { 0 };
+    u64 xcr0 = 0;
+
+#if defined(_MSC_VER)
+    __cpuidex((int*)regs, 1, 0);
+#else
+    __cpuid_count(1, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+
+    if (regs[3] & (1u << 26))
+        out |= EE_CPU_SSE2;
+
+    // OSXSAVE, the OS has to save the wide registers before AVX state can be trusted
+    if (regs[2] & (1u << 27))
+    {
+#if defined(_MSC_VER)
+        xcr0 = _xgetbv(0);
+#else
+        u32 lo, hi;
+        __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        xcr0 = ((u64)hi << 32) | lo;
+#endif
+    }
+
+#if defined(_MSC_VER)
+    __cpuidex((int*)regs, 7, 0);
+#else
+    __cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+
+    if ((xcr0 & 0x06) == 0x06 && (regs[1] & (1u << 5)))
+        out |= EE_CPU_AVX2;
+
+    if ((xcr0 & 0xE6) == 0xE6 && (regs[1] & (1u << 16)) && (regs[1] & (1u << 30)))
+        out |= EE_CPU_AVX512BW;
+
+    if ((xcr0 & 0xE6) == 0xE6 && (regs[1] & (1u << 16)) && (regs[1] & (1u << 17)))
+        out |= EE_CPU_AVX512DQ;
+#endif
+
+    return out;
+}
+
+// Detected once per translation unit, the race on first use is benign (same value is stored)
+EE_INLINE u32 ee_cpu_features(void)
+{
+    static u32 features = 0;
+
+    if (features == 0)
+        features = ee_cpu_detect();
+
+    return features;
+}
+
+#endif // EE_CPU_FEATURES
+
 //
 // SIMD
 //
@@ -218,6 +315,10 @@ _Static_assert(sizeof(double) == 8, "f64: sizeof(double) != 8");
 #define EE_SIMD_LEVEL_AVX    (2)
 #endif
 
+#ifndef EE_SIMD_LEVEL_AVX512
+#define EE_SIMD_LEVEL_AVX512    (3)
+#endif
+
 #ifndef EE_SIMD_MAX_LEVEL
 #define EE_SIMD_MAX_LEVEL     (EE_SIMD_LEVEL_AVX)
 #endif
@@ -230,16 +331,89 @@ _Static_assert(sizeof(double) == 8, "f64: sizeof(double) != 8");
 #define EE_SIMD_EFFECTIVE_MAX_LEVEL    (EE_SIMD_MAX_LEVEL)
 #endif
 
+// Highest level the runtime dispatched kernels may bind, independent of EE_SIMD_MAX_LEVEL
+// so an SSE build still runs the AVX2 and AVX-512 kernels on machines that have them
+#ifndef EE_SIMD_DISPATCH_MAX_LEVEL
+#if defined(EE_CPU_X86) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define EE_SIMD_DISPATCH_MAX_LEVEL    (EE_SIMD_LEVEL_AVX512)
+#else
+#define EE_SIMD_DISPATCH_MAX_LEVEL    (EE_SIMD_LEVEL_NONE)
+#endif
+#endif
+
 #ifndef EE_SIMD_DICT_MAX_LEVEL
-#if EE_SIMD_DICT_DES_LEVEL > EE_SIMD_MAX_LEVEL
-#define EE_SIMD_DICT_MAX_LEVEL    (EE_SIMD_MAX_LEVEL)
+#if EE_SIMD_DICT_DES_LEVEL > EE_SIMD_MAX_LEVEL && EE_SIMD_DICT_DES_LEVEL > EE_SIMD_DISPATCH_MAX_LEVEL
+#define EE_SIMD_DICT_MAX_LEVEL    (EE_SIMD_MAX_LEVEL > EE_SIMD_DISPATCH_MAX_LEVEL ? EE_SIMD_MAX_LEVEL : EE_SIMD_DISPATCH_MAX_LEVEL)
 #else
+// Every group width has a portable fallback and picks its kernel at runtime, the level only fixes the table layout
 #define EE_SIMD_DICT_MAX_LEVEL    (EE_SIMD_DICT_DES_LEVEL)
 #endif
 #endif
 
+#if EE_SIMD_DISPATCH_MAX_LEVEL > EE_SIMD_LEVEL_NONE
+#include "immintrin.h"
+#endif
+
 EE_EXTERN_C_START
 
+//
+// SIMD dispatch level
+//
+
+EE_INLINE i32 ee_simd_detect_level(void)
+{
+    u32 features = ee_cpu_features();
+    i32 out = EE_SIMD_LEVEL_NONE;
+
+    if (features & EE_CPU_SSE2)
+    {
+        out = EE_SIMD_LEVEL_SSE;
+
+        if (features & EE_CPU_AVX2)
+        {
+            out = EE_SIMD_LEVEL_AVX;
+
+            if (features & EE_CPU_AVX512BW)
+                out = EE_SIMD_LEVEL_AVX512;
+        }
+    }
+
+    return out < EE_SIMD_DISPATCH_MAX_LEVEL ? out : EE_SIMD_DISPATCH_MAX_LEVEL;
+}
+
+EE_INLINE i32* _ee_simd_level_slot(void)
+{
+    static i32 level = -1;
+
+    return &level;
+}
+
+// Level the dispatched kernels run at, detected once per translation unit on first use
+EE_INLINE i32 ee_simd_level(void)
+{
+    i32* level = _ee_simd_level_slot();
+
+    if (*level < 0)
+        *level = ee_simd_detect_level();
+
+    return *level;
+}
+
+// Caps the dispatched level (clamped to what the CPU supports) and returns the level in effect
+// Meant for tests and benchmarks, call it before other threads use the kernels
+// Dicts bind their key comparison on creation, so create them after forcing the level
+EE_INLINE i32 ee_simd_force_level(i32 level)
+{
+    i32 detected = ee_simd_detect_level();
+
+    if (level < EE_SIMD_LEVEL_NONE)
+        level = EE_SIMD_LEVEL_NONE;
+
+    *_ee_simd_level_slot() = level < detected ? level : detected;
+
+    return ee_simd_level();
+}
+
 #ifndef EE_SIMD
 #define EE_SIMD
 
@@ -262,6 +436,7 @@ typedef __m256d  ee_simd_d; // double
 #define ee_loadu_si           _mm256_loadu_si256
 #define ee_load_si            _mm256_load_si256
 #define ee_store_si           _mm256_store_si256
+#define ee_storeu_si          _mm256_storeu_si256
 
 #define ee_set1_epi8          _mm256_set1_epi8
 #define ee_set1_epi16         _mm256_set1_epi16
@@ -326,6 +501,7 @@ typedef __m128d  ee_simd_d; // double
 #define ee_loadu_si           _mm_loadu_si128
 #define ee_load_si            _mm_load_si128
 #define ee_store_si           _mm_store_si128
+#define ee_storeu_si          _mm_storeu_si128
 
 #define ee_set1_epi8          _mm_set1_epi8
 #define ee_set1_epi16         _mm_set1_epi16
@@ -767,121 +943,222 @@ EE_INLINE ee_simd_i _ee_sll_epi32(ee_simd_i a, ee_simd_i count)
 #ifndef EE_SIMD_DICT
 #define EE_SIMD_DICT
 
-#if EE_SIMD_DICT_MAX_LEVEL == EE_SIMD_LEVEL_AVX
+// The group width fixes the probe sequence and so the table layout, the kernel matching a group is picked per call
+// from the dispatched level, every width falls back to SWAR over one u64 per 8 ctrl bytes
+// Byte i of the group maps to bit i of the mask
 
-#include "immintrin.h"
+#if EE_SIMD_DICT_MAX_LEVEL == EE_SIMD_LEVEL_AVX512
+
+typedef u64 eed_mask;
 
-typedef __m256i eed_simd_i;
+#define EED_SIMD_BYTES         (64)
+#define EED_GROUP_FULL_MASK    (0xFFFFFFFFFFFFFFFFull)
+#define eed_mask_first         ee_first_bit_u64
+
+#elif EE_SIMD_DICT_MAX_LEVEL == EE_SIMD_LEVEL_AVX
+
+typedef u32 eed_mask;
 
 #define EED_SIMD_BYTES         (32)
-#define EED_SIMD_PREFETCH_T0   (_MM_HINT_T0)
+#define EED_GROUP_FULL_MASK    (0xFFFFFFFFu)
+#define eed_mask_first         ee_first_bit_u32
 
-#define eed_loadu_si           _mm256_loadu_si256
-#define eed_load_si            _mm256_load_si256
+#elif EE_SIMD_DICT_MAX_LEVEL == EE_SIMD_LEVEL_SSE
 
-#define eed_set1_epi8          _mm256_set1_epi8
-#define eed_set1_epi16         _mm256_set1_epi16
-#define eed_set1_epi32         _mm256_set1_epi32
-#define eed_set1_epi64         _mm256_set1_epi64x
+typedef u32 eed_mask;
 
-#define eed_cmpeq_epi8         _mm256_cmpeq_epi8
-#define eed_cmpeq_epi16        _mm256_cmpeq_epi16
-#define eed_cmpeq_epi32        _mm256_cmpeq_epi32
-#define eed_cmpeq_epi64        _mm256_cmpeq_epi64
+#define EED_SIMD_BYTES         (16)
+#define EED_GROUP_FULL_MASK    (0xFFFFu)
+#define eed_mask_first         ee_first_bit_u32
 
-#define eed_castsi_ps          _mm256_castsi256_ps
-#define eed_castsi_pd          _mm256_castsi256_pd
-#define eed_movemask_ps        _mm256_movemask_ps
-#define eed_movemask_pd        _mm256_movemask_pd
-#define eed_movemask_epi8      _mm256_movemask_epi8
-#define eed_packs_epi16        _mm256_packs_epi16
-#define eed_setzero_si         _mm256_setzero_si256
+#elif EE_SIMD_DICT_MAX_LEVEL == EE_SIMD_LEVEL_NONE
 
-#define eed_or_si              _mm256_or_si256
-#define eed_and_si             _mm256_and_si256
-#define eed_srl_epi16          _mm256_srl_epi16
-#define eed_prefetch           _mm_prefetch
+typedef u32 eed_mask;
 
-#define eed_min_epi32          _mm256_min_epi32
-#define eed_max_epi32          _mm256_max_epi32
+#define EED_SIMD_BYTES         (8)
+#define EED_GROUP_FULL_MASK    (0xFFu)
+#define eed_mask_first         ee_first_bit_u32
 
-#elif EE_SIMD_DICT_MAX_LEVEL == EE_SIMD_LEVEL_SSE
+#else
+#error Invalid EE_SIMD_DICT_MAX_LEVEL value
+#endif
 
-#include "immintrin.h"
+#if EE_SIMD_DISPATCH_MAX_LEVEL > EE_SIMD_LEVEL_NONE || EE_SIMD_EFFECTIVE_MAX_LEVEL > EE_SIMD_LEVEL_NONE
+#define EED_SIMD_PREFETCH_T0       (_MM_HINT_T0)
+#define eed_prefetch               _mm_prefetch
+#elif defined(__GNUC__) || defined(__clang__)
+#define EED_SIMD_PREFETCH_T0       (3)
+#define eed_prefetch(ptr, hint)    (__builtin_prefetch((ptr), 0, (hint)))
+#else
+#define EED_SIMD_PREFETCH_T0       (0)
+#define eed_prefetch(ptr, hint)    ((void)(ptr), (void)(hint))
+#endif
 
-typedef __m128i eed_simd_i;
+#define EED_SWAR_LOW           (0x7F7F7F7F7F7F7F7Full)
+#define EED_SWAR_HIGH          (0x8080808080808080ull)
+#define EED_SWAR_ONES          (0x0101010101010101ull)
 
-#define EED_SIMD_BYTES         (16)
-#define EED_SIMD_PREFETCH_T0   (_MM_HINT_T0)
+EE_INLINE u64 _eed_swar_load(const u8* ctrl)
+{
+    u64 out;
+    memcpy(&out, ctrl, sizeof(out));
 
-#define eed_loadu_si           _mm_loadu_si128
-#define eed_load_si            _mm_load_si128
+    return out;
+}
 
-#define eed_set1_epi8          _mm_set1_epi8
-#define eed_set1_epi16         _mm_set1_epi16
-#define eed_set1_epi32         _mm_set1_epi32
-#define eed_set1_epi64         _mm_set1_epi64x
+// Gathers the high bit of every byte into the low 8 bits, byte i lands on bit i
+EE_INLINE eed_mask _eed_swar_pack(u64 high_bits)
+{
+    return (eed_mask)((((high_bits & EED_SWAR_HIGH) >> 7) * 0x0102040810204080ull) >> 56);
+}
 
-#define eed_cmpeq_epi8         _mm_cmpeq_epi8
-#define eed_cmpeq_epi16        _mm_cmpeq_epi16
-#define eed_cmpeq_epi32        _mm_cmpeq_epi32
-#define eed_cmpeq_epi64        _mm_cmpeq_epi64
+EE_INLINE eed_mask _eed_group_match_swar(const u8* ctrl, u8 tag)
+{
+    u64 wide = EED_SWAR_ONES * tag;
+    eed_mask out = 0;
 
-#define eed_castsi_ps          _mm_castsi128_ps
-#define eed_castsi_pd          _mm_castsi128_pd
-#define eed_movemask_ps        _mm_movemask_ps
-#define eed_movemask_pd        _mm_movemask_pd
-#define eed_movemask_epi8      _mm_movemask_epi8
-#define eed_packs_epi16        _mm_packs_epi16
-#define eed_setzero_si         _mm_setzero_si128
+    for (i32 i = 0; i < EED_SIMD_BYTES / 8; ++i)
+    {
+        u64 x = _eed_swar_load(&ctrl[i * 8]) ^ wide;
 
-#define eed_or_si              _mm_or_si128
-#define eed_and_si             _mm_and_si128
-#define eed_srl_epi16          _mm_srl_epi16
-#define eed_prefetch           _mm_prefetch
+        // Exact zero byte test, no false positives from borrows across bytes
+        u64 zero = ~(((x & EED_SWAR_LOW) + EED_SWAR_LOW) | x | EED_SWAR_LOW);
 
-#define eed_min_epi32          _mm_min_epi32
-#define eed_max_epi32          _mm_max_epi32
+        out |= _eed_swar_pack(zero) << (i * 8);
+    }
 
-#elif EE_SIMD_DICT_MAX_LEVEL == EE_SIMD_LEVEL_NONE
+    return out;
+}
 
-typedef ee_simd_i eed_simd_i;
+EE_INLINE eed_mask _eed_group_free_swar(const u8* ctrl)
+{
+    eed_mask out = 0;
 
-#define EED_SIMD_BYTES         (8)
-#define EED_SIMD_PREFETCH_T0   (0)
-
-#define eed_loadu_si           _ee_load_si
-#define eed_load_si            _ee_load_si
-
-#define eed_set1_epi8          _ee_set1_epi8
-#define eed_set1_epi16         _ee_set1_epi16
-#define eed_set1_epi32         _ee_set1_epi32
-#define eed_set1_epi64         _ee_set1_epi64
-
-#define eed_cmpeq_epi8         _ee_cmpeq_epi8
-#define eed_cmpeq_epi16        _ee_cmpeq_epi16
-#define eed_cmpeq_epi32        _ee_cmpeq_epi32
-#define eed_cmpeq_epi64        _ee_cmpeq_epi64
-
-#define eed_castsi_ps          _ee_castst_ps
-#define eed_castsi_pd          _ee_castst_pd
-#define eed_movemask_epi8      _ee_movemask_epi8
-#define eed_movemask_ps        _ee_movemask_ps
-#define eed_movemask_pd        _ee_movemask_pd
-#define eed_packs_epi16        _ee_packs_epi16
-#define eed_setzero_si         _ee_setzero_si
-
-#define eed_or_si              _ee_or_si
-#define eed_and_si             _ee_and_si
-#define eed_srl_epi16          _ee_srl_epi16
-#define eed_prefetch           _ee_prefetch
-#define eed_min_epi32          _ee_min_epi32
-#define eed_max_epi32          _ee_max_epi32
+    for (i32 i = 0; i < EED_SIMD_BYTES / 8; ++i)
+    {
+        out |= _eed_swar_pack(_eed_swar_load(&ctrl[i * 8])) << (i * 8);
+    }
 
-#else
-#error Invalid EE_SIMD_DICT_MAX_LEVEL value
+    return out;
+}
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_SSE && EED_SIMD_BYTES >= 16
+
+EE_TARGET("sse2") EE_INLINE eed_mask _eed_group_match_sse2(const u8* ctrl, u8 tag)
+{
+    __m128i wide = _mm_set1_epi8((char)tag);
+    eed_mask out = 0;
+
+    for (i32 i = 0; i < EED_SIMD_BYTES / 16; ++i)
+    {
+        __m128i group = _mm_load_si128((const __m128i*)&ctrl[i * 16]);
+        out |= (eed_mask)(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(group, wide)) << (i * 16);
+    }
+
+    return out;
+}
+
+EE_TARGET("sse2") EE_INLINE eed_mask _eed_group_free_sse2(const u8* ctrl)
+{
+    eed_mask out = 0;
+
+    for (i32 i = 0; i < EED_SIMD_BYTES / 16; ++i)
+    {
+        __m128i group = _mm_load_si128((const __m128i*)&ctrl[i * 16]);
+        out |= (eed_mask)(u32)_mm_movemask_epi8(group) << (i * 16);
+    }
+
+    return out;
+}
+
+#endif
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX && EED_SIMD_BYTES >= 32
+
+EE_TARGET("avx2") EE_INLINE eed_mask _eed_group_match_avx2(const u8* ctrl, u8 tag)
+{
+    __m256i wide = _mm256_set1_epi8((char)tag);
+    eed_mask out = 0;
+
+    for (i32 i = 0; i < EED_SIMD_BYTES / 32; ++i)
+    {
+        __m256i group = _mm256_load_si256((const __m256i*)&ctrl[i * 32]);
+        out |= (eed_mask)(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(group, wide)) << (i * 32);
+    }
+
+    return out;
+}
+
+EE_TARGET("avx2") EE_INLINE eed_mask _eed_group_free_avx2(const u8* ctrl)
+{
+    eed_mask out = 0;
+
+    for (i32 i = 0; i < EED_SIMD_BYTES / 32; ++i)
+    {
+        __m256i group = _mm256_load_si256((const __m256i*)&ctrl[i * 32]);
+        out |= (eed_mask)(u32)_mm256_movemask_epi8(group) << (i * 32);
+    }
+
+    return out;
+}
+
+#endif
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX512 && EED_SIMD_BYTES == 64
+
+EE_TARGET("avx512f,avx512bw") EE_INLINE eed_mask _eed_group_match_avx512(const u8* ctrl, u8 tag)
+{
+    return _mm512_cmpeq_epi8_mask(_mm512_load_si512((const void*)ctrl), _mm512_set1_epi8((char)tag));
+}
+
+EE_TARGET("avx512f,avx512bw") EE_INLINE eed_mask _eed_group_free_avx512(const u8* ctrl)
+{
+    return _mm512_movepi8_mask(_mm512_load_si512((const void*)ctrl));
+}
+
+#endif
+
+// A predictable branch on the cached level rather than a function pointer, so the probe loops keep the kernel inlined
+EE_INLINE eed_mask eed_group_match(const u8* ctrl, u8 tag)
+{
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_SSE && EED_SIMD_BYTES >= 16
+    i32 level = ee_simd_level();
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX512 && EED_SIMD_BYTES == 64
+    if (level >= EE_SIMD_LEVEL_AVX512)
+        return _eed_group_match_avx512(ctrl, tag);
+#endif
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX && EED_SIMD_BYTES >= 32
+    if (level >= EE_SIMD_LEVEL_AVX)
+        return _eed_group_match_avx2(ctrl, tag);
+#endif
+    if (level >= EE_SIMD_LEVEL_SSE)
+        return _eed_group_match_sse2(ctrl, tag);
+#endif
+
+    return _eed_group_match_swar(ctrl, tag);
+}
+
+EE_INLINE eed_mask eed_group_free(const u8* ctrl)
+{
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_SSE && EED_SIMD_BYTES >= 16
+    i32 level = ee_simd_level();
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX512 && EED_SIMD_BYTES == 64
+    if (level >= EE_SIMD_LEVEL_AVX512)
+        return _eed_group_free_avx512(ctrl);
+#endif
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX && EED_SIMD_BYTES >= 32
+    if (level >= EE_SIMD_LEVEL_AVX)
+        return _eed_group_free_avx2(ctrl);
+#endif
+    if (level >= EE_SIMD_LEVEL_SSE)
+        return _eed_group_free_sse2(ctrl);
 #endif
 
+    return _eed_group_free_swar(ctrl);
+}
+
 #endif // EE_SIMD_DICT
 
 //
@@ -955,6 +1232,59 @@ EE_INLINE void ee_default_free(Allocator* allocator, void* buffer)
 typedef int (*BinCmp)(const void* a, const void* b);
 #endif // EE_BIN_CMP
 
+//
+// Atomics
+//
+
+#ifndef EE_CACHE_LINE
+#define EE_CACHE_LINE    (64)
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+
+#define ee_atomic_load_u32(ptr)            (__atomic_load_n((ptr), __ATOMIC_ACQUIRE))
+#define ee_atomic_load_relaxed_u32(ptr)    (__atomic_load_n((ptr), __ATOMIC_RELAXED))
+#define ee_atomic_store_u32(ptr, val)      (__atomic_store_n((ptr), (val), __ATOMIC_RELEASE))
+#define ee_atomic_xchg_u32(ptr, val)       (__atomic_exchange_n((ptr), (val), __ATOMIC_ACQUIRE))
+#define ee_atomic_add_u64(ptr, val)        (__atomic_fetch_add((ptr), (val), __ATOMIC_RELAXED))
+#define ee_atomic_fence_acq()              (__atomic_thread_fence(__ATOMIC_ACQUIRE))
+#define ee_atomic_fence_rel()              (__atomic_thread_fence(__ATOMIC_RELEASE))
+
+#elif defined(_MSC_VER)
+
+#if defined(_M_ARM64)
+#define _ee_atomic_barrier()               (__dmb(_ARM64_BARRIER_ISH))
+#else
+#define _ee_atomic_barrier()               (_ReadWriteBarrier())
+#endif
+
+EE_INLINE u32 ee_atomic_load_u32(volatile u32* ptr)
+{
+    u32 out = *ptr;
+    _ee_atomic_barrier();
+
+    return out;
+}
+
+#define ee_atomic_load_relaxed_u32(ptr)    (*(volatile u32*)(ptr))
+#define ee_atomic_store_u32(ptr, val)      do { _ee_atomic_barrier(); *(volatile u32*)(ptr) = (val); } while (0)
+#define ee_atomic_xchg_u32(ptr, val)       ((u32)_InterlockedExchange((volatile long*)(ptr), (long)(val)))
+#define ee_atomic_add_u64(ptr, val)        ((u64)_InterlockedExchangeAdd64((volatile long long*)(ptr), (long long)(val)))
+#define ee_atomic_fence_acq()              (_ee_atomic_barrier())
+#define ee_atomic_fence_rel()              (_ee_atomic_barrier())
+
+#else
+#error "Atomics: unknown compiler"
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ee_cpu_pause()    (__builtin_ia32_pause())
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define ee_cpu_pause()    (_mm_pause())
+#else
+#define ee_cpu_pause()    ((void)0)
+#endif
+
 //
 // Functions
 //
@@ -1064,6 +1394,15 @@ EE_INLINE i32 ee_popcnt_u32(u32 x)
 #endif
 }
 
+EE_INLINE i32 ee_popcnt_u64(u64 x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    return ee_popcnt_u32((u32)x) + ee_popcnt_u32((u32)(x >> 32));
+#endif
+}
+
 EE_INLINE int ee_is_pow2(u64 x)
 {
     return (x != 0) && ((x & (x - 1)) == 0);
@@ -1117,41 +1456,38 @@ EE_INLINE size_t ee_round_down_pow2(size_t x, size_t r)
     return x & (~(r - 1));
 }
 
-EE_INLINE i32 ee_eq_def(const u8* a_ptr, const u8* b_ptr, size_t len)
+// Nanoseconds of a monotonic clock with an arbitrary origin, only differences are meaningful
+EE_INLINE u64 ee_monotonic_ns(void)
 {
-    return memcmp(a_ptr, b_ptr, len) == 0;
-}
+#ifdef _WIN32
+    LARGE_INTEGER ticks, freq;
 
-EE_INLINE void ee_cpy_def(u8* a_ptr, const u8* b_ptr, size_t len)
-{
-    memcpy(a_ptr, b_ptr, len);
-}
+    QueryPerformanceCounter(&ticks);
+    QueryPerformanceFrequency(&freq);
 
-#if EE_SIMD_EFFECTIVE_MAX_LEVEL >= EE_SIMD_LEVEL_SSE
-EE_INLINE i32 ee_eq_safe_128(const u8* a_ptr, const u8* b_ptr, size_t len)
-{
-    EE_UNUSED(len);
+    u64 t = (u64)ticks.QuadPart;
+    u64 f = (u64)freq.QuadPart;
 
-    __m128i a = _mm_loadu_si128((const __m128i*)a_ptr);
-    __m128i b = _mm_loadu_si128((const __m128i*)b_ptr);
-    __m128i cmp = _mm_cmpeq_epi8(a, b);
+    // Split so the multiplication cannot overflow
+    return (t / f) * 1000000000ull + (t % f) * 1000000000ull / f;
+#else
+    struct timespec now;
 
-    return _mm_movemask_epi8(cmp) == 0xFFFF;
-}
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (u64)now.tv_sec * 1000000000ull + (u64)now.tv_nsec;
 #endif
+}
 
-#if EE_SIMD_EFFECTIVE_MAX_LEVEL >= EE_SIMD_LEVEL_AVX
-EE_INLINE i32 ee_eq_safe_256(const u8* a_ptr, const u8* b_ptr, size_t len)
+EE_INLINE i32 ee_eq_def(const u8* a_ptr, const u8* b_ptr, size_t len)
 {
-    EE_UNUSED(len);
-    
-    __m256i a = _mm256_loadu_si256((const __m256i*)a_ptr);
-    __m256i b = _mm256_loadu_si256((const __m256i*)b_ptr);
-    __m256i cmp = _mm256_cmpeq_epi8(a, b);
+    return memcmp(a_ptr, b_ptr, len) == 0;
+}
 
-    return _mm256_movemask_epi8(cmp) == 0xFFFFFFFF;
+EE_INLINE void ee_cpy_def(u8* a_ptr, const u8* b_ptr, size_t len)
+{
+    memcpy(a_ptr, b_ptr, len);
 }
-#endif
 
 EE_INLINE ee_simd_i _ee_mullo_epi64(ee_simd_i ab, ee_simd_i cd)
 {
@@ -1182,6 +1518,487 @@ EE_DEFINE_CPY_FN(16);
 EE_DEFINE_CPY_FN(32);
 EE_DEFINE_CPY_FN(64);
 
+//
+// Dispatched kernels
+//
+
+typedef size_t (*SimdFindFn)(const u8* buffer, size_t len, const u8* target);
+typedef u64    (*SimdMatchFn)(const u8* buffer, size_t len, const u8* target);
+typedef u64    (*SimdMatchWideFn)(const u8* buffer, size_t len, const u8* target, size_t elem_size);
+typedef i32    (*SimdEqFn)(const u8* a_ptr, const u8* b_ptr, size_t len);
+
+// Hot kernels bound to function pointers for the level returned by 'ee_simd_level'
+// find_N returns the index of the first N-bit element of 'buffer[0, len)' equal to 'target', 'len' if there is none
+// match_N sets bit i for every N-bit element i of 'buffer[0, len)' equal to 'target', 'len' is at most 64
+// match_wide is match_N for any 'elem_size', vectorized for multiples of 4 bytes from 12 to 32
+typedef struct SimdKernels
+{
+    u32 bound; // level + 1 the table was bound for, 0 before the first use
+
+    SimdFindFn find_8;
+    SimdFindFn find_16;
+    SimdFindFn find_32;
+    SimdFindFn find_64;
+
+    SimdMatchFn match_8;
+    SimdMatchFn match_16;
+    SimdMatchFn match_32;
+    SimdMatchFn match_64;
+    SimdMatchWideFn match_wide;
+
+    SimdEqFn eq_safe_128;
+    SimdEqFn eq_safe_256;
+} SimdKernels;
+
+#define EE_DEFINE_FIND_FN_SCALAR(size)                                                            \
+    EE_INLINE size_t _ee_find_##size##_scalar(const u8* buffer, size_t len, const u8* target)     \
+    {                                                                                             \
+        u##size a, b;                                                                             \
+        memcpy(&a, target, sizeof(a));                                                           \
+                                                                                                  \
+        for (size_t i = 0; i < len; ++i)                                                          \
+        {                                                                                         \
+            memcpy(&b, &buffer[i * sizeof(b)], sizeof(b));                                       \
+                                                                                                  \
+            if (a == b)                                                                           \
+                return i;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        return len;                                                                               \
+    }
+
+// Byte masks, every byte of a matching lane is set so the first bit marks the start of the element
+#define EE_DEFINE_FIND_FN_SIMD(size, level, isa, vec, bytes, loadu, set1, cmpeq, movemask)       \
+    EE_TARGET(isa) EE_INLINE size_t _ee_find_##size##_##level(const u8* buffer, size_t len, const u8* target) \
+    {                                                                                             \
+        u##size a;                                                                                \
+        memcpy(&a, target, sizeof(a));                                                           \
+                                                                                                  \
+        vec pattern = set1(a);                                                                    \
+        size_t upper = ee_round_down_pow2(len * sizeof(a), bytes);                                \
+        size_t i = 0;                                                                             \
+                                                                                                  \
+        for (; i < upper; i += bytes)                                                             \
+        {                                                                                         \
+            vec group = loadu((const vec*)&buffer[i]);                                            \
+            u32 mask = (u32)movemask(cmpeq(group, pattern));                                      \
+                                                                                                  \
+            if (mask)                                                                             \
+                return (i + ee_first_bit_u32(mask)) / sizeof(a);                                  \
+        }                                                                                         \
+                                                                                                  \
+        i /= sizeof(a);                                                                           \
+                                                                                                  \
+        return i + _ee_find_##size##_scalar(&buffer[i * sizeof(a)], len - i, target);             \
+    }
+
+// Lane masks, the first bit is the element index within the group
+#define EE_DEFINE_FIND_FN_AVX512(size, set1, cmpeq_mask)                                          \
+    EE_TARGET("avx512f,avx512bw") EE_INLINE size_t _ee_find_##size##_avx512(const u8* buffer, size_t len, const u8* target) \
+    {                                                                                             \
+        u##size a;                                                                                \
+        memcpy(&a, target, sizeof(a));                                                           \
+                                                                                                  \
+        __m512i pattern = set1(a);                                                                \
+        size_t upper = ee_round_down_pow2(len * sizeof(a), 64);                                   \
+        size_t i = 0;                                                                             \
+                                                                                                  \
+        for (; i < upper; i += 64)                                                                \
+        {                                                                                         \
+            u64 mask = (u64)cmpeq_mask(_mm512_loadu_si512((const void*)&buffer[i]), pattern);     \
+                                                                                                  \
+            if (mask)                                                                             \
+                return i / sizeof(a) + ee_first_bit_u64(mask);                                    \
+        }                                                                                         \
+                                                                                                  \
+        i /= sizeof(a);                                                                           \
+                                                                                                  \
+        return i + _ee_find_##size##_scalar(&buffer[i * sizeof(a)], len - i, target);             \
+    }
+
+#define EE_DEFINE_MATCH_FN_SCALAR(size)                                                           \
+    EE_INLINE u64 _ee_match_##size##_scalar(const u8* buffer, size_t len, const u8* target)       \
+    {                                                                                             \
+        u##size a, b;                                                                             \
+        u64 out = 0;                                                                              \
+        memcpy(&a, target, sizeof(a));                                                           \
+                                                                                                  \
+        for (size_t i = 0; i < len; ++i)                                                          \
+        {                                                                                         \
+            memcpy(&b, &buffer[i * sizeof(b)], sizeof(b));                                       \
+            out |= (u64)(a == b) << i;                                                            \
+        }                                                                                         \
+                                                                                                  \
+        return out;                                                                               \
+    }
+
+// 'lanes' compares 'step' elements with the pattern and returns one bit per element
+#define EE_DEFINE_MATCH_FN_SIMD(size, level, isa, vec, step, set1, lanes)                         \
+    EE_TARGET(isa) EE_INLINE u64 _ee_match_##size##_##level(const u8* buffer, size_t len, const u8* target) \
+    {                                                                                             \
+        u##size a;                                                                                \
+        memcpy(&a, target, sizeof(a));                                                           \
+                                                                                                  \
+        vec pattern = set1(a);                                                                    \
+        size_t upper = ee_round_down_pow2(len, step);                                             \
+        size_t i = 0;                                                                             \
+        u64 out = 0;                                                                              \
+                                                                                                  \
+        for (; i < upper; i += step)                                                              \
+            out |= (u64)lanes(&buffer[i * sizeof(a)], pattern) << i;                              \
+                                                                                                  \
+        if (i < len)                                                                              \
+            out |= _ee_match_##size##_scalar(&buffer[i * sizeof(a)], len - i, target) << i;       \
+                                                                                                  \
+        return out;                                                                               \
+    }
+
+// Wide elements are compared 32 bits at a time against the target repeated over the shortest run of
+// whole registers that holds whole elements (lcm of the element and register sizes, at most 8 registers).
+// An element matches when all of its dword bits are set
+#define EE_DEFINE_MATCH_WIDE_FN(level, isa, vec, bytes, loadu, cmpeq_epi32, movemask_ps)         \
+    EE_TARGET(isa) EE_INLINE u64 _ee_match_wide_##level(const u8* buffer, size_t len, const u8* target, size_t elem_size) \
+    {                                                                                             \
+        if (elem_size % 4 != 0 || elem_size < 12 || elem_size > 32)                               \
+            return _ee_match_wide_scalar(buffer, len, target, elem_size);                         \
+                                                                                                  \
+        u8 period[8 * (bytes)];                                                                   \
+        vec pattern[8];                                                                           \
+        size_t period_len = (bytes);                                                              \
+                                                                                                  \
+        while (period_len % elem_size != 0)                                                       \
+            period_len += (bytes);                                                                \
+                                                                                                  \
+        size_t regs = period_len / (bytes);                                                       \
+        size_t elems = period_len / elem_size;                                                    \
+        size_t dwords = elem_size / 4;                                                            \
+        u64 full = (1ull << dwords) - 1;                                                          \
+                                                                                                  \
+        for (size_t e = 0; e < elems; ++e)                                                        \
+            memcpy(&period[e * elem_size], target, elem_size);                                    \
+                                                                                                  \
+        for (size_t r = 0; r < regs; ++r)                                                         \
+            pattern[r] = loadu((const vec*)&period[r * (bytes)]);                                 \
+                                                                                                  \
+        size_t upper = len - len % elems;                                                         \
+        size_t i = 0;                                                                             \
+        u64 out = 0;                                                                              \
+                                                                                                  \
+        for (; i < upper; i += elems)                                                             \
+        {                                                                                         \
+            const u8* group = &buffer[i * elem_size];                                             \
+            u64 mask = 0;                                                                         \
+                                                                                                  \
+            for (size_t r = 0; r < regs; ++r)                                                     \
+            {                                                                                     \
+                vec eq = cmpeq_epi32(loadu((const vec*)&group[r * (bytes)]), pattern[r]);         \
+                mask |= (u64)movemask_ps(eq) << (r * ((bytes) / 4));                              \
+            }                                                                                     \
+                                                                                                  \
+            if (mask == 0)                                                                        \
+                continue;                                                                         \
+                                                                                                  \
+            for (size_t e = 0; e < elems; ++e)                                                    \
+                out |= (u64)(((mask >> (e * dwords)) & full) == full) << (i + e);                 \
+        }                                                                                         \
+                                                                                                  \
+        if (i < len)                                                                              \
+            out |= _ee_match_wide_scalar(&buffer[i * elem_size], len - i, target, elem_size) << i; \
+                                                                                                  \
+        return out;                                                                               \
+    }
+
+EE_DEFINE_FIND_FN_SCALAR(8);
+EE_DEFINE_FIND_FN_SCALAR(16);
+EE_DEFINE_FIND_FN_SCALAR(32);
+EE_DEFINE_FIND_FN_SCALAR(64);
+
+EE_DEFINE_MATCH_FN_SCALAR(8);
+EE_DEFINE_MATCH_FN_SCALAR(16);
+EE_DEFINE_MATCH_FN_SCALAR(32);
+EE_DEFINE_MATCH_FN_SCALAR(64);
+
+EE_INLINE u64 _ee_match_wide_scalar(const u8* buffer, size_t len, const u8* target, size_t elem_size)
+{
+    u64 out = 0;
+
+    for (size_t i = 0; i < len; ++i)
+    {
+        out |= (u64)(memcmp(&buffer[i * elem_size], target, elem_size) == 0) << i;
+    }
+
+    return out;
+}
+
+EE_INLINE i32 _ee_eq_safe_128_scalar(const u8* a_ptr, const u8* b_ptr, size_t len)
+{
+    EE_UNUSED(len);
+
+    return memcmp(a_ptr, b_ptr, 16) == 0;
+}
+
+EE_INLINE i32 _ee_eq_safe_256_scalar(const u8* a_ptr, const u8* b_ptr, size_t len)
+{
+    EE_UNUSED(len);
+
+    return memcmp(a_ptr, b_ptr, 32) == 0;
+}
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_SSE
+
+// SSE2 has no 64-bit compare, a lane matches when both of its 32-bit halves do
+EE_TARGET("sse2") EE_INLINE __m128i _ee_cmpeq_epi64_sse2(__m128i a, __m128i b)
+{
+    __m128i eq = _mm_cmpeq_epi32(a, b);
+
+    return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+EE_DEFINE_FIND_FN_SIMD(8,  sse2, "sse2", __m128i, 16, _mm_loadu_si128, _mm_set1_epi8,   _mm_cmpeq_epi8,       _mm_movemask_epi8);
+EE_DEFINE_FIND_FN_SIMD(16, sse2, "sse2", __m128i, 16, _mm_loadu_si128, _mm_set1_epi16,  _mm_cmpeq_epi16,      _mm_movemask_epi8);
+EE_DEFINE_FIND_FN_SIMD(32, sse2, "sse2", __m128i, 16, _mm_loadu_si128, _mm_set1_epi32,  _mm_cmpeq_epi32,      _mm_movemask_epi8);
+EE_DEFINE_FIND_FN_SIMD(64, sse2, "sse2", __m128i, 16, _mm_loadu_si128, _mm_set1_epi64x, _ee_cmpeq_epi64_sse2, _mm_movemask_epi8);
+
+EE_TARGET("sse2") EE_INLINE u32 _ee_lanes_8_sse2(const u8* buffer, __m128i pattern)
+{
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)buffer), pattern));
+}
+
+// Two registers, the 16-bit compare results are packed to one byte per lane
+EE_TARGET("sse2") EE_INLINE u32 _ee_lanes_16_sse2(const u8* buffer, __m128i pattern)
+{
+    __m128i lo = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)buffer), pattern);
+    __m128i hi = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(buffer + 16)), pattern);
+
+    return (u32)_mm_movemask_epi8(_mm_packs_epi16(lo, hi));
+}
+
+EE_TARGET("sse2") EE_INLINE u32 _ee_lanes_32_sse2(const u8* buffer, __m128i pattern)
+{
+    return (u32)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)buffer), pattern)));
+}
+
+EE_TARGET("sse2") EE_INLINE u32 _ee_lanes_64_sse2(const u8* buffer, __m128i pattern)
+{
+    return (u32)_mm_movemask_pd(_mm_castsi128_pd(_ee_cmpeq_epi64_sse2(_mm_loadu_si128((const __m128i*)buffer), pattern)));
+}
+
+EE_TARGET("sse2") EE_INLINE u32 _ee_movemask_epi32_sse2(__m128i v)
+{
+    return (u32)_mm_movemask_ps(_mm_castsi128_ps(v));
+}
+
+EE_DEFINE_MATCH_FN_SIMD(8,  sse2, "sse2", __m128i, 16, _mm_set1_epi8,   _ee_lanes_8_sse2);
+EE_DEFINE_MATCH_FN_SIMD(16, sse2, "sse2", __m128i, 16, _mm_set1_epi16,  _ee_lanes_16_sse2);
+EE_DEFINE_MATCH_FN_SIMD(32, sse2, "sse2", __m128i, 4,  _mm_set1_epi32,  _ee_lanes_32_sse2);
+EE_DEFINE_MATCH_FN_SIMD(64, sse2, "sse2", __m128i, 2,  _mm_set1_epi64x, _ee_lanes_64_sse2);
+
+EE_DEFINE_MATCH_WIDE_FN(sse2, "sse2", __m128i, 16, _mm_loadu_si128, _mm_cmpeq_epi32, _ee_movemask_epi32_sse2);
+
+EE_TARGET("sse2") EE_INLINE i32 _ee_eq_safe_128_sse2(const u8* a_ptr, const u8* b_ptr, size_t len)
+{
+    EE_UNUSED(len);
+
+    __m128i a = _mm_loadu_si128((const __m128i*)a_ptr);
+    __m128i b = _mm_loadu_si128((const __m128i*)b_ptr);
+    __m128i cmp = _mm_cmpeq_epi8(a, b);
+
+    return _mm_movemask_epi8(cmp) == 0xFFFF;
+}
+
+EE_TARGET("sse2") EE_INLINE i32 _ee_eq_safe_256_sse2(const u8* a_ptr, const u8* b_ptr, size_t len)
+{
+    EE_UNUSED(len);
+
+    __m128i lo = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)a_ptr), _mm_loadu_si128((const __m128i*)b_ptr));
+    __m128i hi = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a_ptr + 16)), _mm_loadu_si128((const __m128i*)(b_ptr + 16)));
+
+    return _mm_movemask_epi8(_mm_and_si128(lo, hi)) == 0xFFFF;
+}
+
+#endif
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX
+
+EE_DEFINE_FIND_FN_SIMD(8,  avx2, "avx2", __m256i, 32, _mm256_loadu_si256, _mm256_set1_epi8,   _mm256_cmpeq_epi8,  _mm256_movemask_epi8);
+EE_DEFINE_FIND_FN_SIMD(16, avx2, "avx2", __m256i, 32, _mm256_loadu_si256, _mm256_set1_epi16,  _mm256_cmpeq_epi16, _mm256_movemask_epi8);
+EE_DEFINE_FIND_FN_SIMD(32, avx2, "avx2", __m256i, 32, _mm256_loadu_si256, _mm256_set1_epi32,  _mm256_cmpeq_epi32, _mm256_movemask_epi8);
+EE_DEFINE_FIND_FN_SIMD(64, avx2, "avx2", __m256i, 32, _mm256_loadu_si256, _mm256_set1_epi64x, _mm256_cmpeq_epi64, _mm256_movemask_epi8);
+
+EE_TARGET("avx2") EE_INLINE u32 _ee_lanes_8_avx2(const u8* buffer, __m256i pattern)
+{
+    return (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)buffer), pattern));
+}
+
+// Packing works per 128-bit half, the permute restores the element order
+EE_TARGET("avx2") EE_INLINE u32 _ee_lanes_16_avx2(const u8* buffer, __m256i pattern)
+{
+    __m256i lo = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i*)buffer), pattern);
+    __m256i hi = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i*)(buffer + 32)), pattern);
+
+    return (u32)_mm256_movemask_epi8(_mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), 0xD8));
+}
+
+EE_TARGET("avx2") EE_INLINE u32 _ee_lanes_32_avx2(const u8* buffer, __m256i pattern)
+{
+    return (u32)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)buffer), pattern)));
+}
+
+EE_TARGET("avx2") EE_INLINE u32 _ee_lanes_64_avx2(const u8* buffer, __m256i pattern)
+{
+    return (u32)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)buffer), pattern)));
+}
+
+EE_TARGET("avx2") EE_INLINE u32 _ee_movemask_epi32_avx2(__m256i v)
+{
+    return (u32)_mm256_movemask_ps(_mm256_castsi256_ps(v));
+}
+
+EE_DEFINE_MATCH_FN_SIMD(8,  avx2, "avx2", __m256i, 32, _mm256_set1_epi8,   _ee_lanes_8_avx2);
+EE_DEFINE_MATCH_FN_SIMD(16, avx2, "avx2", __m256i, 32, _mm256_set1_epi16,  _ee_lanes_16_avx2);
+EE_DEFINE_MATCH_FN_SIMD(32, avx2, "avx2", __m256i, 8,  _mm256_set1_epi32,  _ee_lanes_32_avx2);
+EE_DEFINE_MATCH_FN_SIMD(64, avx2, "avx2", __m256i, 4,  _mm256_set1_epi64x, _ee_lanes_64_avx2);
+
+EE_DEFINE_MATCH_WIDE_FN(avx2, "avx2", __m256i, 32, _mm256_loadu_si256, _mm256_cmpeq_epi32, _ee_movemask_epi32_avx2);
+
+EE_TARGET("avx2") EE_INLINE i32 _ee_eq_safe_256_avx2(const u8* a_ptr, const u8* b_ptr, size_t len)
+{
+    EE_UNUSED(len);
+
+    __m256i a = _mm256_loadu_si256((const __m256i*)a_ptr);
+    __m256i b = _mm256_loadu_si256((const __m256i*)b_ptr);
+    __m256i cmp = _mm256_cmpeq_epi8(a, b);
+
+    return (u32)_mm256_movemask_epi8(cmp) == 0xFFFFFFFFu;
+}
+
+#endif
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX512
+
+EE_DEFINE_FIND_FN_AVX512(8,  _mm512_set1_epi8,  _mm512_cmpeq_epi8_mask);
+EE_DEFINE_FIND_FN_AVX512(16, _mm512_set1_epi16, _mm512_cmpeq_epi16_mask);
+EE_DEFINE_FIND_FN_AVX512(32, _mm512_set1_epi32, _mm512_cmpeq_epi32_mask);
+EE_DEFINE_FIND_FN_AVX512(64, _mm512_set1_epi64, _mm512_cmpeq_epi64_mask);
+
+EE_TARGET("avx512f,avx512bw") EE_INLINE u64 _ee_lanes_8_avx512(const u8* buffer, __m512i pattern)
+{
+    return (u64)_mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void*)buffer), pattern);
+}
+
+EE_TARGET("avx512f,avx512bw") EE_INLINE u64 _ee_lanes_16_avx512(const u8* buffer, __m512i pattern)
+{
+    return (u64)_mm512_cmpeq_epi16_mask(_mm512_loadu_si512((const void*)buffer), pattern);
+}
+
+EE_TARGET("avx512f,avx512bw") EE_INLINE u64 _ee_lanes_32_avx512(const u8* buffer, __m512i pattern)
+{
+    return (u64)_mm512_cmpeq_epi32_mask(_mm512_loadu_si512((const void*)buffer), pattern);
+}
+
+EE_TARGET("avx512f,avx512bw") EE_INLINE u64 _ee_lanes_64_avx512(const u8* buffer, __m512i pattern)
+{
+    return (u64)_mm512_cmpeq_epi64_mask(_mm512_loadu_si512((const void*)buffer), pattern);
+}
+
+EE_DEFINE_MATCH_FN_SIMD(8,  avx512, "avx512f,avx512bw", __m512i, 64, _mm512_set1_epi8,  _ee_lanes_8_avx512);
+EE_DEFINE_MATCH_FN_SIMD(16, avx512, "avx512f,avx512bw", __m512i, 32, _mm512_set1_epi16, _ee_lanes_16_avx512);
+EE_DEFINE_MATCH_FN_SIMD(32, avx512, "avx512f,avx512bw", __m512i, 16, _mm512_set1_epi32, _ee_lanes_32_avx512);
+EE_DEFINE_MATCH_FN_SIMD(64, avx512, "avx512f,avx512bw", __m512i, 8,  _mm512_set1_epi64, _ee_lanes_64_avx512);
+
+#endif
+
+EE_INLINE void _ee_simd_bind(SimdKernels* kernels, i32 level)
+{
+    EE_UNUSED(level);
+
+    kernels->find_8 = _ee_find_8_scalar;
+    kernels->find_16 = _ee_find_16_scalar;
+    kernels->find_32 = _ee_find_32_scalar;
+    kernels->find_64 = _ee_find_64_scalar;
+    kernels->match_8 = _ee_match_8_scalar;
+    kernels->match_16 = _ee_match_16_scalar;
+    kernels->match_32 = _ee_match_32_scalar;
+    kernels->match_64 = _ee_match_64_scalar;
+    kernels->match_wide = _ee_match_wide_scalar;
+    kernels->eq_safe_128 = _ee_eq_safe_128_scalar;
+    kernels->eq_safe_256 = _ee_eq_safe_256_scalar;
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_SSE
+    if (level >= EE_SIMD_LEVEL_SSE)
+    {
+        kernels->find_8 = _ee_find_8_sse2;
+        kernels->find_16 = _ee_find_16_sse2;
+        kernels->find_32 = _ee_find_32_sse2;
+        kernels->find_64 = _ee_find_64_sse2;
+        kernels->match_8 = _ee_match_8_sse2;
+        kernels->match_16 = _ee_match_16_sse2;
+        kernels->match_32 = _ee_match_32_sse2;
+        kernels->match_64 = _ee_match_64_sse2;
+        kernels->match_wide = _ee_match_wide_sse2;
+        kernels->eq_safe_128 = _ee_eq_safe_128_sse2;
+        kernels->eq_safe_256 = _ee_eq_safe_256_sse2;
+    }
+#endif
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX
+    if (level >= EE_SIMD_LEVEL_AVX)
+    {
+        kernels->find_8 = _ee_find_8_avx2;
+        kernels->find_16 = _ee_find_16_avx2;
+        kernels->find_32 = _ee_find_32_avx2;
+        kernels->find_64 = _ee_find_64_avx2;
+        kernels->match_8 = _ee_match_8_avx2;
+        kernels->match_16 = _ee_match_16_avx2;
+        kernels->match_32 = _ee_match_32_avx2;
+        kernels->match_64 = _ee_match_64_avx2;
+        kernels->match_wide = _ee_match_wide_avx2;
+        kernels->eq_safe_256 = _ee_eq_safe_256_avx2;
+    }
+#endif
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX512
+    if (level >= EE_SIMD_LEVEL_AVX512)
+    {
+        kernels->find_8 = _ee_find_8_avx512;
+        kernels->find_16 = _ee_find_16_avx512;
+        kernels->find_32 = _ee_find_32_avx512;
+        kernels->find_64 = _ee_find_64_avx512;
+        kernels->match_8 = _ee_match_8_avx512;
+        kernels->match_16 = _ee_match_16_avx512;
+        kernels->match_32 = _ee_match_32_avx512;
+        kernels->match_64 = _ee_match_64_avx512;
+    }
+#endif
+}
+
+// Bound on first use and again whenever 'ee_simd_force_level' changed the level
+// Concurrent binds store the same pointers, the level is published last
+EE_INLINE const SimdKernels* ee_simd_kernels(void)
+{
+    static SimdKernels kernels = { 0 };
+
+    u32 bound = (u32)ee_simd_level() + 1;
+
+    if (ee_atomic_load_u32(&kernels.bound) != bound)
+    {
+        _ee_simd_bind(&kernels, (i32)bound - 1);
+        ee_atomic_store_u32(&kernels.bound, bound);
+    }
+
+    return &kernels;
+}
+
+EE_INLINE i32 ee_eq_safe_128(const u8* a_ptr, const u8* b_ptr, size_t len)
+{
+    return ee_simd_kernels()->eq_safe_128(a_ptr, b_ptr, len);
+}
+
+EE_INLINE i32 ee_eq_safe_256(const u8* a_ptr, const u8* b_ptr, size_t len)
+{
+    return ee_simd_kernels()->eq_safe_256(a_ptr, b_ptr, len);
+}
+
 EE_EXTERN_C_END
 
 EE_INLINE size_t ee_strnlen(const char* str, size_t max_len)
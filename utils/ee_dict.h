@@ -5,7 +5,6 @@
 TODO:
 
 1. Safe/Fast versions of copy and comparison functions
-2. Bulk table operations
 
 */
 
@@ -13,6 +12,8 @@ TODO:
 #define EE_DICT_H
 
 #include "ee_core.h"
+#include "ee_array.h"
+#include "ee_arena.h"
 
 static const u64 EE_ZERO_U64 = 0;
 static const u64 EE_ONE_U64  = 1;
@@ -25,6 +26,29 @@ static const f64 EE_ONE_F64  = 1.0;
 #define EE_DICT_START_SIZE           (32)
 #endif
 
+#ifndef EE_DICT_BATCH_SIZE
+#define EE_DICT_BATCH_SIZE           (16)
+#endif
+
+#ifndef EE_DICT_BULK_RADIX_BITS
+#define EE_DICT_BULK_RADIX_BITS      (11)
+#endif
+
+#ifndef EE_DICT_MIGRATE_GROUPS
+#define EE_DICT_MIGRATE_GROUPS       (2)
+#endif
+
+// Buckets of the probe length histograms, the last one collects every longer probe
+#ifndef EE_DICT_STATS_PROBES
+#define EE_DICT_STATS_PROBES         (16)
+#endif
+
+#ifdef EE_DICT_STATS
+#define EED_STAT(...)                __VA_ARGS__
+#else
+#define EED_STAT(...)
+#endif
+
 #define EE_GROUP_SIZE                (EED_SIMD_BYTES)
 
 #define EE_SLOT_EMPTY                (0x80)
@@ -66,6 +90,9 @@ typedef u64  (*DictHash)(const u8* key, size_t len);
 typedef i32  (*DictEq)(const u8* a, const u8* b, size_t len);
 typedef void (*DictCpy)(u8* dest, const u8* src, size_t len);
 
+// Visitor of 'ee_dict_for_each', returning EE_FALSE stops the walk
+typedef i32  (*DictVisit)(const u8* key, u8* val, void* context);
+
 #define ee_dict_new_conf_m(size, key_type, val_type, config)     ee_dict_new(size, sizeof(key_type), sizeof(val_type), config)
 #define ee_dict_new_m(size, key_type, val_type, \
 	allocator, hash_fn, eq_fn, key_cpy_fn, val_cpy_fn)           ee_dict_new(size, sizeof(key_type), sizeof(val_type), (DictConfig) { allocator, hash_fn, eq_fn, key_cpy_fn, val_cpy_fn })
@@ -390,6 +417,253 @@ EE_INLINE u64 ee_hash_cstr_safe(const u8* key, size_t len)
 	return ee_hash_safe((const u8*)str, str_len);
 }
 
+// Bulk hashing of packed fixed-width keys, every output is bit identical to the scalar hash of that key
+// (the fast and safe variants only differ in how they load). 4 and 8 byte keys run on the EE_SIMD_MAX_LEVEL
+// lanes, AVX-512 with DQ (native 64-bit multiplies) is picked at runtime and is the only vector path for
+// 16 and 32 byte keys, their scalar hashes are a single multiply that the emulated 64-bit lane multiply does not beat
+#define EE_HASH_LANES    (EE_SIMD_BYTES / sizeof(u64))
+
+EE_INLINE ee_simd_i _ee_hash_mul_lanes(ee_simd_i hash)
+{
+	hash = ee_mullo_epi64(hash, ee_set1_epi64((i64)0x9E3779B185EBCA87ULL));
+
+	return ee_xor_si(hash, ee_srli_epi64(hash, 33));
+}
+
+EE_INLINE ee_simd_i _ee_hash_mm_lanes(ee_simd_i hash)
+{
+	hash = ee_xor_si(hash, ee_srli_epi64(hash, 30));
+	hash = ee_mullo_epi64(hash, ee_set1_epi64((i64)0xbf58476d1ce4e5b9ULL));
+	hash = ee_xor_si(hash, ee_srli_epi64(hash, 27));
+	hash = ee_mullo_epi64(hash, ee_set1_epi64((i64)0x94d049bb133111ebULL));
+
+	return ee_xor_si(hash, ee_srli_epi64(hash, 31));
+}
+
+// EE_HASH_LANES u32 keys zero extended into the u64 lanes
+EE_INLINE ee_simd_i _ee_hash_load_u32_lanes(const u8* keys)
+{
+#if EE_SIMD_EFFECTIVE_MAX_LEVEL == EE_SIMD_LEVEL_AVX
+	return _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i*)keys));
+#elif EE_SIMD_EFFECTIVE_MAX_LEVEL == EE_SIMD_LEVEL_SSE
+	return _mm_unpacklo_epi32(_mm_loadl_epi64((const __m128i*)keys), _mm_setzero_si128());
+#else
+	u32 key;
+	memcpy(&key, keys, sizeof(key));
+
+	return (ee_simd_i)key;
+#endif
+}
+
+// 'key_len' is 4 or 8, 'mm' selects the mm mixer. Returns how many keys were hashed, the tail is left to the caller
+EE_INLINE size_t _ee_hash_many_simd(const u8* keys, size_t n, u64* out, size_t key_len, i32 mm)
+{
+	size_t i = 0;
+
+	for (; i + EE_HASH_LANES <= n; i += EE_HASH_LANES)
+	{
+		ee_simd_i hash = key_len == sizeof(u32)
+			? _ee_hash_load_u32_lanes(&keys[i * key_len])
+			: ee_loadu_si((const ee_simd_i*)&keys[i * key_len]);
+
+		hash = mm ? _ee_hash_mm_lanes(hash) : _ee_hash_mul_lanes(hash);
+
+		ee_storeu_si((ee_simd_i*)&out[i], hash);
+	}
+
+	return i;
+}
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX512
+
+EE_INLINE i32 _ee_hash_many_avx512_ok(void)
+{
+	return ee_simd_level() >= EE_SIMD_LEVEL_AVX512 && (ee_cpu_features() & EE_CPU_AVX512DQ);
+}
+
+EE_TARGET("avx512f,avx512dq") EE_INLINE __m512i _ee_hash_mul_avx512(__m512i hash)
+{
+	hash = _mm512_mullo_epi64(hash, _mm512_set1_epi64((i64)0x9E3779B185EBCA87ULL));
+
+	return _mm512_xor_si512(hash, _mm512_srli_epi64(hash, 33));
+}
+
+EE_TARGET("avx512f,avx512dq") EE_INLINE size_t _ee_hash_many_avx512(const u8* keys, size_t n, u64* out, size_t key_len, i32 mm)
+{
+	size_t i = 0;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		__m512i hash = key_len == sizeof(u32)
+			? _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i*)&keys[i * key_len]))
+			: _mm512_loadu_si512((const void*)&keys[i * key_len]);
+
+		if (mm)
+		{
+			hash = _mm512_xor_si512(hash, _mm512_srli_epi64(hash, 30));
+			hash = _mm512_mullo_epi64(hash, _mm512_set1_epi64((i64)0xbf58476d1ce4e5b9ULL));
+			hash = _mm512_xor_si512(hash, _mm512_srli_epi64(hash, 27));
+			hash = _mm512_mullo_epi64(hash, _mm512_set1_epi64((i64)0x94d049bb133111ebULL));
+			hash = _mm512_xor_si512(hash, _mm512_srli_epi64(hash, 31));
+		}
+		else
+		{
+			hash = _ee_hash_mul_avx512(hash);
+		}
+
+		_mm512_storeu_si512((void*)&out[i], hash);
+	}
+
+	return i;
+}
+
+// hash ^= word + add + (hash << shift), one step of the u128 and u256 hashes
+EE_TARGET("avx512f") EE_INLINE __m512i _ee_hash_step_avx512(__m512i hash, __m512i word, u64 add, u32 shift)
+{
+	__m512i mix = _mm512_add_epi64(_mm512_add_epi64(word, _mm512_set1_epi64((i64)add)), _mm512_sll_epi64(hash, _mm_cvtsi32_si128((i32)shift)));
+
+	return _mm512_xor_si512(hash, mix);
+}
+
+// Eight keys of 'words' u64 words are transposed so lane i holds word j of key i
+EE_TARGET("avx512f,avx512dq") EE_INLINE size_t _ee_hash_many_wide_avx512(const u8* keys, size_t n, u64* out, size_t words)
+{
+	const u64 adds[4] = { 0, 0x9e3779b97f4a7c15ull, 0xC6BC279692B5C323ULL, 0x165667B19E3779F9ULL };
+	const u32 shifts[4] = { 0, 17, 13, 11 };
+
+	size_t i = 0;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		const u8* base = &keys[i * words * sizeof(u64)];
+		__m512i word[4];
+
+		if (words == 2)
+		{
+			__m512i a = _mm512_loadu_si512((const void*)base);
+			__m512i b = _mm512_loadu_si512((const void*)&base[64]);
+
+			word[0] = _mm512_permutex2var_epi64(a, _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14), b);
+			word[1] = _mm512_permutex2var_epi64(a, _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15), b);
+		}
+		else
+		{
+			__m512i a = _mm512_loadu_si512((const void*)base);
+			__m512i b = _mm512_loadu_si512((const void*)&base[64]);
+			__m512i c = _mm512_loadu_si512((const void*)&base[128]);
+			__m512i d = _mm512_loadu_si512((const void*)&base[192]);
+
+			// Keys 0-3 come from 'a:b' into the low lanes, keys 4-7 from 'c:d' into the high lanes
+			for (i32 j = 0; j < 4; ++j)
+			{
+				__m512i index = _mm512_setr_epi64(j, j + 4, j + 8, j + 12, j, j + 4, j + 8, j + 12);
+
+				word[j] = _mm512_mask_blend_epi64(0xF0, _mm512_permutex2var_epi64(a, index, b), _mm512_permutex2var_epi64(c, index, d));
+			}
+		}
+
+		__m512i hash = _mm512_mullo_epi64(word[0], _mm512_set1_epi64((i64)0x9E3779B185EBCA87ULL));
+
+		// u128 uses the third constant for its only step
+		if (words == 2)
+		{
+			hash = _ee_hash_step_avx512(hash, word[1], adds[2], shifts[1]);
+		}
+		else
+		{
+			for (size_t j = 1; j < 4; ++j)
+				hash = _ee_hash_step_avx512(hash, word[j], adds[j], shifts[j]);
+		}
+
+		_mm512_storeu_si512((void*)&out[i], hash);
+	}
+
+	return i;
+}
+
+#endif
+
+EE_INLINE void _ee_hash_many(const u8* keys, size_t n, u64* out, size_t key_len, i32 mm)
+{
+	EE_ASSERT(keys != NULL || n == 0, "Trying to hash NULL keys");
+	EE_ASSERT(out != NULL || n == 0, "Trying to hash into NULL output");
+
+	size_t i = 0;
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX512
+	if (_ee_hash_many_avx512_ok())
+		i = _ee_hash_many_avx512(keys, n, out, key_len, mm);
+#endif
+
+	i += _ee_hash_many_simd(&keys[i * key_len], n - i, &out[i], key_len, mm);
+
+	for (; i < n; ++i)
+	{
+		const u8* key = &keys[i * key_len];
+
+		if (key_len == sizeof(u32))
+			out[i] = mm ? ee_hash_mm_u32_safe(key, key_len) : ee_hash_u32_safe(key, key_len);
+		else
+			out[i] = mm ? ee_hash_mm_u64_safe(key, key_len) : ee_hash_u64_safe(key, key_len);
+	}
+}
+
+EE_INLINE void ee_hash_u32_many(const u8* keys, size_t n, u64* out)
+{
+	_ee_hash_many(keys, n, out, sizeof(u32), EE_FALSE);
+}
+
+EE_INLINE void ee_hash_u64_many(const u8* keys, size_t n, u64* out)
+{
+	_ee_hash_many(keys, n, out, sizeof(u64), EE_FALSE);
+}
+
+EE_INLINE void ee_hash_mm_u32_many(const u8* keys, size_t n, u64* out)
+{
+	_ee_hash_many(keys, n, out, sizeof(u32), EE_TRUE);
+}
+
+EE_INLINE void ee_hash_mm_u64_many(const u8* keys, size_t n, u64* out)
+{
+	_ee_hash_many(keys, n, out, sizeof(u64), EE_TRUE);
+}
+
+EE_INLINE void ee_hash_u128_many(const u8* keys, size_t n, u64* out)
+{
+	EE_ASSERT(keys != NULL || n == 0, "Trying to hash NULL keys");
+	EE_ASSERT(out != NULL || n == 0, "Trying to hash into NULL output");
+
+	size_t i = 0;
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX512
+	if (_ee_hash_many_avx512_ok())
+		i = _ee_hash_many_wide_avx512(keys, n, out, 2);
+#endif
+
+	for (; i < n; ++i)
+	{
+		out[i] = ee_hash_u128_safe(&keys[i * 2 * sizeof(u64)], 2 * sizeof(u64));
+	}
+}
+
+EE_INLINE void ee_hash_u256_many(const u8* keys, size_t n, u64* out)
+{
+	EE_ASSERT(keys != NULL || n == 0, "Trying to hash NULL keys");
+	EE_ASSERT(out != NULL || n == 0, "Trying to hash into NULL output");
+
+	size_t i = 0;
+
+#if EE_SIMD_DISPATCH_MAX_LEVEL >= EE_SIMD_LEVEL_AVX512
+	if (_ee_hash_many_avx512_ok())
+		i = _ee_hash_many_wide_avx512(keys, n, out, 4);
+#endif
+
+	for (; i < n; ++i)
+	{
+		out[i] = ee_hash_u256_safe(&keys[i * 4 * sizeof(u64)], 4 * sizeof(u64));
+	}
+}
+
 //#define EE_HASH_SAFETY_TYPE EE_HASH_FAST
 //#define EE_HASH_COMP_TYPE EE_HASH_SIMPLE
 
@@ -475,15 +749,63 @@ EE_INLINE void ee_aligned_free(AlignedBuffer* buffer, Allocator* allocator)
 	memset(buffer, 0, sizeof(*buffer));
 }
 
+typedef enum DictGrowType
+{
+	EE_DICT_GROW_FULL        = 0,
+	EE_DICT_GROW_INCREMENTAL = 1,
+	// Keys, values and ctrl share one allocation that grow extends with 'realloc_fn' and rehashes in place,
+	// so an arena never holds the old table next to the new one. Picked for arena allocators by default
+	EE_DICT_GROW_INPLACE     = 2,
+} DictGrowType;
+
+typedef enum DictLayout
+{
+	EE_DICT_LAYOUT_SPLIT       = 0,
+	EE_DICT_LAYOUT_INTERLEAVED = 1,
+} DictLayout;
+
 typedef struct DictConfig
 {
-	Allocator* allocator;
-	DictHash   hash_fn;
-	DictEq     eq_fn;
-	DictCpy    key_cpy_fn;
-	DictCpy    val_cpy_fn;
+	Allocator*   allocator;
+	DictHash     hash_fn;
+	DictEq       eq_fn;
+	DictCpy      key_cpy_fn;
+	DictCpy      val_cpy_fn;
+	DictGrowType grow;
+	DictLayout   layout;
 } DictConfig;
 
+typedef struct DictStats
+{
+	// Probe lengths are in groups visited, lookups include removes and 'ee_dict_at_batch' keys.
+	// During an incremental grow a miss in the new table is counted again in the old one
+	// and inserts include the entries moved by migration
+	u64 lookups;
+	u64 inserts;
+	u64 removes;
+	u64 probe_lookup[EE_DICT_STATS_PROBES];
+	u64 probe_insert[EE_DICT_STATS_PROBES];
+
+	// Slots whose 7-bit tag matched, and how many of them held a different key
+	u64 tag_hits;
+	u64 tag_false;
+
+	u64 grows;
+	u64 rehashes;
+	u64 migrations;
+
+	// Wall time measured with 'ee_monotonic_ns'
+	f64 grow_sec;
+	f64 rehash_sec;
+	f64 migrate_sec;
+
+	// Read from the table by 'ee_dict_stats', available without EE_DICT_STATS
+	size_t count;
+	size_t cap;
+	size_t tombs;
+	f64    load;
+} DictStats;
+
 typedef struct Dict
 {
 	AlignedBuffer keys;
@@ -498,11 +820,31 @@ typedef struct Dict
 	size_t key_len;
 	size_t val_len;
 
+	// Distance between consecutive keys/vals, with EE_DICT_LAYOUT_INTERLEAVED both equal the slot size
+	// and 'vals' aliases the 'keys' allocation (vals.base is NULL).
+	// A zero 'val_len' makes a set: no value buffer, 'vals' aliases 'keys' with a zero stride
+	size_t     key_stride;
+	size_t     val_stride;
+	DictLayout layout;
+
+	// Table that is being drained into this one by EE_DICT_GROW_INCREMENTAL
+	struct Dict* old;
+	size_t       migrate_pos;
+	DictGrowType grow;
+
 #ifdef EE_DICT_TOMBS_REHASH
 	size_t tombs;
 	size_t tombs_th;
 #endif
 
+#ifdef EE_DICT_STATS
+	DictStats stats;
+#endif
+
+	// Read-only file mapping backing all buffers when created by 'ee_dict_map', buffers have NULL base
+	void*  image;
+	size_t image_size;
+
 	Allocator allocator;
 	DictHash  hash_fn;
 	DictEq    eq_fn;
@@ -516,6 +858,15 @@ typedef struct DictIter
 	size_t it;
 } DictIter;
 
+// Group-at-a-time iterator, each ctrl group is loaded once and its occupied slots are bit-scanned out of 'mask'
+typedef struct DictScan
+{
+	const Dict* dict;
+	const Dict* table;
+	size_t      group;
+	eed_mask    mask;
+} DictScan;
+
 EE_EXTERN_C_START
 
 EE_INLINE u64 ee_dict_th(u64 cap)
@@ -530,6 +881,41 @@ EE_INLINE u64 ee_tombs_th(u64 cap)
 }
 #endif
 
+#ifdef EE_DICT_STATS
+EE_INLINE void _ee_dict_stats_probe(u64* hist, size_t steps)
+{
+	hist[ee_min_u64(steps, EE_DICT_STATS_PROBES - 1)]++;
+}
+
+EE_INLINE f64 _ee_dict_stats_since(u64 start_ns)
+{
+	return (f64)(ee_monotonic_ns() - start_ns) * 1e-9;
+}
+
+EE_INLINE void _ee_dict_stats_merge(DictStats* dst, const DictStats* src)
+{
+	dst->lookups += src->lookups;
+	dst->inserts += src->inserts;
+	dst->removes += src->removes;
+
+	for (size_t i = 0; i < EE_DICT_STATS_PROBES; ++i)
+	{
+		dst->probe_lookup[i] += src->probe_lookup[i];
+		dst->probe_insert[i] += src->probe_insert[i];
+	}
+
+	dst->tag_hits  += src->tag_hits;
+	dst->tag_false += src->tag_false;
+
+	dst->grows       += src->grows;
+	dst->rehashes    += src->rehashes;
+	dst->migrations  += src->migrations;
+	dst->grow_sec    += src->grow_sec;
+	dst->rehash_sec  += src->rehash_sec;
+	dst->migrate_sec += src->migrate_sec;
+}
+#endif
+
 EE_INLINE DictConfig ee_dict_config_new(Allocator* allocator, DictHash hash_fn, DictEq eq_fn, DictCpy key_cpy_fn, DictCpy val_cpy_fn)
 {
 	DictConfig out = { 0 };
@@ -555,7 +941,7 @@ EE_INLINE u8* ee_dict_key_at(const Dict* dict, size_t i)
 	EE_ASSERT(dict != NULL, "Trying to acces NULL dict slot");
 	EE_ASSERT(i < dict->cap, "Invalid key index (%zu) for dict with cap (%zu)", i, dict->cap);
 
-	return &dict->keys.buffer[i * dict->key_len];
+	return &dict->keys.buffer[i * dict->key_stride];
 }
 
 EE_INLINE u8* ee_dict_val_at(const Dict* dict, size_t i)
@@ -563,7 +949,19 @@ EE_INLINE u8* ee_dict_val_at(const Dict* dict, size_t i)
 	EE_ASSERT(dict != NULL, "Trying to acces NULL dict slot");
 	EE_ASSERT(i < dict->cap, "Invalid val index (%zu) for dict with cap (%zu)", i, dict->cap);
 
-	return &dict->vals.buffer[i * dict->val_len];
+	return &dict->vals.buffer[i * dict->val_stride];
+}
+
+EE_INLINE size_t ee_dict_count(const Dict* dict)
+{
+	EE_ASSERT(dict != NULL, "Trying to dereference NULL Dict");
+
+	if (dict->old != NULL)
+	{
+		return dict->count + dict->old->count;
+	}
+
+	return dict->count;
 }
 
 EE_INLINE DictIter ee_dict_iter_new(const Dict* dict)
@@ -594,62 +992,94 @@ EE_INLINE DictConfig ee_dict_get_config(Dict* dict)
 	out.eq_fn      = dict->eq_fn;
 	out.key_cpy_fn = dict->key_cpy_fn;
 	out.val_cpy_fn = dict->val_cpy_fn;
+	out.grow       = dict->grow;
+	out.layout     = dict->layout;
 
 	return out;
 }
 
+EE_INLINE const Dict* _ee_dict_iter_table(const DictIter* iter, size_t* offset)
+{
+	const Dict* dict = iter->dict;
+
+	*offset = 0;
+
+	if (iter->it >= dict->cap && dict->old != NULL)
+	{
+		*offset = dict->cap;
+
+		return dict->old;
+	}
+
+	return dict;
+}
+
+EE_INLINE i32 _ee_dict_iter_switch(DictIter* iter, const Dict* table)
+{
+	if (table != iter->dict || iter->dict->old == NULL)
+	{
+		return EE_FALSE;
+	}
+
+	iter->it = iter->dict->cap;
+
+	return EE_TRUE;
+}
+
 EE_INLINE i32 ee_dict_iter_sp_next(DictIter* iter, u8* key_out, u8* val_out)
 {
 	EE_ASSERT(iter != NULL, "Trying to dereference NULL DictIter");
 	EE_ASSERT(key_out != NULL, "Trying to dereference NULL key");
 	EE_ASSERT(val_out != NULL, "Trying to dereference NULL value");
 
-	if (iter->it >= iter->dict->cap)
+	size_t offset = 0;
+	const Dict* table = _ee_dict_iter_table(iter, &offset);
+
+	if (iter->it - offset >= table->cap)
 	{
 		return EE_FALSE;
 	}
 
-	const u8* ctrls = (const u8*)iter->dict->ctrl.buffer;
-	size_t i = iter->it;
-	size_t high = ee_round_up_pow2(iter->it, EED_SIMD_BYTES);
+	const u8* ctrls = (const u8*)table->ctrl.buffer;
+	size_t i = iter->it - offset;
+	size_t high = ee_round_up_pow2(i, EED_SIMD_BYTES);
 
 	for (; i < high; ++i)
 	{
 		if (ctrls[i] & 0x80)
 			continue;
 
-		iter->dict->key_cpy_fn(key_out, ee_dict_key_at(iter->dict, i), iter->dict->key_len);
-		iter->dict->val_cpy_fn(val_out, ee_dict_val_at(iter->dict, i), iter->dict->val_len);
+		table->key_cpy_fn(key_out, ee_dict_key_at(table, i), table->key_len);
+		table->val_cpy_fn(val_out, ee_dict_val_at(table, i), table->val_len);
 
-		iter->it = i + 1;
+		iter->it = offset + i + 1;
 
 		return EE_TRUE;
 	}
 
-	eed_simd_i p_empty = eed_set1_epi8(EE_SLOT_EMPTY);
-	eed_simd_i p_deleted = eed_set1_epi8(EE_SLOT_DELETED);
-
-	for (; i < iter->dict->cap; i += EED_SIMD_BYTES)
+	for (; i < table->cap; i += EED_SIMD_BYTES)
 	{
-		eed_simd_i group = eed_load_si((const eed_simd_i*)&ctrls[i]);
-		eed_simd_i match = eed_or_si(eed_cmpeq_epi8(group, p_empty), eed_cmpeq_epi8(group, p_deleted));
-
-		i32 mask = (~eed_movemask_epi8(match)) & ((1u << EED_SIMD_BYTES) - 1);
+		eed_mask mask = ~eed_group_free(&ctrls[i]) & EED_GROUP_FULL_MASK;
 
 		if (mask)
 		{
-			i32 first = ee_first_bit_u32(mask);
+			i32 first = eed_mask_first(mask);
 			size_t pos = (size_t)first + i;
 
-			iter->dict->key_cpy_fn(key_out, ee_dict_key_at(iter->dict, i), iter->dict->key_len);
-			iter->dict->val_cpy_fn(val_out, ee_dict_val_at(iter->dict, i), iter->dict->val_len);
+			table->key_cpy_fn(key_out, ee_dict_key_at(table, pos), table->key_len);
+			table->val_cpy_fn(val_out, ee_dict_val_at(table, pos), table->val_len);
 
-			iter->it = pos + 1;
+			iter->it = offset + pos + 1;
 
 			return EE_TRUE;
 		}
 	}
 
+	if (_ee_dict_iter_switch(iter, table))
+	{
+		return ee_dict_iter_sp_next(iter, key_out, val_out);
+	}
+
 	return EE_FALSE;
 }
 
@@ -659,52 +1089,54 @@ EE_INLINE i32 ee_dict_iter_sp_next_ptr(DictIter* iter, u8** key_out, u8** val_ou
 	EE_ASSERT(key_out != NULL, "Trying to dereference NULL key");
 	EE_ASSERT(val_out != NULL, "Trying to dereference NULL value");
 
-	if (iter->it >= iter->dict->cap)
+	size_t offset = 0;
+	const Dict* table = _ee_dict_iter_table(iter, &offset);
+
+	if (iter->it - offset >= table->cap)
 	{
 		return EE_FALSE;
 	}
 
-	const u8* ctrls = (const u8*)iter->dict->ctrl.buffer;
-	size_t i = iter->it;
-	size_t high = ee_round_up_pow2(iter->it, EED_SIMD_BYTES);
+	const u8* ctrls = (const u8*)table->ctrl.buffer;
+	size_t i = iter->it - offset;
+	size_t high = ee_round_up_pow2(i, EED_SIMD_BYTES);
 
 	for (; i < high; ++i)
 	{
 		if (ctrls[i] & 0x80)
 			continue;
 
-		*key_out = ee_dict_key_at(iter->dict, i);
-		*val_out = ee_dict_val_at(iter->dict, i);
+		*key_out = ee_dict_key_at(table, i);
+		*val_out = ee_dict_val_at(table, i);
 
-		iter->it = i + 1;
+		iter->it = offset + i + 1;
 
 		return EE_TRUE;
 	}
 
-	eed_simd_i p_empty = eed_set1_epi8(EE_SLOT_EMPTY);
-	eed_simd_i p_deleted = eed_set1_epi8(EE_SLOT_DELETED);
-
-	for (; i < iter->dict->cap; i += EED_SIMD_BYTES)
+	for (; i < table->cap; i += EED_SIMD_BYTES)
 	{
-		eed_simd_i group = eed_load_si((const eed_simd_i*)&ctrls[i]);
-		eed_simd_i match = eed_or_si(eed_cmpeq_epi8(group, p_empty), eed_cmpeq_epi8(group, p_deleted));
-
-		i32 mask = (~eed_movemask_epi8(match)) & ((1u << EED_SIMD_BYTES) - 1);
+		eed_mask mask = ~eed_group_free(&ctrls[i]) & EED_GROUP_FULL_MASK;
 
 		if (mask)
 		{
-			i32 first = ee_first_bit_u32(mask);
+			i32 first = eed_mask_first(mask);
 			size_t pos = (size_t)first + i;
 
-			*key_out = ee_dict_key_at(iter->dict, pos);
-			*val_out = ee_dict_val_at(iter->dict, pos);
+			*key_out = ee_dict_key_at(table, pos);
+			*val_out = ee_dict_val_at(table, pos);
 
-			iter->it = pos + 1;
+			iter->it = offset + pos + 1;
 
 			return EE_TRUE;
 		}
 	}
 
+	if (_ee_dict_iter_switch(iter, table))
+	{
+		return ee_dict_iter_sp_next_ptr(iter, key_out, val_out);
+	}
+
 	return EE_FALSE;
 }
 
@@ -714,26 +1146,34 @@ EE_INLINE i32 ee_dict_iter_next(DictIter* iter, u8* key_out, u8* val_out)
 	EE_ASSERT(key_out != NULL, "Trying to dereference NULL key");
 	EE_ASSERT(val_out != NULL, "Trying to dereference NULL value");
 
-	if (iter->it >= iter->dict->cap)
+	size_t offset = 0;
+	const Dict* table = _ee_dict_iter_table(iter, &offset);
+
+	if (iter->it - offset >= table->cap)
 	{
 		return EE_FALSE;
 	}
 
-	const u8* ctrl = iter->dict->ctrl.buffer;
+	const u8* ctrl = table->ctrl.buffer;
 
-	for (size_t i = iter->it; i < iter->dict->cap; ++i)
+	for (size_t i = iter->it - offset; i < table->cap; ++i)
 	{
 		if (ctrl[i] & 0x80)
 			continue;
 
-		iter->dict->key_cpy_fn(key_out, ee_dict_key_at(iter->dict, i), iter->dict->key_len);
-		iter->dict->val_cpy_fn(val_out, ee_dict_val_at(iter->dict, i), iter->dict->val_len);
+		table->key_cpy_fn(key_out, ee_dict_key_at(table, i), table->key_len);
+		table->val_cpy_fn(val_out, ee_dict_val_at(table, i), table->val_len);
 
-		iter->it = i + 1;
+		iter->it = offset + i + 1;
 
 		return EE_TRUE;
 	}
 
+	if (_ee_dict_iter_switch(iter, table))
+	{
+		return ee_dict_iter_next(iter, key_out, val_out);
+	}
+
 	return EE_FALSE;
 }
 
@@ -743,151 +1183,433 @@ EE_INLINE i32 ee_dict_iter_next_ptr(DictIter* iter, u8** key_out, u8** val_out)
 	EE_ASSERT(key_out != NULL, "Trying to dereference NULL key");
 	EE_ASSERT(val_out != NULL, "Trying to dereference NULL value");
 
-	if (iter->it >= iter->dict->cap)
+	size_t offset = 0;
+	const Dict* table = _ee_dict_iter_table(iter, &offset);
+
+	if (iter->it - offset >= table->cap)
 	{
 		return EE_FALSE;
 	}
 
-	const u8* ctrl = iter->dict->ctrl.buffer;
+	const u8* ctrl = table->ctrl.buffer;
 
-	for (size_t i = iter->it; i < iter->dict->cap; ++i)
+	for (size_t i = iter->it - offset; i < table->cap; ++i)
 	{
 		if (ctrl[i] & 0x80)
 			continue;
 
-		*key_out = ee_dict_key_at(iter->dict, i);
-		*val_out = ee_dict_val_at(iter->dict, i);
+		*key_out = ee_dict_key_at(table, i);
+		*val_out = ee_dict_val_at(table, i);
 
-		iter->it = i + 1;
+		iter->it = offset + i + 1;
 
 		return EE_TRUE;
 	}
 
+	if (_ee_dict_iter_switch(iter, table))
+	{
+		return ee_dict_iter_next_ptr(iter, key_out, val_out);
+	}
+
 	return EE_FALSE;
 }
 
-EE_INLINE Dict ee_dict_new(size_t size, size_t key_len, size_t val_len, DictConfig config)
+EE_INLINE eed_mask _ee_dict_group_used(const Dict* table, size_t group)
 {
-	EE_ASSERT(key_len > 0, "Invalid key_len (%zu)", key_len);
-	EE_ASSERT(val_len > 0, "Invalid val_len (%zu)", val_len);
+	return ~eed_group_free(&table->ctrl.buffer[group]) & EED_GROUP_FULL_MASK;
+}
 
-	Dict out = { 0 };
+EE_INLINE DictScan ee_dict_scan_new(const Dict* dict)
+{
+	EE_ASSERT(dict != NULL, "Trying to scan NULL Dict");
 
-	if (size < EE_DICT_START_SIZE)
-	{
-		size = EE_DICT_START_SIZE;
-	}
+	DictScan out = { 0 };
 
-	if (config.allocator == NULL)
-	{
-		out.allocator.alloc_fn = ee_default_alloc;
-		out.allocator.realloc_fn = ee_default_realloc;
-		out.allocator.free_fn = ee_default_free;
-		out.allocator.context = NULL;
-	}
-	else
+	out.dict  = dict;
+	out.table = dict;
+	out.group = 0;
+	out.mask  = 0;
+
+	return out;
+}
+
+// Same order and invalidation rules as 'ee_dict_iter_next_ptr', 'val_out' may be NULL
+EE_INLINE i32 ee_dict_scan_next(DictScan* scan, u8** key_out, u8** val_out)
+{
+	EE_ASSERT(scan != NULL, "Trying to dereference NULL DictScan");
+	EE_ASSERT(key_out != NULL, "Trying to dereference NULL key");
+
+	while (scan->mask == 0)
 	{
-		memcpy(&out.allocator, config.allocator, sizeof(Allocator));
-	}
+		if (scan->group >= scan->table->cap)
+		{
+			if (scan->table != scan->dict || scan->dict->old == NULL)
+			{
+				return EE_FALSE;
+			}
 
-	EE_ASSERT(out.allocator.alloc_fn != NULL, "Trying to set NULL alloc callback");
-	EE_ASSERT(out.allocator.realloc_fn != NULL, "Trying to set NULL realloc callback");
-	EE_ASSERT(out.allocator.free_fn != NULL, "Trying to set NULL free callback");
+			scan->table = scan->dict->old;
+			scan->group = 0;
 
-	size_t cap = ee_next_pow_2(size);
+			continue;
+		}
 
-	out.key_len = key_len;
-	out.val_len = val_len;
+		scan->mask = _ee_dict_group_used(scan->table, scan->group);
+		scan->group += EE_GROUP_SIZE;
+	}
 
-	out.keys = ee_aligned_alloc(cap * out.key_len, EE_MAX_ALIGN, &out.allocator);
-	out.vals = ee_aligned_alloc(cap * out.val_len, EE_MAX_ALIGN, &out.allocator);
-	out.ctrl = ee_aligned_alloc(cap, EE_MAX_ALIGN, &out.allocator);
+	size_t pos = scan->group - EE_GROUP_SIZE + (size_t)eed_mask_first(scan->mask);
 
-	out.count = 0;
-	out.cap = cap;
-	out.mask = out.cap - 1;
-	out.th = ee_dict_th(out.cap);
-	
+	scan->mask &= scan->mask - 1;
+
+	*key_out = ee_dict_key_at(scan->table, pos);
+
+	if (val_out != NULL)
+		*val_out = ee_dict_val_at(scan->table, pos);
+
+	return EE_TRUE;
+}
+
+// Calls 'fn' for every entry, group at a time, returns the number of visited entries.
+// 'fn' may update values in place but must not insert or remove
+EE_INLINE size_t ee_dict_for_each(const Dict* dict, DictVisit fn, void* context)
+{
+	EE_ASSERT(dict != NULL, "Trying to walk NULL Dict");
+	EE_ASSERT(fn != NULL, "Trying to walk Dict with NULL visitor");
+
+	size_t visited = 0;
+
+	for (const Dict* table = dict; table != NULL; table = (table == dict) ? dict->old : NULL)
+	{
+		for (size_t group = 0; group < table->cap; group += EE_GROUP_SIZE)
+		{
+			eed_mask mask = _ee_dict_group_used(table, group);
+
+			while (mask)
+			{
+				size_t pos = group + (size_t)eed_mask_first(mask);
+
+				visited++;
+
+				if (!fn(ee_dict_key_at(table, pos), ee_dict_val_at(table, pos), context))
+				{
+					return visited;
+				}
+
+				mask &= mask - 1;
+			}
+		}
+	}
+
+	return visited;
+}
+
+EE_INLINE void _ee_dict_export_part(Array* out, const u8* base, size_t stride, size_t len, size_t group, eed_mask mask)
+{
+	u8* dst = &out->buffer[out->top];
+
+	// Split layout keeps a full group contiguous
+	if (mask == EED_GROUP_FULL_MASK && stride == len)
+	{
+		memcpy(dst, &base[group * stride], EE_GROUP_SIZE * len);
+		out->top += EE_GROUP_SIZE * len;
+
+		return;
+	}
+
+	// Constant sizes for the common widths so the copies are single moves instead of 'memcpy' calls
+	if (len == 8)
+	{
+		for (; mask; mask &= mask - 1, dst += 8)
+			memcpy(dst, &base[(group + (size_t)eed_mask_first(mask)) * stride], 8);
+	}
+	else if (len == 4)
+	{
+		for (; mask; mask &= mask - 1, dst += 4)
+			memcpy(dst, &base[(group + (size_t)eed_mask_first(mask)) * stride], 4);
+	}
+	else
+	{
+		for (; mask; mask &= mask - 1, dst += len)
+			memcpy(dst, &base[(group + (size_t)eed_mask_first(mask)) * stride], len);
+	}
+
+	out->top = (size_t)(dst - out->buffer);
+}
+
+// Appends every key to 'keys_out' and every value to 'vals_out' (either may be NULL) in iteration order,
+// both Arrays are reserved once up front. Returns the number of exported entries
+EE_INLINE size_t ee_dict_export(const Dict* dict, Array* keys_out, Array* vals_out)
+{
+	EE_ASSERT(dict != NULL, "Trying to export NULL Dict");
+	EE_ASSERT(keys_out == NULL || keys_out->elem_size == dict->key_len, "Keys Array elem_size (%zu) does not match key_len (%zu)", keys_out->elem_size, dict->key_len);
+	EE_ASSERT(vals_out == NULL || vals_out->elem_size == dict->val_len, "Values Array elem_size (%zu) does not match val_len (%zu)", vals_out->elem_size, dict->val_len);
+
+	size_t count = ee_dict_count(dict);
+
+	if (keys_out != NULL && keys_out->top + count * keys_out->elem_size > keys_out->cap)
+	{
+		ee_array_reserve(keys_out, ee_array_len(keys_out) + count);
+	}
+
+	if (vals_out != NULL && vals_out->top + count * vals_out->elem_size > vals_out->cap)
+	{
+		ee_array_reserve(vals_out, ee_array_len(vals_out) + count);
+	}
+
+	for (const Dict* table = dict; table != NULL; table = (table == dict) ? dict->old : NULL)
+	{
+		for (size_t group = 0; group < table->cap; group += EE_GROUP_SIZE)
+		{
+			eed_mask mask = _ee_dict_group_used(table, group);
+
+			if (mask == 0)
+				continue;
+
+			if (keys_out != NULL)
+				_ee_dict_export_part(keys_out, table->keys.buffer, table->key_stride, table->key_len, group, mask);
+
+			if (vals_out != NULL)
+				_ee_dict_export_part(vals_out, table->vals.buffer, table->val_stride, table->val_len, group, mask);
+		}
+	}
+
+	return count;
+}
+
+EE_INLINE void ee_cpy_none(u8* a_ptr, const u8* b_ptr, size_t len)
+{
+	EE_UNUSED(a_ptr);
+	EE_UNUSED(b_ptr);
+	EE_UNUSED(len);
+}
+
+EE_INLINE i32 _ee_dict_allocator_is_arena(const Allocator* allocator)
+{
+	return allocator->free_fn == eev_arena_free_fn || allocator->free_fn == ee_linked_arena_free_fn;
+}
+
+// EE_DICT_GROW_INPLACE block: keys, then values for the split layout, then ctrl
+EE_INLINE size_t _ee_dict_block_len(const Dict* dict, size_t cap)
+{
+	size_t val_stride = dict->layout == EE_DICT_LAYOUT_SPLIT ? dict->val_stride : 0;
+
+	return cap * (dict->key_stride + val_stride + 1);
+}
+
+// Points 'vals' and 'ctrl' into the block owned by 'keys', 'val_off' places the values of aliased layouts
+EE_INLINE void _ee_dict_block_bind(Dict* dict, size_t cap, size_t val_off)
+{
+	u8* block = dict->keys.buffer;
+	size_t keys_len = cap * dict->key_stride;
+
+	dict->vals = dict->keys;
+	dict->ctrl = dict->keys;
+
+	if (dict->layout == EE_DICT_LAYOUT_SPLIT && dict->val_stride > 0)
+	{
+		dict->vals.buffer = block + keys_len;
+		dict->vals.size   = cap * dict->val_stride;
+	}
+	else
+	{
+		dict->vals.buffer = block + val_off;
+	}
+
+	dict->ctrl.buffer = block + _ee_dict_block_len(dict, cap) - cap;
+	dict->ctrl.size   = cap;
+
+	dict->vals.base = NULL;
+	dict->ctrl.base = NULL;
+}
+
+EE_INLINE void _ee_dict_bind_fns(Dict* out, DictConfig config)
+{
 	if (config.hash_fn == NULL)
 	{
-		if (out.key_len == 4)
-			out.hash_fn = eed_hash_32;
-		else if (out.key_len == 8)
-			out.hash_fn = eed_hash_64;
-		else if (out.key_len == 16)
-			out.hash_fn = eed_hash_128;
-		else if (out.key_len == 32)
-			out.hash_fn = eed_hash_256;
+		if (out->key_len == 4)
+			out->hash_fn = eed_hash_32;
+		else if (out->key_len == 8)
+			out->hash_fn = eed_hash_64;
+		else if (out->key_len == 16)
+			out->hash_fn = eed_hash_128;
+		else if (out->key_len == 32)
+			out->hash_fn = eed_hash_256;
 		else
-			out.hash_fn = eed_hash;
+			out->hash_fn = eed_hash;
 	}
 	else
 	{
-		out.hash_fn = config.hash_fn;
+		out->hash_fn = config.hash_fn;
 	}
 
 	if (config.eq_fn == NULL)
 	{
-		if (out.key_len == 1)
-			out.eq_fn = ee_eq_safe_8;
-		else if (out.key_len == 2)
-			out.eq_fn = ee_eq_safe_16;
-		else if (out.key_len == 4)
-			out.eq_fn = ee_eq_safe_32;
-		else if (out.key_len == 8)
-			out.eq_fn = ee_eq_safe_64;
-#if EE_SIMD_EFFECTIVE_MAX_LEVEL >= EE_SIMD_LEVEL_SSE
-		else if (out.key_len == 16)
-			out.eq_fn = ee_eq_safe_128;
-#endif
-#if EE_SIMD_EFFECTIVE_MAX_LEVEL >= EE_SIMD_LEVEL_AVX
-		else if (out.key_len == 32)
-			out.eq_fn = ee_eq_safe_256;
-#endif
+		if (out->key_len == 1)
+			out->eq_fn = ee_eq_safe_8;
+		else if (out->key_len == 2)
+			out->eq_fn = ee_eq_safe_16;
+		else if (out->key_len == 4)
+			out->eq_fn = ee_eq_safe_32;
+		else if (out->key_len == 8)
+			out->eq_fn = ee_eq_safe_64;
+		else if (out->key_len == 16)
+			out->eq_fn = ee_simd_kernels()->eq_safe_128;
+		else if (out->key_len == 32)
+			out->eq_fn = ee_simd_kernels()->eq_safe_256;
 		else
-			out.eq_fn = ee_eq_def;
+			out->eq_fn = ee_eq_def;
 	}
 	else
 	{
-		out.eq_fn = config.eq_fn;
+		out->eq_fn = config.eq_fn;
 	}
 
 	if (config.key_cpy_fn == NULL)
 	{
-		if (out.key_len == 1)
-			out.key_cpy_fn = ee_cpy_8;
-		else if (out.key_len == 2)
-			out.key_cpy_fn = ee_cpy_16;
-		else if (out.key_len == 4)
-			out.key_cpy_fn = ee_cpy_32;
-		else if (out.key_len == 8)
-			out.key_cpy_fn = ee_cpy_64;
+		if (out->key_len == 1)
+			out->key_cpy_fn = ee_cpy_8;
+		else if (out->key_len == 2)
+			out->key_cpy_fn = ee_cpy_16;
+		else if (out->key_len == 4)
+			out->key_cpy_fn = ee_cpy_32;
+		else if (out->key_len == 8)
+			out->key_cpy_fn = ee_cpy_64;
 		else
-			out.key_cpy_fn = ee_cpy_def;
+			out->key_cpy_fn = ee_cpy_def;
 	}
 	else
 	{
-		out.key_cpy_fn = config.key_cpy_fn;
+		out->key_cpy_fn = config.key_cpy_fn;
 	}
 
 	if (config.val_cpy_fn == NULL)
 	{
-		if (out.val_len == 1)
-			out.val_cpy_fn = ee_cpy_8;
-		else if (out.val_len == 2)
-			out.val_cpy_fn = ee_cpy_16;
-		else if (out.val_len == 4)
-			out.val_cpy_fn = ee_cpy_32;
-		else if (out.val_len == 8)
-			out.val_cpy_fn = ee_cpy_64;
+		if (out->val_len == 0)
+			out->val_cpy_fn = ee_cpy_none;
+		else if (out->val_len == 1)
+			out->val_cpy_fn = ee_cpy_8;
+		else if (out->val_len == 2)
+			out->val_cpy_fn = ee_cpy_16;
+		else if (out->val_len == 4)
+			out->val_cpy_fn = ee_cpy_32;
+		else if (out->val_len == 8)
+			out->val_cpy_fn = ee_cpy_64;
 		else
-			out.val_cpy_fn = ee_cpy_def;
+			out->val_cpy_fn = ee_cpy_def;
+	}
+	else
+	{
+		out->val_cpy_fn = config.val_cpy_fn;
+	}
+}
+
+EE_INLINE Dict ee_dict_new(size_t size, size_t key_len, size_t val_len, DictConfig config)
+{
+	EE_ASSERT(key_len > 0, "Invalid key_len (%zu)", key_len);
+
+	Dict out = { 0 };
+
+	if (size < EE_DICT_START_SIZE)
+	{
+		size = EE_DICT_START_SIZE;
+	}
+
+	// A table can not be smaller than one probe group
+	if (size < EE_GROUP_SIZE)
+	{
+		size = EE_GROUP_SIZE;
+	}
+
+	if (config.allocator == NULL)
+	{
+		out.allocator.alloc_fn = ee_default_alloc;
+		out.allocator.realloc_fn = ee_default_realloc;
+		out.allocator.free_fn = ee_default_free;
+		out.allocator.context = NULL;
+	}
+	else
+	{
+		memcpy(&out.allocator, config.allocator, sizeof(Allocator));
+	}
+
+	EE_ASSERT(out.allocator.alloc_fn != NULL, "Trying to set NULL alloc callback");
+	EE_ASSERT(out.allocator.realloc_fn != NULL, "Trying to set NULL realloc callback");
+	EE_ASSERT(out.allocator.free_fn != NULL, "Trying to set NULL free callback");
+
+	size_t cap = ee_next_pow_2(size);
+
+	out.key_len = key_len;
+	out.val_len = val_len;
+	out.grow    = config.grow;
+	out.layout  = config.layout;
+
+	// Arena frees are no-ops, a full grow would strand every old table in the arena
+	if (out.grow == EE_DICT_GROW_FULL && _ee_dict_allocator_is_arena(&out.allocator))
+	{
+		out.grow = EE_DICT_GROW_INPLACE;
+	}
+
+	size_t val_off = 0;
+
+	if (val_len == 0)
+	{
+		// Set, value pointers of present keys are non-NULL but address zero bytes
+		out.layout     = EE_DICT_LAYOUT_SPLIT;
+		out.key_stride = key_len;
+		out.val_stride = 0;
+	}
+	else if (out.layout == EE_DICT_LAYOUT_INTERLEAVED)
+	{
+		// Natural alignment of each part is its lowest set bit, capped at 8
+		size_t key_align = ee_min_u64(key_len & (~key_len + 1), 8);
+		size_t val_align = ee_min_u64(val_len & (~val_len + 1), 8);
+		size_t slot_len;
+
+		val_off  = ee_round_up_pow2(key_len, val_align);
+		slot_len = ee_round_up_pow2(val_off + val_len, ee_max_u64(key_align, val_align));
+
+		out.key_stride = slot_len;
+		out.val_stride = slot_len;
+	}
+	else
+	{
+		out.key_stride = key_len;
+		out.val_stride = val_len;
+	}
+
+	if (out.grow == EE_DICT_GROW_INPLACE)
+	{
+		out.keys = ee_aligned_alloc(_ee_dict_block_len(&out, cap), ee_max_u64(EE_MAX_ALIGN, EE_GROUP_SIZE), &out.allocator);
+
+		_ee_dict_block_bind(&out, cap, val_off);
+	}
+	else if (val_len == 0 || out.layout == EE_DICT_LAYOUT_INTERLEAVED)
+	{
+		out.keys = ee_aligned_alloc(cap * out.key_stride, EE_MAX_ALIGN, &out.allocator);
+		out.vals = out.keys;
+
+		out.vals.buffer = out.keys.buffer + val_off;
+		out.vals.base   = NULL;
 	}
 	else
 	{
-		out.val_cpy_fn = config.val_cpy_fn;
+		out.keys = ee_aligned_alloc(cap * out.key_len, EE_MAX_ALIGN, &out.allocator);
+		out.vals = ee_aligned_alloc(cap * out.val_len, EE_MAX_ALIGN, &out.allocator);
+	}
+
+	if (out.grow != EE_DICT_GROW_INPLACE)
+	{
+		out.ctrl = ee_aligned_alloc(cap, ee_max_u64(EE_MAX_ALIGN, EE_GROUP_SIZE), &out.allocator);
 	}
 
+	out.count = 0;
+	out.cap = cap;
+	out.mask = out.cap - 1;
+	out.th = ee_dict_th(out.cap);
+	
+	_ee_dict_bind_fns(&out, config);
+
 #ifdef EE_DICT_TOMBS_REHASH
 	out.tombs = 0;
 	out.tombs_th = ee_tombs_th(out.cap);
@@ -901,30 +1623,47 @@ EE_INLINE Dict ee_dict_new(size_t size, size_t key_len, size_t val_len, DictConf
 	return out;
 }
 
+EE_INLINE void _ee_dict_free_buffers(Dict* dict)
+{
+	ee_aligned_free(&dict->keys, &dict->allocator);
+
+	if (dict->vals.base != NULL)
+		ee_aligned_free(&dict->vals, &dict->allocator);
+
+	// NULL when ctrl lives in the 'keys' block (EE_DICT_GROW_INPLACE)
+	if (dict->ctrl.base != NULL)
+		ee_aligned_free(&dict->ctrl, &dict->allocator);
+}
+
 EE_INLINE void ee_dict_free(Dict* dict)
 {
 	EE_ASSERT(dict != NULL, "Trying to free NULL Dict");
+	EE_ASSERT(dict->image == NULL, "Mapped Dict should be released with ee_dict_unmap");
 
-	ee_aligned_free(&dict->keys, &dict->allocator);
-	ee_aligned_free(&dict->vals, &dict->allocator);
-	ee_aligned_free(&dict->ctrl, &dict->allocator);
+	if (dict->old != NULL)
+	{
+		Dict* old = dict->old;
+
+		ee_dict_free(old);
+		dict->allocator.free_fn(&dict->allocator, old);
+	}
+
+	_ee_dict_free_buffers(dict);
 
 	memset(dict, 0, sizeof(Dict));
 }
 
-EE_INLINE i32 ee_dict_insert(Dict* dict, const u8* key, const u8* val)
+EE_INLINE i32 ee_dict_insert_hash(Dict* dict, const u8* key, const u8* val, u64 hash)
 {
 	EE_ASSERT(dict != NULL, "Trying to dereference NULL Dict");
 	EE_ASSERT(key != NULL, "Trying to dereference NULL key");
-	EE_ASSERT(val != NULL, "Trying to dereference NULL value");
+	EE_ASSERT(val != NULL || dict->val_len == 0, "Trying to dereference NULL value");
+	EE_ASSERT(dict->image == NULL, "Trying to insert into a read-only mapped Dict");
 
-	u64 hash = dict->hash_fn(key, dict->key_len);
 	u64 base_index = (hash >> 7) & dict->mask;
 	u8  hash_sign = hash & 0x7F;
 
-	eed_simd_i hash_sign_wide = eed_set1_epi8(hash_sign);
-	eed_simd_i empty_wide = eed_set1_epi8(EE_SLOT_EMPTY);
-	eed_simd_i del_wide = eed_set1_epi8(EE_SLOT_DELETED);
+	EED_STAT(dict->stats.inserts++);
 
 	size_t probe_step = 0;
 	size_t first_deleted = (size_t)-1;
@@ -940,29 +1679,34 @@ EE_INLINE i32 ee_dict_insert(Dict* dict, const u8* key, const u8* val)
 		eed_prefetch((const char*)&dict->ctrl.buffer[next_group_index], EED_SIMD_PREFETCH_T0);
 		eed_prefetch((const char*)ee_dict_key_at(dict, next_group_index), EED_SIMD_PREFETCH_T0);
 
-		eed_simd_i group = eed_load_si((eed_simd_i*)&dict->ctrl.buffer[group_index]);
+		const u8* group = &dict->ctrl.buffer[group_index];
 
-		i32 match_mask = eed_movemask_epi8(eed_cmpeq_epi8(group, hash_sign_wide));
+		eed_mask match_mask = eed_group_match(group, hash_sign);
 		
 		while (match_mask)
 		{
-			i32 first = ee_first_bit_u32(match_mask);
-		
+			i32 first = eed_mask_first(match_mask);
+
+			EED_STAT(dict->stats.tag_hits++);
+
 			if (dict->eq_fn(ee_dict_key_at(dict, group_index + first), key, dict->key_len))
 			{
 				dict->val_cpy_fn(ee_dict_val_at(dict, group_index + first), val, dict->val_len);
-			
+				EED_STAT(_ee_dict_stats_probe(dict->stats.probe_insert, probe_step));
+
 				return EE_TRUE;
 			}
-			
+
+			EED_STAT(dict->stats.tag_false++);
+
 			match_mask &= match_mask - 1;
 		}
 
-		i32 empty_mask = eed_movemask_epi8(eed_cmpeq_epi8(group, empty_wide));
+		eed_mask empty_mask = eed_group_match(group, EE_SLOT_EMPTY);
 
 		if (empty_mask)
 		{
-			size_t place = (first_deleted != (size_t)-1) ? first_deleted : (group_index + (size_t)ee_first_bit_u32(empty_mask));
+			size_t place = (first_deleted != (size_t)-1) ? first_deleted : (group_index + (size_t)eed_mask_first(empty_mask));
 
 			dict->key_cpy_fn(ee_dict_key_at(dict, place), key, dict->key_len);
 			dict->val_cpy_fn(ee_dict_val_at(dict, place), val, dict->val_len);
@@ -970,14 +1714,16 @@ EE_INLINE i32 ee_dict_insert(Dict* dict, const u8* key, const u8* val)
 			dict->ctrl.buffer[place] = hash_sign;
 			dict->count++;
 
+			EED_STAT(_ee_dict_stats_probe(dict->stats.probe_insert, probe_step));
+
 			return EE_TRUE;
 		}
 
-		i32 deleted_mask = eed_movemask_epi8(eed_cmpeq_epi8(group, del_wide));
+		eed_mask deleted_mask = eed_group_match(group, EE_SLOT_DELETED);
 		
 		if (deleted_mask && first_deleted == (size_t)-1)
 		{
-			first_deleted = group_index + (size_t)ee_first_bit_u32(deleted_mask);
+			first_deleted = group_index + (size_t)eed_mask_first(deleted_mask);
 		}
 
 		probe_step = next_probe_step;
@@ -994,107 +1740,351 @@ EE_INLINE i32 ee_dict_insert(Dict* dict, const u8* key, const u8* val)
 		dict->ctrl.buffer[place] = hash_sign;
 		dict->count++;
 
+		EED_STAT(_ee_dict_stats_probe(dict->stats.probe_insert, probe_step));
+
 		return EE_TRUE;
 	}
 
 	return EE_FALSE;
 }
 
-EE_INLINE void ee_dict_grow(Dict* dict, size_t new_cap)
+EE_INLINE i32 ee_dict_insert(Dict* dict, const u8* key, const u8* val)
 {
-	EE_ASSERT(dict != NULL, "Trying to insert to NULL Dict");
+	EE_ASSERT(dict != NULL, "Trying to dereference NULL Dict");
+	EE_ASSERT(key != NULL, "Trying to dereference NULL key");
 
-	DictConfig config = ee_dict_get_config(dict);
-	Dict out = ee_dict_new(dict->cap * 2, dict->key_len, dict->val_len, config);
+	return ee_dict_insert_hash(dict, key, val, dict->hash_fn(key, dict->key_len));
+}
 
-	for (size_t i = 0; i < dict->cap; ++i)
+EE_INLINE void ee_dict_migrate(Dict* dict, size_t groups)
+{
+	EE_ASSERT(dict != NULL, "Trying to migrate NULL Dict");
+
+	Dict* old = dict->old;
+
+	if (old == NULL)
 	{
-		if (dict->ctrl.buffer[i] & 0x80)
+		return;
+	}
+
+#ifdef EE_DICT_STATS
+	u64 stats_start = ee_monotonic_ns();
+#endif
+
+	size_t left = (old->cap - dict->migrate_pos) / EE_GROUP_SIZE;
+	size_t high = dict->migrate_pos + ee_min_u64(groups, left) * EE_GROUP_SIZE;
+
+	for (size_t i = dict->migrate_pos; i < high; ++i)
+	{
+		if (old->ctrl.buffer[i] & 0x80)
 			continue;
 
-		ee_dict_insert(&out, ee_dict_key_at(dict, i), ee_dict_val_at(dict, i));
+		ee_dict_insert(dict, ee_dict_key_at(old, i), ee_dict_val_at(old, i));
+
+		old->ctrl.buffer[i] = EE_SLOT_DELETED;
+		old->count--;
 	}
 
-	ee_aligned_free(&dict->keys, &dict->allocator);
-	ee_aligned_free(&dict->vals, &dict->allocator);
-	ee_aligned_free(&dict->ctrl, &dict->allocator);
+	dict->migrate_pos = high;
 
-	*dict = out;
+	EED_STAT(dict->stats.migrations++);
+	EED_STAT(dict->stats.migrate_sec += _ee_dict_stats_since(stats_start));
+
+	if (dict->migrate_pos >= old->cap)
+	{
+		// Lookups and removes that fell through to the old table were counted there
+		EED_STAT(_ee_dict_stats_merge(&dict->stats, &old->stats));
+
+		ee_dict_free(old);
+		dict->allocator.free_fn(&dict->allocator, old);
+
+		dict->old = NULL;
+		dict->migrate_pos = 0;
+	}
 }
 
-EE_INLINE void ee_dict_rehash(Dict* dict)
+EE_INLINE void _ee_dict_rehash_in_place(Dict* dict);
+
+// Extends the block with 'realloc_fn' (an arena does that in place when the table is on top of it),
+// moves the ctrl and value regions up to their new offsets and reinserts the entries in place
+EE_INLINE void _ee_dict_grow_in_place(Dict* dict, size_t new_cap)
 {
-	EE_ASSERT(dict != NULL, "Trying to insert to NULL Dict");
+	size_t cap     = dict->cap;
+	size_t align   = dict->keys.align;
+	size_t old_len = _ee_dict_block_len(dict, cap);
+	size_t new_len = _ee_dict_block_len(dict, new_cap);
+	size_t val_off = (size_t)(dict->vals.buffer - dict->keys.buffer);
+	size_t shift   = (size_t)(dict->keys.buffer - (u8*)dict->keys.base);
 
-	DictConfig config = ee_dict_get_config(dict);
-	Dict out = ee_dict_new(dict->cap, dict->key_len, dict->val_len, config);
+	u8* base = (u8*)dict->allocator.realloc_fn(&dict->allocator, dict->keys.base, old_len + align - 1, new_len + align - 1);
 
-	for (size_t i = 0; i < dict->cap; ++i)
+	EE_ASSERT(base != NULL, "Unable to reallocate (%zu) bytes for Dict grow", new_len + align - 1);
+
+	u8* block = (u8*)(((uintptr_t)base + (align - 1)) & ~(uintptr_t)(align - 1));
+
+	// A moved allocation may come back with a different alignment padding
+	if (block != base + shift)
 	{
-		if (dict->ctrl.buffer[i] & 0x80)
-			continue;
+		memmove(block, base + shift, old_len);
+	}
 
-		ee_dict_insert(&out, ee_dict_key_at(dict, i), ee_dict_val_at(dict, i));
+	// Top region first, every region moves up and the values may overlap the old ctrl
+	memmove(block + new_len - new_cap, block + old_len - cap, cap);
+
+	if (dict->layout == EE_DICT_LAYOUT_SPLIT && dict->val_stride > 0)
+	{
+		memmove(block + new_cap * dict->key_stride, block + cap * dict->key_stride, cap * dict->val_stride);
 	}
 
-	ee_aligned_free(&dict->keys, &dict->allocator);
-	ee_aligned_free(&dict->vals, &dict->allocator);
-	ee_aligned_free(&dict->ctrl, &dict->allocator);
+	memset(block + new_len - new_cap + cap, EE_SLOT_EMPTY, new_cap - cap);
 
-	*dict = out;
+	dict->keys.base   = base;
+	dict->keys.buffer = block;
+	dict->keys.size   = new_len;
+
+	_ee_dict_block_bind(dict, new_cap, val_off);
+
+	dict->cap  = new_cap;
+	dict->mask = new_cap - 1;
+	dict->th   = ee_dict_th(new_cap);
+
+	#ifdef EE_DICT_TOMBS_REHASH
+	dict->tombs_th = ee_tombs_th(new_cap);
+	#endif
+
+	_ee_dict_rehash_in_place(dict);
 }
 
-EE_INLINE i32 ee_dict_set(Dict* dict, const u8* key, const u8* val)
+EE_INLINE void ee_dict_grow(Dict* dict, size_t new_cap)
 {
-	if (dict->count + 1 > dict->th)
+	EE_ASSERT(dict != NULL, "Trying to insert to NULL Dict");
+
+#ifdef EE_DICT_STATS
+	u64 stats_start = ee_monotonic_ns();
+#endif
+
+	if (dict->old != NULL)
 	{
-		ee_dict_grow(dict, 2 * dict->cap);
+		ee_dict_migrate(dict, (size_t)-1);
 	}
 
-	i32 result = ee_dict_insert(dict, key, val);
+	if (dict->grow == EE_DICT_GROW_INCREMENTAL)
+	{
+		Dict* old = (Dict*)dict->allocator.alloc_fn(&dict->allocator, sizeof(Dict));
 
-	return result;
-}
+		EE_ASSERT(old != NULL, "Unable to allocate (%zu) bytes for migrating Dict", sizeof(Dict));
 
-EE_INLINE i32 ee_dict_remove(Dict* dict, const u8* key)
-{
-	EE_ASSERT(dict != NULL, "Trying to dereference NULL Dict");
-	EE_ASSERT(key != NULL, "Trying to dereference NULL key");
+		*old = *dict;
+		old->grow = EE_DICT_GROW_FULL;
 
-	u64 hash = dict->hash_fn(key, dict->key_len);
-	u64 base_index = (hash >> 7) & dict->mask;
-	u8  hash_sign = hash & 0x7F;
+		#ifdef EE_DICT_TOMBS_REHASH
+		old->tombs_th = (size_t)-1;
+		#endif
 
-	eed_simd_i hash_sign_wide = eed_set1_epi8(hash_sign);
-	eed_simd_i empty_wide = eed_set1_epi8(EE_SLOT_EMPTY);
+		DictConfig config = ee_dict_get_config(dict);
+		Dict out = ee_dict_new(new_cap, dict->key_len, dict->val_len, config);
 
-	size_t probe_step = 0;
+		out.old = old;
+		out.migrate_pos = 0;
 
-	while (probe_step < dict->cap)
-	{
-		size_t group_index = base_index & EE_GROUP_MASK;
+		#ifdef EE_DICT_STATS
+		memset(&old->stats, 0, sizeof(old->stats));
 
-		size_t next_probe_step = probe_step + 1;
-		size_t next_base_index = (base_index + EE_GROUP_SIZE * next_probe_step) & dict->mask;
-		size_t next_group_index = next_base_index & EE_GROUP_MASK;
+		out.stats = dict->stats;
+		out.stats.grows++;
+		out.stats.grow_sec += _ee_dict_stats_since(stats_start);
+		#endif
 
-		eed_prefetch((const char*)&dict->ctrl.buffer[next_group_index], EED_SIMD_PREFETCH_T0);
-		eed_prefetch((const char*)ee_dict_key_at(dict, next_group_index), EED_SIMD_PREFETCH_T0);
+		*dict = out;
 
-		eed_simd_i group = eed_load_si((eed_simd_i*)&dict->ctrl.buffer[group_index]);
-		eed_simd_i match = eed_cmpeq_epi8(group, hash_sign_wide);
+		return;
+	}
 
-		i32 match_mask = eed_movemask_epi8(match);
+	if (dict->grow == EE_DICT_GROW_INPLACE)
+	{
+		_ee_dict_grow_in_place(dict, ee_next_pow_2(new_cap));
 
-		while (match_mask)
-		{
-			i32 first = ee_first_bit_u32(match_mask);
+		EED_STAT(dict->stats.grows++);
+		EED_STAT(dict->stats.grow_sec += _ee_dict_stats_since(stats_start));
+
+		return;
+	}
+
+	DictConfig config = ee_dict_get_config(dict);
+	Dict out = ee_dict_new(new_cap, dict->key_len, dict->val_len, config);
+
+	for (size_t i = 0; i < dict->cap; ++i)
+	{
+		if (dict->ctrl.buffer[i] & 0x80)
+			continue;
+
+		ee_dict_insert(&out, ee_dict_key_at(dict, i), ee_dict_val_at(dict, i));
+	}
+
+	#ifdef EE_DICT_STATS
+	out.stats = dict->stats;
+	out.stats.grows++;
+	out.stats.grow_sec += _ee_dict_stats_since(stats_start);
+	#endif
+
+	_ee_dict_free_buffers(dict);
+
+	*dict = out;
+}
+
+EE_INLINE size_t _ee_dict_first_free(const Dict* dict, u64 hash)
+{
+	u64 base_index = (hash >> 7) & dict->mask;
+	size_t probe_step = 0;
+
+	while (probe_step < dict->cap)
+	{
+		size_t group_index = base_index & EE_GROUP_MASK;
+
+		const u8* group = &dict->ctrl.buffer[group_index];
+
+		eed_mask free_mask = eed_group_free(group);
+
+		if (free_mask)
+		{
+			return group_index + (size_t)eed_mask_first(free_mask);
+		}
+
+		probe_step++;
+		base_index = (base_index + EE_GROUP_SIZE * probe_step) & dict->mask;
+	}
+
+	return (size_t)-1;
+}
+
+// Purge tombstones in place: every live slot is marked as DELETED (pending) and every tombstone
+// becomes EMPTY, then each pending slot is either kept, moved into an EMPTY slot or swapped with
+// another pending slot that sits earlier on its probe sequence. Entries may sit anywhere, so this also
+// places the entries of a table whose capacity just changed under them
+EE_INLINE void _ee_dict_rehash_in_place(Dict* dict)
+{
+	u8* ctrl = dict->ctrl.buffer;
+	u8* temp = (u8*)EE_ALLOCA(dict->key_len + dict->val_len);
+
+	EE_ASSERT(temp != NULL, "Unable to allocate (%zu) on stack", dict->key_len + dict->val_len);
+
+	for (size_t i = 0; i < dict->cap; ++i)
+	{
+		ctrl[i] = (ctrl[i] & 0x80) ? EE_SLOT_EMPTY : EE_SLOT_DELETED;
+	}
+
+	size_t i = 0;
+
+	while (i < dict->cap)
+	{
+		if (ctrl[i] != EE_SLOT_DELETED)
+		{
+			i++;
+			continue;
+		}
+
+		u64 hash = dict->hash_fn(ee_dict_key_at(dict, i), dict->key_len);
+		u8  hash_sign = hash & 0x7F;
+		size_t target = _ee_dict_first_free(dict, hash);
+
+		EE_ASSERT(target != (size_t)-1, "Dict has no free slot during rehash");
+
+		if ((target & EE_GROUP_MASK) == (i & EE_GROUP_MASK))
+		{
+			ctrl[i] = hash_sign;
+			i++;
+		}
+		else if (ctrl[target] == EE_SLOT_EMPTY)
+		{
+			dict->key_cpy_fn(ee_dict_key_at(dict, target), ee_dict_key_at(dict, i), dict->key_len);
+			dict->val_cpy_fn(ee_dict_val_at(dict, target), ee_dict_val_at(dict, i), dict->val_len);
+
+			ctrl[target] = hash_sign;
+			ctrl[i] = EE_SLOT_EMPTY;
+			i++;
+		}
+		else
+		{
+			memcpy(temp, ee_dict_key_at(dict, target), dict->key_len);
+			memcpy(&temp[dict->key_len], ee_dict_val_at(dict, target), dict->val_len);
+
+			memcpy(ee_dict_key_at(dict, target), ee_dict_key_at(dict, i), dict->key_len);
+			memcpy(ee_dict_val_at(dict, target), ee_dict_val_at(dict, i), dict->val_len);
+
+			memcpy(ee_dict_key_at(dict, i), temp, dict->key_len);
+			memcpy(ee_dict_val_at(dict, i), &temp[dict->key_len], dict->val_len);
+
+			ctrl[target] = hash_sign;
+		}
+	}
+
+	EE_FREEA(temp);
+
+	#ifdef EE_DICT_TOMBS_REHASH
+	dict->tombs = 0;
+	#endif
+}
+
+EE_INLINE void ee_dict_rehash(Dict* dict)
+{
+	EE_ASSERT(dict != NULL, "Trying to insert to NULL Dict");
+
+#ifdef EE_DICT_STATS
+	u64 stats_start = ee_monotonic_ns();
+#endif
+
+	_ee_dict_rehash_in_place(dict);
+
+	EED_STAT(dict->stats.rehashes++);
+	EED_STAT(dict->stats.rehash_sec += _ee_dict_stats_since(stats_start));
+}
+
+EE_INLINE i32 ee_dict_remove(Dict* dict, const u8* key)
+{
+	EE_ASSERT(dict != NULL, "Trying to dereference NULL Dict");
+	EE_ASSERT(key != NULL, "Trying to dereference NULL key");
+	EE_ASSERT(dict->image == NULL, "Trying to remove from a read-only mapped Dict");
+
+	if (dict->old != NULL)
+	{
+		ee_dict_migrate(dict, EE_DICT_MIGRATE_GROUPS);
+	}
+
+	u64 hash = dict->hash_fn(key, dict->key_len);
+	u64 base_index = (hash >> 7) & dict->mask;
+	u8  hash_sign = hash & 0x7F;
+
+	EED_STAT(dict->stats.removes++);
+
+	size_t probe_step = 0;
+
+	while (probe_step < dict->cap)
+	{
+		size_t group_index = base_index & EE_GROUP_MASK;
+
+		size_t next_probe_step = probe_step + 1;
+		size_t next_base_index = (base_index + EE_GROUP_SIZE * next_probe_step) & dict->mask;
+		size_t next_group_index = next_base_index & EE_GROUP_MASK;
+
+		eed_prefetch((const char*)&dict->ctrl.buffer[next_group_index], EED_SIMD_PREFETCH_T0);
+		eed_prefetch((const char*)ee_dict_key_at(dict, next_group_index), EED_SIMD_PREFETCH_T0);
+
+		const u8* group = &dict->ctrl.buffer[group_index];
+		eed_mask match_mask = eed_group_match(group, hash_sign);
+
+		while (match_mask)
+		{
+			i32 first = eed_mask_first(match_mask);
+
+			EED_STAT(dict->stats.tag_hits++);
 
 			if (dict->eq_fn(ee_dict_key_at(dict, group_index + first), key, dict->key_len))
 			{
 				dict->ctrl.buffer[group_index + first] = EE_SLOT_DELETED;
 				dict->count--;
 
+				EED_STAT(_ee_dict_stats_probe(dict->stats.probe_lookup, probe_step));
+
 				#ifdef EE_DICT_TOMBS_REHASH
 				dict->tombs++;
 
@@ -1107,36 +2097,62 @@ EE_INLINE i32 ee_dict_remove(Dict* dict, const u8* key)
 				return EE_TRUE;
 			}
 
+			EED_STAT(dict->stats.tag_false++);
+
 			match_mask &= match_mask - 1;
 		}
 
-		eed_simd_i empty = eed_cmpeq_epi8(group, empty_wide);
-
-		i32 empty_mask = eed_movemask_epi8(empty);
+		eed_mask empty_mask = eed_group_match(group, EE_SLOT_EMPTY);
 
 		if (empty_mask)
 		{
-			return EE_FALSE;
+			EED_STAT(_ee_dict_stats_probe(dict->stats.probe_lookup, probe_step));
+			break;
 		}
 
 		probe_step = next_probe_step;
 		base_index = next_base_index;
 	}
 
+	if (dict->old != NULL)
+	{
+		return ee_dict_remove(dict->old, key);
+	}
+
 	return EE_FALSE;
 }
 
-EE_INLINE u8* ee_dict_at(const Dict* dict, const u8* key)
+EE_INLINE i32 ee_dict_set(Dict* dict, const u8* key, const u8* val)
+{
+	if (dict->old != NULL)
+	{
+		ee_dict_migrate(dict, EE_DICT_MIGRATE_GROUPS);
+	}
+
+	if (ee_dict_count(dict) + 1 > dict->th)
+	{
+		ee_dict_grow(dict, 2 * dict->cap);
+	}
+
+	if (dict->old != NULL)
+	{
+		ee_dict_remove(dict->old, key);
+	}
+
+	i32 result = ee_dict_insert(dict, key, val);
+
+	return result;
+}
+
+EE_INLINE u8* ee_dict_at_hash(const Dict* dict, const u8* key, u64 hash)
 {
 	EE_ASSERT(dict != NULL, "Trying to dereference NULL Dict");
 	EE_ASSERT(key != NULL, "Trying to dereference NULL key");
 
-	u64 hash = dict->hash_fn(key, dict->key_len);
 	u64 base_index = (hash >> 7) & dict->mask;
 	u8  hash_sign = hash & 0x7F;
 
-	eed_simd_i hash_sign_wide = eed_set1_epi8(hash_sign);
-	eed_simd_i empty_wide = eed_set1_epi8(EE_SLOT_EMPTY);
+	EED_STAT(((Dict*)dict)->stats.lookups++);
 
 	size_t probe_step = 0;
 
@@ -1151,39 +2167,55 @@ EE_INLINE u8* ee_dict_at(const Dict* dict, const u8* key)
 		eed_prefetch((const char*)&dict->ctrl.buffer[next_group_index], EED_SIMD_PREFETCH_T0);
 		eed_prefetch((const char*)ee_dict_key_at(dict, next_group_index), EED_SIMD_PREFETCH_T0);
 
-		eed_simd_i group = eed_load_si((eed_simd_i*)&dict->ctrl.buffer[group_index]);
-		eed_simd_i match = eed_cmpeq_epi8(group, hash_sign_wide);
-
-		i32 match_mask = eed_movemask_epi8(match);
+		const u8* group = &dict->ctrl.buffer[group_index];
+		eed_mask match_mask = eed_group_match(group, hash_sign);
 		
 		while (match_mask)
 		{
-			i32 first = ee_first_bit_u32(match_mask);
+			i32 first = eed_mask_first(match_mask);
+
+			EED_STAT(((Dict*)dict)->stats.tag_hits++);
 
 			if (dict->eq_fn(ee_dict_key_at(dict, group_index + first), key, dict->key_len))
 			{
+				EED_STAT(_ee_dict_stats_probe(((Dict*)dict)->stats.probe_lookup, probe_step));
+
 				return ee_dict_val_at(dict, group_index + first);
 			}
 
+			EED_STAT(((Dict*)dict)->stats.tag_false++);
+
 			match_mask &= match_mask - 1;
 		}
 
-		eed_simd_i empty = eed_cmpeq_epi8(group, empty_wide);
-
-		i32 empty_mask = eed_movemask_epi8(empty);
+		eed_mask empty_mask = eed_group_match(group, EE_SLOT_EMPTY);
 
 		if (empty_mask)
 		{
-			return NULL;
+			EED_STAT(_ee_dict_stats_probe(((Dict*)dict)->stats.probe_lookup, probe_step));
+			break;
 		}
 
 		probe_step = next_probe_step;
 		base_index = next_base_index;
 	}
 
+	if (dict->old != NULL)
+	{
+		return ee_dict_at_hash(dict->old, key, hash);
+	}
+
 	return NULL;
 }
 
+EE_INLINE u8* ee_dict_at(const Dict* dict, const u8* key)
+{
+	EE_ASSERT(dict != NULL, "Trying to dereference NULL Dict");
+	EE_ASSERT(key != NULL, "Trying to dereference NULL key");
+
+	return ee_dict_at_hash(dict, key, dict->hash_fn(key, dict->key_len));
+}
+
 EE_INLINE int ee_dict_contains(const Dict* dict, const u8* key)
 {
 	EE_ASSERT(dict != NULL, "Trying to check NULL Dict");
@@ -1194,13 +2226,571 @@ EE_INLINE int ee_dict_contains(const Dict* dict, const u8* key)
 	return val != NULL;
 }
 
-EE_INLINE size_t ee_dict_count(const Dict* dict)
+// Hashes 'n' packed keys with the Dict hash, the shipped fixed-width hashes go through their bulk kernels.
+// Matching is by function address, so a Dict created in another translation unit takes the scalar loop
+EE_INLINE void ee_dict_hash_many(const Dict* dict, const u8* keys, size_t n, u64* out)
 {
 	EE_ASSERT(dict != NULL, "Trying to dereference NULL Dict");
 
-	return dict->count;
+	DictHash fn = dict->hash_fn;
+	size_t len = dict->key_len;
+
+	if (len == sizeof(u32) && (fn == ee_hash_u32_fast || fn == ee_hash_u32_safe))
+		ee_hash_u32_many(keys, n, out);
+	else if (len == sizeof(u32) && (fn == ee_hash_mm_u32_fast || fn == ee_hash_mm_u32_safe))
+		ee_hash_mm_u32_many(keys, n, out);
+	else if (len == sizeof(u64) && (fn == ee_hash_u64_fast || fn == ee_hash_u64_safe))
+		ee_hash_u64_many(keys, n, out);
+	else if (len == sizeof(u64) && (fn == ee_hash_mm_u64_fast || fn == ee_hash_mm_u64_safe))
+		ee_hash_mm_u64_many(keys, n, out);
+	else if (len == 2 * sizeof(u64) && (fn == ee_hash_u128_fast || fn == ee_hash_u128_safe))
+		ee_hash_u128_many(keys, n, out);
+	else if (len == 4 * sizeof(u64) && (fn == ee_hash_u256_fast || fn == ee_hash_u256_safe))
+		ee_hash_u256_many(keys, n, out);
+	else
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			out[i] = fn(&keys[i * len], len);
+		}
+	}
+}
+
+EE_INLINE size_t ee_dict_at_batch(const Dict* dict, const u8* keys, size_t n, u8** out_ptrs)
+{
+	EE_ASSERT(dict != NULL, "Trying to dereference NULL Dict");
+	EE_ASSERT(keys != NULL, "Trying to dereference NULL keys");
+	EE_ASSERT(out_ptrs != NULL, "Trying to dereference NULL output buffer");
+
+	u64 hashes[EE_DICT_BATCH_SIZE];
+	eed_mask match_masks[EE_DICT_BATCH_SIZE];
+	eed_mask empty_masks[EE_DICT_BATCH_SIZE];
+
+	size_t found = 0;
+
+	for (size_t low = 0; low < n; low += EE_DICT_BATCH_SIZE)
+	{
+		size_t count = ee_min_u64(n - low, EE_DICT_BATCH_SIZE);
+		const u8* batch = &keys[low * dict->key_len];
+
+		// Hash the whole batch first so the ctrl loads of all keys are in flight at once
+		ee_dict_hash_many(dict, batch, count, hashes);
+
+		for (size_t j = 0; j < count; ++j)
+		{
+			size_t group_index = ((hashes[j] >> 7) & dict->mask) & EE_GROUP_MASK;
+
+			eed_prefetch((const char*)&dict->ctrl.buffer[group_index], EED_SIMD_PREFETCH_T0);
+			eed_prefetch((const char*)ee_dict_key_at(dict, group_index), EED_SIMD_PREFETCH_T0);
+		}
+
+		// Match the tags and pull in the first candidate key and value
+		for (size_t j = 0; j < count; ++j)
+		{
+			size_t group_index = ((hashes[j] >> 7) & dict->mask) & EE_GROUP_MASK;
+
+			const u8* group = &dict->ctrl.buffer[group_index];
+
+			match_masks[j] = eed_group_match(group, (u8)(hashes[j] & 0x7F));
+			empty_masks[j] = eed_group_match(group, EE_SLOT_EMPTY);
+
+			if (match_masks[j])
+			{
+				size_t first = group_index + (size_t)eed_mask_first(match_masks[j]);
+
+				eed_prefetch((const char*)ee_dict_key_at(dict, first), EED_SIMD_PREFETCH_T0);
+				eed_prefetch((const char*)ee_dict_val_at(dict, first), EED_SIMD_PREFETCH_T0);
+			}
+		}
+
+		// Resolve the probes, only keys whose first group is full fall back to the scalar path
+		for (size_t j = 0; j < count; ++j)
+		{
+			const u8* key = &batch[j * dict->key_len];
+			size_t group_index = ((hashes[j] >> 7) & dict->mask) & EE_GROUP_MASK;
+			eed_mask match_mask = match_masks[j];
+			u8* out = NULL;
+
+			while (match_mask)
+			{
+				i32 first = eed_mask_first(match_mask);
+
+				EED_STAT(((Dict*)dict)->stats.tag_hits++);
+
+				if (dict->eq_fn(ee_dict_key_at(dict, group_index + first), key, dict->key_len))
+				{
+					out = ee_dict_val_at(dict, group_index + first);
+					break;
+				}
+
+				EED_STAT(((Dict*)dict)->stats.tag_false++);
+
+				match_mask &= match_mask - 1;
+			}
+
+			// The full probe reuses the batch hash, the key is not hashed twice
+			if (out == NULL && (empty_masks[j] == 0 || dict->old != NULL))
+			{
+				out = ee_dict_at_hash(dict, key, hashes[j]);
+			}
+			else
+			{
+				EED_STAT(((Dict*)dict)->stats.lookups++);
+				EED_STAT(_ee_dict_stats_probe(((Dict*)dict)->stats.probe_lookup, 0));
+			}
+
+			out_ptrs[low + j] = out;
+			found += (out != NULL);
+		}
+	}
+
+	return found;
 }
 
+EE_INLINE size_t ee_dict_contains_batch(const Dict* dict, const u8* keys, size_t n, u8* out_flags)
+{
+	EE_ASSERT(dict != NULL, "Trying to check NULL Dict");
+	EE_ASSERT(keys != NULL, "Trying to check NULL keys");
+	EE_ASSERT(out_flags != NULL, "Trying to dereference NULL output buffer");
+
+	u8* ptrs[EE_DICT_BATCH_SIZE];
+	size_t found = 0;
+
+	for (size_t low = 0; low < n; low += EE_DICT_BATCH_SIZE)
+	{
+		size_t count = ee_min_u64(n - low, EE_DICT_BATCH_SIZE);
+
+		found += ee_dict_at_batch(dict, &keys[low * dict->key_len], count, ptrs);
+
+		for (size_t j = 0; j < count; ++j)
+		{
+			out_flags[low + j] = (ptrs[j] != NULL);
+		}
+	}
+
+	return found;
+}
+
+// Snapshot of the counters (zero unless EE_DICT_STATS is defined) and of the table occupancy.
+// Scans the control bytes to count tombstones, meant for periodic export rather than hot paths
+EE_INLINE DictStats ee_dict_stats(const Dict* dict)
+{
+	EE_ASSERT(dict != NULL, "Trying to dereference NULL Dict");
+
+	DictStats out = { 0 };
+
+#ifdef EE_DICT_STATS
+	out = dict->stats;
+
+	if (dict->old != NULL)
+		_ee_dict_stats_merge(&out, &dict->old->stats);
+#endif
+
+	for (const Dict* table = dict; table != NULL; table = table->old)
+	{
+		for (size_t i = 0; i < table->cap; ++i)
+			out.tombs += (table->ctrl.buffer[i] == EE_SLOT_DELETED);
+
+		out.cap += table->cap;
+	}
+
+	out.count = ee_dict_count(dict);
+	out.load  = (f64)out.count / (f64)out.cap;
+
+	return out;
+}
+
+EE_INLINE void ee_dict_stats_reset(Dict* dict)
+{
+	EE_ASSERT(dict != NULL, "Trying to dereference NULL Dict");
+
+#ifdef EE_DICT_STATS
+	memset(&dict->stats, 0, sizeof(dict->stats));
+
+	if (dict->old != NULL)
+		memset(&dict->old->stats, 0, sizeof(dict->old->stats));
+#else
+	EE_UNUSED(dict);
+#endif
+}
+
+EE_INLINE size_t _ee_dict_bulk_size(size_t n)
+{
+	// Smallest power of two whose load threshold holds 'n' entries
+	size_t cap = ee_next_pow_2(ee_max_u64(n, EE_DICT_START_SIZE));
+
+	while (ee_dict_th(cap) < n)
+	{
+		cap *= 2;
+	}
+
+	return cap;
+}
+
+typedef struct DictBulkEntry
+{
+	u64    hash;
+	size_t index;
+} DictBulkEntry;
+
+// Builds a Dict from 'n' packed keys and values, the table is sized once and never grows
+// Entries are radix sorted by home group and placed in that order, so the table is written front to back
+// With 'assume_unique' the match scan is skipped and every key takes the first free slot on its probe sequence,
+// otherwise duplicates overwrite and the last occurrence wins
+EE_INLINE Dict ee_dict_from_buffers(const u8* keys, const u8* vals, size_t n, size_t key_len, size_t val_len, i32 assume_unique, DictConfig config)
+{
+	EE_ASSERT(n == 0 || keys != NULL, "Trying to build Dict from NULL keys");
+	EE_ASSERT(n == 0 || vals != NULL || val_len == 0, "Trying to build Dict from NULL values");
+
+	Dict out = ee_dict_new(_ee_dict_bulk_size(n), key_len, val_len, config);
+
+	if (n == 0)
+	{
+		return out;
+	}
+
+	// Sets take no values, the zero-length copies only need a valid source
+	if (vals == NULL)
+	{
+		vals = keys;
+	}
+
+	size_t entries_size = n * sizeof(DictBulkEntry);
+
+	DictBulkEntry* entries = (DictBulkEntry*)out.allocator.alloc_fn(&out.allocator, entries_size);
+	DictBulkEntry* temp = (DictBulkEntry*)out.allocator.alloc_fn(&out.allocator, entries_size);
+
+	EE_ASSERT(entries != NULL && temp != NULL, "Unable to allocate (%zu) bytes for Dict bulk build", entries_size * 2);
+
+	// 'temp' is twice the size of the hashes and is only needed by the sort below
+	u64* hashes = (u64*)temp;
+
+	ee_dict_hash_many(&out, keys, n, hashes);
+
+	for (size_t i = 0; i < n; ++i)
+	{
+		entries[i].hash = hashes[i];
+		entries[i].index = i;
+	}
+
+	// LSD radix sort on the home group bits of the hash, digits small enough for the scatter to stay in cache
+	// Every pass is stable, so equal keys keep their input order
+	size_t low_bit = 7 + (size_t)ee_log2_u32(EE_GROUP_SIZE);
+	size_t group_bits = (size_t)ee_log2_u32((u32)(out.cap / EE_GROUP_SIZE));
+
+	for (size_t done = 0; done < group_bits; done += EE_DICT_BULK_RADIX_BITS)
+	{
+		size_t counts[1 << EE_DICT_BULK_RADIX_BITS] = { 0 };
+		size_t shift = low_bit + done;
+		size_t digits = (size_t)1 << ee_min_u64(group_bits - done, EE_DICT_BULK_RADIX_BITS);
+		size_t sum = 0;
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			counts[(entries[i].hash >> shift) & (digits - 1)]++;
+		}
+
+		for (size_t d = 0; d < digits; ++d)
+		{
+			size_t count = counts[d];
+
+			counts[d] = sum;
+			sum += count;
+		}
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			temp[counts[(entries[i].hash >> shift) & (digits - 1)]++] = entries[i];
+		}
+
+		DictBulkEntry* swap = entries;
+
+		entries = temp;
+		temp = swap;
+	}
+
+	for (size_t j = 0; j < n; ++j)
+	{
+		// Sources are read out of order now, pull them in ahead of use
+		if (j + EE_DICT_BATCH_SIZE < n)
+		{
+			size_t ahead = entries[j + EE_DICT_BATCH_SIZE].index;
+
+			eed_prefetch((const char*)&keys[ahead * key_len], EED_SIMD_PREFETCH_T0);
+			eed_prefetch((const char*)&vals[ahead * val_len], EED_SIMD_PREFETCH_T0);
+		}
+
+		u64 hash = entries[j].hash;
+
+		const u8* key = &keys[entries[j].index * key_len];
+		const u8* val = &vals[entries[j].index * val_len];
+
+		if (assume_unique)
+		{
+			size_t place = _ee_dict_first_free(&out, hash);
+
+			EE_ASSERT(place != (size_t)-1, "Dict has no free slot during bulk build");
+
+			out.key_cpy_fn(ee_dict_key_at(&out, place), key, key_len);
+			out.val_cpy_fn(ee_dict_val_at(&out, place), val, val_len);
+
+			out.ctrl.buffer[place] = hash & 0x7F;
+			out.count++;
+		}
+		else
+		{
+			ee_dict_insert_hash(&out, key, val, hash);
+		}
+	}
+
+	out.allocator.free_fn(&out.allocator, temp);
+	out.allocator.free_fn(&out.allocator, entries);
+
+	return out;
+}
+
+EE_INLINE Dict ee_dict_from_arrays(const Array* keys, const Array* vals, i32 assume_unique, DictConfig config)
+{
+	EE_ASSERT(keys != NULL, "Trying to build Dict from NULL keys Array");
+	EE_ASSERT(vals != NULL, "Trying to build Dict from NULL values Array");
+	EE_ASSERT(ee_array_len(keys) == ee_array_len(vals), "Keys (%zu) and values (%zu) count mismatch", ee_array_len(keys), ee_array_len(vals));
+
+	return ee_dict_from_buffers(keys->buffer, vals->buffer, ee_array_len(keys), keys->elem_size, vals->elem_size, assume_unique, config);
+}
+
+//
+// Typed variants
+//
+
+// Generates a Dict specialized for key type K and value type V: 'name_new', 'name_free', 'name_count',
+// 'name_at', 'name_contains', 'name_set' and 'name_remove'. The hot paths index typed key/value arrays and
+// call 'hash(K)' and 'eq(K, K)' directly, so there are no function pointers and no 'i * key_len' arithmetic.
+// The table is a regular split-layout Dict in 'name.dict' with matching pointer callbacks, so grows, rehashes,
+// iteration, stats and 'ee_dict_save' keep working. Use 'ee_dict_hash_val_*' to stay compatible with the
+// byte-wise defaults and 'EE_DICT_EQ_VAL'/'EE_DICT_EQ_MEM' for the comparison
+
+#define EE_DICT_EQ_VAL(a, b)    ((a) == (b))
+#define EE_DICT_EQ_MEM(a, b)    (memcmp(&(a), &(b), sizeof(a)) == 0)
+
+EE_INLINE u64 ee_dict_hash_val_u32(u32 key)
+{
+	return eed_hash_32((const u8*)&key, sizeof(key));
+}
+
+EE_INLINE u64 ee_dict_hash_val_u64(u64 key)
+{
+	return eed_hash_64((const u8*)&key, sizeof(key));
+}
+
+EE_INLINE void _ee_dict_erase_slot(Dict* dict, size_t index)
+{
+	dict->ctrl.buffer[index] = EE_SLOT_DELETED;
+	dict->count--;
+
+	#ifdef EE_DICT_TOMBS_REHASH
+	dict->tombs++;
+
+	if (dict->tombs >= dict->tombs_th)
+	{
+		ee_dict_rehash(dict);
+	}
+	#endif
+}
+
+#define EE_DICT_DEFINE(name, K, V, hash, eq)                                                        \
+    typedef struct name                                                                             \
+    {                                                                                               \
+        Dict dict;                                                                                  \
+    } name;                                                                                         \
+                                                                                                    \
+    EE_INLINE u64 name##_hash_fn(const u8* key, size_t len)                                         \
+    {                                                                                               \
+        EE_UNUSED(len);                                                                             \
+                                                                                                    \
+        K key_val;                                                                                  \
+        memcpy(&key_val, key, sizeof(K));                                                           \
+                                                                                                    \
+        return hash(key_val);                                                                       \
+    }                                                                                               \
+                                                                                                    \
+    EE_INLINE i32 name##_eq_fn(const u8* a, const u8* b, size_t len)                                \
+    {                                                                                               \
+        EE_UNUSED(len);                                                                             \
+                                                                                                    \
+        K a_val, b_val;                                                                             \
+        memcpy(&a_val, a, sizeof(K));                                                               \
+        memcpy(&b_val, b, sizeof(K));                                                               \
+                                                                                                    \
+        return eq(a_val, b_val);                                                                    \
+    }                                                                                               \
+                                                                                                    \
+    EE_INLINE name name##_new(size_t size, Allocator* allocator)                                    \
+    {                                                                                               \
+        name out;                                                                                   \
+        DictConfig config = ee_dict_config_def();                                                   \
+                                                                                                    \
+        config.allocator = allocator;                                                               \
+        config.hash_fn   = name##_hash_fn;                                                          \
+        config.eq_fn     = name##_eq_fn;                                                            \
+                                                                                                    \
+        out.dict = ee_dict_new(size, sizeof(K), sizeof(V), config);                                 \
+                                                                                                    \
+        return out;                                                                                 \
+    }                                                                                               \
+                                                                                                    \
+    EE_INLINE void name##_free(name* dict)                                                          \
+    {                                                                                               \
+        ee_dict_free(&dict->dict);                                                                  \
+    }                                                                                               \
+                                                                                                    \
+    EE_INLINE size_t name##_count(const name* dict)                                                 \
+    {                                                                                               \
+        return dict->dict.count;                                                                    \
+    }                                                                                               \
+                                                                                                    \
+    EE_INLINE V* name##_at(const name* typed, K key)                                                \
+    {                                                                                               \
+        const Dict* dict = &typed->dict;                                                            \
+        const K* keys = (const K*)dict->keys.buffer;                                                \
+                                                                                                    \
+        u64 hash_val = hash(key);                                                                   \
+        size_t base_index = (size_t)(hash_val >> 7) & dict->mask;                                   \
+        u8 hash_sign = (u8)(hash_val & 0x7F);                                                       \
+                                                                                                    \
+        for (size_t probe_step = 0; probe_step < dict->cap;)                                        \
+        {                                                                                           \
+            size_t group_index = base_index & EE_GROUP_MASK;                                        \
+            const u8* group = &dict->ctrl.buffer[group_index];                                      \
+            eed_mask match_mask = eed_group_match(group, hash_sign);                                \
+                                                                                                    \
+            while (match_mask)                                                                      \
+            {                                                                                       \
+                size_t index = group_index + (size_t)eed_mask_first(match_mask);                    \
+                                                                                                    \
+                if (eq(keys[index], key))                                                           \
+                    return &((V*)dict->vals.buffer)[index];                                         \
+                                                                                                    \
+                match_mask &= match_mask - 1;                                                       \
+            }                                                                                       \
+                                                                                                    \
+            if (eed_group_match(group, EE_SLOT_EMPTY))                                              \
+                break;                                                                              \
+                                                                                                    \
+            probe_step++;                                                                           \
+            base_index = (base_index + EE_GROUP_SIZE * probe_step) & dict->mask;                    \
+        }                                                                                           \
+                                                                                                    \
+        return NULL;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    EE_INLINE i32 name##_contains(const name* dict, K key)                                          \
+    {                                                                                               \
+        return name##_at(dict, key) != NULL;                                                        \
+    }                                                                                               \
+                                                                                                    \
+    EE_INLINE i32 name##_set(name* typed, K key, V val)                                             \
+    {                                                                                               \
+        Dict* dict = &typed->dict;                                                                  \
+                                                                                                    \
+        if (dict->count + 1 > dict->th)                                                             \
+            ee_dict_grow(dict, 2 * dict->cap);                                                      \
+                                                                                                    \
+        K* keys = (K*)dict->keys.buffer;                                                            \
+        V* vals = (V*)dict->vals.buffer;                                                            \
+                                                                                                    \
+        u64 hash_val = hash(key);                                                                   \
+        size_t base_index = (size_t)(hash_val >> 7) & dict->mask;                                   \
+        u8 hash_sign = (u8)(hash_val & 0x7F);                                                       \
+        size_t place = (size_t)-1;                                                                  \
+                                                                                                    \
+        for (size_t probe_step = 0; probe_step < dict->cap;)                                        \
+        {                                                                                           \
+            size_t group_index = base_index & EE_GROUP_MASK;                                        \
+            const u8* group = &dict->ctrl.buffer[group_index];                                      \
+            eed_mask match_mask = eed_group_match(group, hash_sign);                                \
+                                                                                                    \
+            while (match_mask)                                                                      \
+            {                                                                                       \
+                size_t index = group_index + (size_t)eed_mask_first(match_mask);                    \
+                                                                                                    \
+                if (eq(keys[index], key))                                                           \
+                {                                                                                   \
+                    vals[index] = val;                                                              \
+                    return EE_TRUE;                                                                 \
+                }                                                                                   \
+                                                                                                    \
+                match_mask &= match_mask - 1;                                                       \
+            }                                                                                       \
+                                                                                                    \
+            eed_mask empty_mask = eed_group_match(group, EE_SLOT_EMPTY);                            \
+                                                                                                    \
+            if (empty_mask)                                                                         \
+            {                                                                                       \
+                if (place == (size_t)-1)                                                            \
+                    place = group_index + (size_t)eed_mask_first(empty_mask);                       \
+                                                                                                    \
+                break;                                                                              \
+            }                                                                                       \
+                                                                                                    \
+            eed_mask deleted_mask = eed_group_match(group, EE_SLOT_DELETED);                        \
+                                                                                                    \
+            if (deleted_mask && place == (size_t)-1)                                                \
+                place = group_index + (size_t)eed_mask_first(deleted_mask);                         \
+                                                                                                    \
+            probe_step++;                                                                           \
+            base_index = (base_index + EE_GROUP_SIZE * probe_step) & dict->mask;                    \
+        }                                                                                           \
+                                                                                                    \
+        if (place == (size_t)-1)                                                                    \
+            return EE_FALSE;                                                                        \
+                                                                                                    \
+        keys[place] = key;                                                                          \
+        vals[place] = val;                                                                          \
+                                                                                                    \
+        dict->ctrl.buffer[place] = hash_sign;                                                       \
+        dict->count++;                                                                              \
+                                                                                                    \
+        return EE_TRUE;                                                                             \
+    }                                                                                               \
+                                                                                                    \
+    EE_INLINE i32 name##_remove(name* typed, K key)                                                 \
+    {                                                                                               \
+        Dict* dict = &typed->dict;                                                                  \
+        const K* keys = (const K*)dict->keys.buffer;                                                \
+                                                                                                    \
+        u64 hash_val = hash(key);                                                                   \
+        size_t base_index = (size_t)(hash_val >> 7) & dict->mask;                                   \
+        u8 hash_sign = (u8)(hash_val & 0x7F);                                                       \
+                                                                                                    \
+        for (size_t probe_step = 0; probe_step < dict->cap;)                                        \
+        {                                                                                           \
+            size_t group_index = base_index & EE_GROUP_MASK;                                        \
+            const u8* group = &dict->ctrl.buffer[group_index];                                      \
+            eed_mask match_mask = eed_group_match(group, hash_sign);                                \
+                                                                                                    \
+            while (match_mask)                                                                      \
+            {                                                                                       \
+                size_t index = group_index + (size_t)eed_mask_first(match_mask);                    \
+                                                                                                    \
+                if (eq(keys[index], key))                                                           \
+                {                                                                                   \
+                    _ee_dict_erase_slot(dict, index);                                               \
+                    return EE_TRUE;                                                                 \
+                }                                                                                   \
+                                                                                                    \
+                match_mask &= match_mask - 1;                                                       \
+            }                                                                                       \
+                                                                                                    \
+            if (eed_group_match(group, EE_SLOT_EMPTY))                                              \
+                break;                                                                              \
+                                                                                                    \
+            probe_step++;                                                                           \
+            base_index = (base_index + EE_GROUP_SIZE * probe_step) & dict->mask;                    \
+        }                                                                                           \
+                                                                                                    \
+        return EE_FALSE;                                                                            \
+    }
+
 EE_EXTERN_C_END
 
 #endif // EE_DICT_H
\ No newline at end of file
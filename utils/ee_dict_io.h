@@ -0,0 +1,497 @@
+#pragma once
+
+#ifndef EE_DICT_IO_H
+#define EE_DICT_IO_H
+
+#include "ee_dict.h"
+
+#ifdef _WIN32
+#include "windows.h"
+#else
+#include "fcntl.h"
+#include "unistd.h"
+#include "sys/mman.h"
+#include "sys/stat.h"
+#endif
+
+// Sections start on page boundaries so a mapped image keeps the alignment 'ee_dict_new' would give
+#ifndef EE_DICT_IMAGE_ALIGN
+#define EE_DICT_IMAGE_ALIGN      (4096)
+#endif
+
+// Live keys re-hashed on save to identify the hash function and on map to verify it
+#ifndef EE_DICT_IMAGE_PROBES
+#define EE_DICT_IMAGE_PROBES     (16)
+#endif
+
+// "EEDICT" followed by 0x00 0x01, read back in the wrong byte order it does not match
+#define EE_DICT_IMAGE_MAGIC      (0x0100544349444545ull)
+#define EE_DICT_IMAGE_VERSION    (1)
+
+typedef enum DictHashId
+{
+	EE_DICT_HASH_CUSTOM      = 0,
+	EE_DICT_HASH_U32_SAFE    = 1,
+	EE_DICT_HASH_U32_FAST    = 2,
+	EE_DICT_HASH_MM_U32_SAFE = 3,
+	EE_DICT_HASH_MM_U32_FAST = 4,
+	EE_DICT_HASH_U64_SAFE    = 5,
+	EE_DICT_HASH_U64_FAST    = 6,
+	EE_DICT_HASH_MM_U64_SAFE = 7,
+	EE_DICT_HASH_MM_U64_FAST = 8,
+	EE_DICT_HASH_U128_SAFE   = 9,
+	EE_DICT_HASH_U128_FAST   = 10,
+	EE_DICT_HASH_U256_SAFE   = 11,
+	EE_DICT_HASH_U256_FAST   = 12,
+	EE_DICT_HASH_MM          = 13,
+	EE_DICT_HASH_SAFE        = 14,
+	EE_DICT_HASH_FAST        = 15,
+	EE_DICT_HASH_COUNT       = 16,
+} DictHashId;
+
+// Every field is 64-bit so the layout does not depend on the compiler
+typedef struct DictImageHeader
+{
+	u64 magic;
+	u64 version;
+	u64 file_size;
+
+	u64 count;
+	u64 cap;
+	u64 mask;
+
+	u64 key_len;
+	u64 val_len;
+	u64 key_stride;
+	u64 val_stride;
+	u64 layout;
+	u64 group_size;
+	u64 hash_id;
+
+	u64 ctrl_off;
+	u64 keys_off;
+	u64 keys_size;
+	u64 vals_off;
+	u64 vals_size;
+} DictImageHeader;
+
+EE_EXTERN_C_START
+
+// Fixed-width hashes read exactly their width, they are only offered for keys of that length
+EE_INLINE DictHash ee_dict_hash_by_id(u64 id, size_t key_len)
+{
+	switch (id)
+	{
+	case EE_DICT_HASH_U32_SAFE:    return key_len == 4  ? ee_hash_u32_safe    : NULL;
+	case EE_DICT_HASH_U32_FAST:    return key_len == 4  ? ee_hash_u32_fast    : NULL;
+	case EE_DICT_HASH_MM_U32_SAFE: return key_len == 4  ? ee_hash_mm_u32_safe : NULL;
+	case EE_DICT_HASH_MM_U32_FAST: return key_len == 4  ? ee_hash_mm_u32_fast : NULL;
+	case EE_DICT_HASH_U64_SAFE:    return key_len == 8  ? ee_hash_u64_safe    : NULL;
+	case EE_DICT_HASH_U64_FAST:    return key_len == 8  ? ee_hash_u64_fast    : NULL;
+	case EE_DICT_HASH_MM_U64_SAFE: return key_len == 8  ? ee_hash_mm_u64_safe : NULL;
+	case EE_DICT_HASH_MM_U64_FAST: return key_len == 8  ? ee_hash_mm_u64_fast : NULL;
+	case EE_DICT_HASH_U128_SAFE:   return key_len == 16 ? ee_hash_u128_safe   : NULL;
+	case EE_DICT_HASH_U128_FAST:   return key_len == 16 ? ee_hash_u128_fast   : NULL;
+	case EE_DICT_HASH_U256_SAFE:   return key_len == 32 ? ee_hash_u256_safe   : NULL;
+	case EE_DICT_HASH_U256_FAST:   return key_len == 32 ? ee_hash_u256_fast   : NULL;
+	case EE_DICT_HASH_MM:          return ee_hash_mm;
+	case EE_DICT_HASH_SAFE:        return ee_hash_safe;
+	case EE_DICT_HASH_FAST:        return ee_hash_fast;
+	default:                       return NULL;
+	}
+}
+
+EE_INLINE size_t _ee_dict_image_probes(const Dict* dict, size_t* out_slots)
+{
+	size_t n = 0;
+
+	for (size_t i = 0; i < dict->cap && n < EE_DICT_IMAGE_PROBES; ++i)
+	{
+		if ((dict->ctrl.buffer[i] & 0x80) == 0)
+			out_slots[n++] = i;
+	}
+
+	return n;
+}
+
+// Function pointers differ between translation units (EE_INLINE is static), so the hash is
+// identified by what it returns for keys already in the table rather than by its address
+EE_INLINE u64 ee_dict_hash_id(const Dict* dict)
+{
+	EE_ASSERT(dict != NULL, "Trying to dereference NULL Dict");
+
+	size_t slots[EE_DICT_IMAGE_PROBES];
+	size_t n = _ee_dict_image_probes(dict, slots);
+
+	for (u64 id = EE_DICT_HASH_CUSTOM + 1; id < EE_DICT_HASH_COUNT; ++id)
+	{
+		DictHash hash_fn = ee_dict_hash_by_id(id, dict->key_len);
+
+		if (hash_fn == NULL)
+			continue;
+
+		size_t i = 0;
+
+		for (; i < n; ++i)
+		{
+			const u8* key = ee_dict_key_at(dict, slots[i]);
+
+			if (hash_fn(key, dict->key_len) != dict->hash_fn(key, dict->key_len))
+				break;
+		}
+
+		if (i == n)
+			return id;
+	}
+
+	return EE_DICT_HASH_CUSTOM;
+}
+
+EE_INLINE void _ee_dict_image_write(FILE* file, const void* data, size_t size, u64* pos)
+{
+	static const u8 zeros[256] = { 0 };
+
+	size_t left = size;
+
+	while (left > 0)
+	{
+		size_t chunk = data == NULL ? ee_min_u64(left, sizeof(zeros)) : left;
+		const void* src = data == NULL ? (const void*)zeros : (const void*)((const u8*)data + (size - left));
+
+		size_t bytes_wrote = fwrite(src, 1, chunk, file);
+
+		EE_ASSERT(bytes_wrote == chunk, "Unable to write (%zu) bytes to Dict image", chunk);
+
+		if (bytes_wrote == 0)
+			break;
+
+		left -= bytes_wrote;
+	}
+
+	*pos += size;
+}
+
+EE_INLINE void _ee_dict_image_pad(FILE* file, u64* pos)
+{
+	u64 aligned = ee_round_up_pow2(*pos, EE_DICT_IMAGE_ALIGN);
+
+	_ee_dict_image_write(file, NULL, (size_t)(aligned - *pos), pos);
+}
+
+// Writes 'ctrl', 'keys' and 'vals' verbatim behind a header, a pending incremental grow is finished first.
+// Keys must be plain data, tables of pointers (e.g. ee_hash_cstr_*) are meaningless once mapped
+EE_INLINE void ee_dict_save(Dict* dict, const char* path)
+{
+	EE_ASSERT(dict != NULL, "Trying to save NULL Dict");
+	EE_ASSERT(path != NULL, "Trying to save Dict to a NULL file path");
+
+	if (dict->old != NULL)
+	{
+		ee_dict_migrate(dict, (size_t)-1);
+	}
+
+	DictImageHeader header = { 0 };
+
+	header.magic      = EE_DICT_IMAGE_MAGIC;
+	header.version    = EE_DICT_IMAGE_VERSION;
+	header.count      = dict->count;
+	header.cap        = dict->cap;
+	header.mask       = dict->mask;
+	header.key_len    = dict->key_len;
+	header.val_len    = dict->val_len;
+	header.key_stride = dict->key_stride;
+	header.val_stride = dict->val_stride;
+	header.layout     = dict->layout;
+	header.group_size = EE_GROUP_SIZE;
+	header.hash_id    = ee_dict_hash_id(dict);
+
+	header.ctrl_off  = ee_round_up_pow2(sizeof(DictImageHeader), EE_DICT_IMAGE_ALIGN);
+	header.keys_off  = ee_round_up_pow2(header.ctrl_off + dict->cap, EE_DICT_IMAGE_ALIGN);
+	header.keys_size = dict->cap * dict->key_stride;
+
+	if (dict->layout == EE_DICT_LAYOUT_INTERLEAVED || dict->val_len == 0)
+	{
+		// Values live inside the key slots (or there are none), the section is shared
+		header.vals_off  = header.keys_off + (u64)(dict->vals.buffer - dict->keys.buffer);
+		header.vals_size = 0;
+		header.file_size = header.keys_off + header.keys_size;
+	}
+	else
+	{
+		header.vals_off  = ee_round_up_pow2(header.keys_off + header.keys_size, EE_DICT_IMAGE_ALIGN);
+		header.vals_size = dict->cap * dict->val_stride;
+		header.file_size = header.vals_off + header.vals_size;
+	}
+
+	FILE* file = fopen(path, "wb");
+
+	EE_ASSERT(file != NULL, "Unable to open file (%s)", path);
+
+	u64 pos = 0;
+
+	_ee_dict_image_write(file, &header, sizeof(header), &pos);
+	_ee_dict_image_pad(file, &pos);
+	_ee_dict_image_write(file, dict->ctrl.buffer, dict->cap, &pos);
+	_ee_dict_image_pad(file, &pos);
+	_ee_dict_image_write(file, dict->keys.buffer, (size_t)header.keys_size, &pos);
+
+	if (header.vals_size > 0)
+	{
+		_ee_dict_image_pad(file, &pos);
+		_ee_dict_image_write(file, dict->vals.buffer, (size_t)header.vals_size, &pos);
+	}
+
+	EE_ASSERT(pos == header.file_size, "Dict image size mismatch, wrote (%llu) of (%llu) bytes", (unsigned long long)pos, (unsigned long long)header.file_size);
+
+	fclose(file);
+}
+
+// Returns NULL if the file is missing, empty or can not be mapped
+EE_INLINE void* _ee_dict_image_open(const char* path, size_t* out_size)
+{
+	void* image = NULL;
+
+	*out_size = 0;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (file == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	LARGE_INTEGER size = { 0 };
+	HANDLE mapping = NULL;
+
+	// An empty file can not be mapped
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if (mapping != NULL)
+	{
+		image = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+		// The view keeps the mapping alive
+		CloseHandle(mapping);
+	}
+
+	CloseHandle(file);
+
+	*out_size = (size_t)size.QuadPart;
+#else
+	int file = open(path, O_RDONLY);
+
+	if (file < 0)
+		return NULL;
+
+	struct stat info = { 0 };
+
+	if (fstat(file, &info) == 0 && info.st_size > 0)
+	{
+		image = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, file, 0);
+
+		if (image == MAP_FAILED)
+			image = NULL;
+	}
+
+	close(file);
+
+	*out_size = (size_t)info.st_size;
+#endif
+
+	return image;
+}
+
+EE_INLINE void _ee_dict_image_close(void* image, size_t size)
+{
+#ifdef _WIN32
+	EE_UNUSED(size);
+	UnmapViewOfFile(image);
+#else
+	munmap(image, size);
+#endif
+}
+
+// 'size' bytes at 'off' lie within the first 'file_size' bytes, written so that no sum can wrap
+EE_INLINE i32 _ee_dict_image_fits(u64 off, u64 size, u64 file_size)
+{
+	return off <= file_size && size <= file_size - off;
+}
+
+// Checks everything a mapped Dict reads through: the format, this build's group size, and that every
+// section lies inside the file with strides that hold their keys and values
+EE_INLINE i32 _ee_dict_image_valid(const DictImageHeader* header, size_t image_size)
+{
+	if (header->magic != EE_DICT_IMAGE_MAGIC || header->version != EE_DICT_IMAGE_VERSION || header->group_size != EE_GROUP_SIZE)
+		return EE_FALSE;
+
+	if (header->file_size > image_size || header->file_size < sizeof(DictImageHeader))
+		return EE_FALSE;
+
+	u64 file_size = header->file_size;
+	u64 cap = header->cap;
+
+	// Probes load whole groups from 'ctrl'
+	if (!ee_is_pow2(cap) || cap < EE_GROUP_SIZE || header->mask != cap - 1 || header->count > cap)
+		return EE_FALSE;
+
+	if (header->ctrl_off % EE_DICT_IMAGE_ALIGN != 0 || header->keys_off % EE_DICT_IMAGE_ALIGN != 0)
+		return EE_FALSE;
+
+	if (header->layout != EE_DICT_LAYOUT_SPLIT && header->layout != EE_DICT_LAYOUT_INTERLEAVED)
+		return EE_FALSE;
+
+	if (header->key_len == 0 || header->key_stride < header->key_len || header->key_stride > file_size / cap)
+		return EE_FALSE;
+
+	if (header->keys_size != cap * header->key_stride)
+		return EE_FALSE;
+
+	if (!_ee_dict_image_fits(header->ctrl_off, cap, file_size) || !_ee_dict_image_fits(header->keys_off, header->keys_size, file_size))
+		return EE_FALSE;
+
+	if (header->vals_size == 0)
+	{
+		// Values share the key slots (or there are none): they start inside the first slot and end inside the last
+		if (header->layout == EE_DICT_LAYOUT_SPLIT && header->val_len != 0)
+			return EE_FALSE;
+
+		if (header->vals_off < header->keys_off || header->val_stride != (header->val_len == 0 ? 0 : header->key_stride))
+			return EE_FALSE;
+
+		u64 val_off = header->vals_off - header->keys_off;
+
+		return val_off <= header->key_stride && header->val_len <= header->key_stride - val_off;
+	}
+
+	if (header->layout != EE_DICT_LAYOUT_SPLIT || header->val_len == 0 || header->val_stride < header->val_len || header->val_stride > file_size / cap)
+		return EE_FALSE;
+
+	if (header->vals_off % EE_DICT_IMAGE_ALIGN != 0 || header->vals_size != cap * header->val_stride)
+		return EE_FALSE;
+
+	return _ee_dict_image_fits(header->vals_off, header->vals_size, file_size);
+}
+
+// Maps an image written by 'ee_dict_save' read-only, the Dict is queried in place and released with 'ee_dict_unmap'.
+// 'config.hash_fn' overrides the stored hash id and is required for images saved with a custom hash,
+// 'config.eq_fn' is honored, copy callbacks are irrelevant since the table can not be modified.
+// A missing file, one that is not a valid image for this build, or a hash mismatch returns a zeroed Dict
+// ('image' is NULL) in every build, asserts are not relied on
+EE_INLINE Dict ee_dict_map_conf(const char* path, DictConfig config)
+{
+	EE_ASSERT(path != NULL, "Trying to map Dict from a NULL file path");
+
+	Dict out = { 0 };
+
+	size_t image_size = 0;
+	u8* image = (u8*)_ee_dict_image_open(path, &image_size);
+
+	if (image == NULL)
+	{
+		return out;
+	}
+
+	const DictImageHeader* header = (const DictImageHeader*)image;
+
+	if (image_size < sizeof(DictImageHeader) || !_ee_dict_image_valid(header, image_size))
+	{
+		_ee_dict_image_close(image, image_size);
+
+		return out;
+	}
+
+	out.allocator.alloc_fn   = ee_default_alloc;
+	out.allocator.realloc_fn = ee_default_realloc;
+	out.allocator.free_fn    = ee_default_free;
+	out.allocator.context    = NULL;
+
+	out.count      = (size_t)header->count;
+	out.cap        = (size_t)header->cap;
+	out.mask       = (size_t)header->mask;
+	out.th         = ee_dict_th(out.cap);
+	out.key_len    = (size_t)header->key_len;
+	out.val_len    = (size_t)header->val_len;
+	out.key_stride = (size_t)header->key_stride;
+	out.val_stride = (size_t)header->val_stride;
+	out.layout     = (DictLayout)header->layout;
+	out.grow       = EE_DICT_GROW_FULL;
+
+	out.ctrl.buffer = image + header->ctrl_off;
+	out.ctrl.size   = out.cap;
+	out.ctrl.align  = EE_DICT_IMAGE_ALIGN;
+
+	out.keys.buffer = image + header->keys_off;
+	out.keys.size   = (size_t)header->keys_size;
+	out.keys.align  = EE_DICT_IMAGE_ALIGN;
+
+	out.vals.buffer = image + header->vals_off;
+	out.vals.size   = (size_t)header->vals_size;
+	out.vals.align  = EE_DICT_IMAGE_ALIGN;
+
+#ifdef EE_DICT_TOMBS_REHASH
+	out.tombs_th = (size_t)-1;
+#endif
+
+	out.image      = image;
+	out.image_size = image_size;
+
+	DictHash hash_fn = config.hash_fn;
+
+	if (hash_fn == NULL)
+	{
+		// Saved with a custom hash, it has to come in DictConfig.hash_fn
+		hash_fn = ee_dict_hash_by_id(header->hash_id, out.key_len);
+
+		if (hash_fn == NULL)
+		{
+			_ee_dict_image_close(image, image_size);
+			memset(&out, 0, sizeof(out));
+
+			return out;
+		}
+	}
+
+	config.hash_fn    = hash_fn;
+	config.key_cpy_fn = NULL;
+	config.val_cpy_fn = NULL;
+
+	_ee_dict_bind_fns(&out, config);
+
+	// Hashes that changed between builds (e.g. ee_hash_fast under another EE_SIMD_LEVEL) would silently miss every key
+	size_t slots[EE_DICT_IMAGE_PROBES];
+	size_t n = _ee_dict_image_probes(&out, slots);
+
+	for (size_t i = 0; i < n; ++i)
+	{
+		u64 hash = out.hash_fn(ee_dict_key_at(&out, slots[i]), out.key_len);
+
+		if ((u8)(hash & 0x7F) != out.ctrl.buffer[slots[i]])
+		{
+			_ee_dict_image_close(image, image_size);
+			memset(&out, 0, sizeof(out));
+
+			return out;
+		}
+	}
+
+	return out;
+}
+
+EE_INLINE Dict ee_dict_map(const char* path)
+{
+	return ee_dict_map_conf(path, ee_dict_config_def());
+}
+
+EE_INLINE void ee_dict_unmap(Dict* dict)
+{
+	EE_ASSERT(dict != NULL, "Trying to unmap NULL Dict");
+	EE_ASSERT(dict->image != NULL, "Trying to unmap a Dict that was not created by ee_dict_map");
+
+	_ee_dict_image_close(dict->image, dict->image_size);
+
+	memset(dict, 0, sizeof(Dict));
+}
+
+EE_EXTERN_C_END
+
+#endif // EE_DICT_IO_H
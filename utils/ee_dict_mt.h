@@ -0,0 +1,438 @@
+#pragma once
+
+#ifndef EE_DICT_MT_H
+#define EE_DICT_MT_H
+
+#include "ee_dict.h"
+#include "ee_thread.h"
+
+#define EE_DICT_MT_THREADS_MAX    (64)
+
+// Entries per thread below which spawning more threads does not pay off
+#ifndef EE_DICT_MT_MIN_CHUNK
+#define EE_DICT_MT_MIN_CHUNK      (EE_NKB(32))
+#endif
+
+// Parallel table build, shared by 'ee_dict_grow_mt' and 'ee_dict_from_buffers_mt':
+//   1. Source slots are split into equal ranges, each thread hashes its range and counts entries per destination
+//   2. Each thread scatters its entries into per-destination buckets, offsets come from the counts so nothing is locked
+//   3. Each destination thread owns a contiguous range of groups in the new table and places the entries whose
+//      home group falls inside it, entries whose home group is full are deferred
+//   4. The calling thread places the deferred entries with the regular probe sequence
+// Home groups only ever fill up, so every key placed in step 3 or 4 is found by a later probe
+typedef struct DictMtJob
+{
+	Dict* out;
+
+	// Source, 'ctrl' is NULL when every slot is live
+	const u8* ctrl;
+	const u8* keys;
+	const u8* vals;
+	size_t    key_stride;
+	size_t    val_stride;
+	size_t    total;
+
+	u64*           hashes;
+	DictBulkEntry* entries;
+	size_t*        offsets;
+
+	size_t src_count;
+	size_t dst_count;
+	size_t dst_shift;
+	i32    assume_unique;
+} DictMtJob;
+
+typedef struct DictMtTask
+{
+	DictMtJob* job;
+	size_t     id;
+
+	// Destination bucket, how many of its entries went into their home group and how many were deferred
+	size_t lo;
+	size_t hi;
+	size_t placed;
+	size_t deferred;
+} DictMtTask;
+
+EE_EXTERN_C_START
+
+EE_INLINE size_t _ee_dict_mt_dst(const DictMtJob* job, u64 hash)
+{
+	return ((hash >> 7) & job->out->mask) >> job->dst_shift;
+}
+
+EE_INLINE void _ee_dict_mt_hash_fn(void* context)
+{
+	DictMtTask* task = (DictMtTask*)context;
+	DictMtJob* job = task->job;
+	Dict* out = job->out;
+
+	size_t lo = job->total * task->id / job->src_count;
+	size_t hi = job->total * (task->id + 1) / job->src_count;
+	size_t* counts = &job->offsets[task->id * job->dst_count];
+
+	// Packed input buffers go through the bulk hash, table slots are hashed one live slot at a time
+	if (job->ctrl == NULL && job->key_stride == out->key_len)
+	{
+		ee_dict_hash_many(out, &job->keys[lo * job->key_stride], hi - lo, &job->hashes[lo]);
+
+		for (size_t i = lo; i < hi; ++i)
+		{
+			counts[_ee_dict_mt_dst(job, job->hashes[i])]++;
+		}
+
+		return;
+	}
+
+	for (size_t i = lo; i < hi; ++i)
+	{
+		if (job->ctrl != NULL && (job->ctrl[i] & 0x80))
+			continue;
+
+		u64 hash = out->hash_fn(&job->keys[i * job->key_stride], out->key_len);
+
+		job->hashes[i] = hash;
+		counts[_ee_dict_mt_dst(job, hash)]++;
+	}
+}
+
+EE_INLINE void _ee_dict_mt_scatter_fn(void* context)
+{
+	DictMtTask* task = (DictMtTask*)context;
+	DictMtJob* job = task->job;
+
+	size_t lo = job->total * task->id / job->src_count;
+	size_t hi = job->total * (task->id + 1) / job->src_count;
+	size_t* offsets = &job->offsets[task->id * job->dst_count];
+
+	for (size_t i = lo; i < hi; ++i)
+	{
+		if (job->ctrl != NULL && (job->ctrl[i] & 0x80))
+			continue;
+
+		DictBulkEntry* entry = &job->entries[offsets[_ee_dict_mt_dst(job, job->hashes[i])]++];
+
+		entry->hash = job->hashes[i];
+		entry->index = i;
+	}
+}
+
+EE_INLINE void _ee_dict_mt_place_fn(void* context)
+{
+	DictMtTask* task = (DictMtTask*)context;
+	DictMtJob* job = task->job;
+	Dict* out = job->out;
+
+	task->placed = 0;
+	task->deferred = 0;
+
+	for (size_t j = task->lo; j < task->hi; ++j)
+	{
+		// Buckets keep source order, so the home groups are random within the range
+		if (j + EE_DICT_BATCH_SIZE < task->hi)
+		{
+			const DictBulkEntry* ahead = &job->entries[j + EE_DICT_BATCH_SIZE];
+			size_t ahead_group = ((ahead->hash >> 7) & out->mask) & EE_GROUP_MASK;
+
+			eed_prefetch((const char*)&out->ctrl.buffer[ahead_group], EED_SIMD_PREFETCH_T0);
+			eed_prefetch((const char*)ee_dict_key_at(out, ahead_group), EED_SIMD_PREFETCH_T0);
+			eed_prefetch((const char*)&job->keys[ahead->index * job->key_stride], EED_SIMD_PREFETCH_T0);
+		}
+
+		DictBulkEntry entry = job->entries[j];
+
+		const u8* key = &job->keys[entry.index * job->key_stride];
+		const u8* val = &job->vals[entry.index * job->val_stride];
+
+		size_t group_index = ((entry.hash >> 7) & out->mask) & EE_GROUP_MASK;
+		const u8* group = &out->ctrl.buffer[group_index];
+		u8 hash_sign = entry.hash & 0x7F;
+
+		if (!job->assume_unique)
+		{
+			eed_mask match_mask = eed_group_match(group, hash_sign);
+			i32 replaced = EE_FALSE;
+
+			while (match_mask)
+			{
+				size_t index = group_index + (size_t)eed_mask_first(match_mask);
+
+				if (out->eq_fn(ee_dict_key_at(out, index), key, out->key_len))
+				{
+					out->val_cpy_fn(ee_dict_val_at(out, index), val, out->val_len);
+					replaced = EE_TRUE;
+					break;
+				}
+
+				match_mask &= match_mask - 1;
+			}
+
+			if (replaced)
+				continue;
+		}
+
+		eed_mask empty_mask = eed_group_match(group, EE_SLOT_EMPTY);
+
+		if (empty_mask)
+		{
+			size_t place = group_index + (size_t)eed_mask_first(empty_mask);
+
+			out->key_cpy_fn(ee_dict_key_at(out, place), key, out->key_len);
+			out->val_cpy_fn(ee_dict_val_at(out, place), val, out->val_len);
+
+			out->ctrl.buffer[place] = hash_sign;
+			task->placed++;
+		}
+		else
+		{
+			// Compacted to the front of the bucket, never past the entry being read
+			job->entries[task->lo + task->deferred++] = entry;
+		}
+	}
+}
+
+EE_INLINE void _ee_dict_mt_run(DictMtTask* tasks, size_t count, ThreadFn fn)
+{
+	Thread threads[EE_DICT_MT_THREADS_MAX];
+
+	for (size_t t = 1; t < count; ++t)
+	{
+		ee_thread_start(&threads[t], fn, &tasks[t]);
+	}
+
+	// The calling thread takes the first share instead of idling in join
+	fn(&tasks[0]);
+
+	for (size_t t = 1; t < count; ++t)
+	{
+		ee_thread_join(&threads[t]);
+	}
+}
+
+EE_INLINE size_t _ee_dict_mt_threads(size_t live, size_t threads)
+{
+	if (threads == 0)
+	{
+		threads = (size_t)ee_get_cpu_count();
+	}
+
+	threads = ee_min_u64(threads, EE_DICT_MT_THREADS_MAX);
+
+	return ee_min_u64(threads, ee_max_u64(live / EE_DICT_MT_MIN_CHUNK, 1));
+}
+
+// 'threads' comes from '_ee_dict_mt_threads'
+EE_INLINE void _ee_dict_mt_build(DictMtJob* job, size_t live, size_t threads)
+{
+	Dict* out = job->out;
+
+	// Destination ranges are a power of two groups each
+	size_t groups = out->cap / EE_GROUP_SIZE;
+	size_t dst_count = 1;
+
+	while (dst_count * 2 <= threads && dst_count * 2 <= groups)
+	{
+		dst_count *= 2;
+	}
+
+	size_t range = out->cap / dst_count;
+
+	job->src_count = threads;
+	job->dst_count = dst_count;
+	job->dst_shift = 0;
+
+	while (((size_t)1 << job->dst_shift) < range)
+	{
+		job->dst_shift++;
+	}
+
+	size_t hashes_size  = job->total * sizeof(u64);
+	size_t entries_size = live * sizeof(DictBulkEntry);
+	size_t offsets_size = job->src_count * job->dst_count * sizeof(size_t);
+
+	job->hashes  = (u64*)out->allocator.alloc_fn(&out->allocator, hashes_size);
+	job->entries = (DictBulkEntry*)out->allocator.alloc_fn(&out->allocator, entries_size);
+	job->offsets = (size_t*)out->allocator.alloc_fn(&out->allocator, offsets_size);
+
+	EE_ASSERT(job->hashes != NULL && job->entries != NULL && job->offsets != NULL,
+		"Unable to allocate (%zu) bytes for parallel Dict build", hashes_size + entries_size + offsets_size);
+
+	memset(job->offsets, 0, offsets_size);
+
+	DictMtTask tasks[EE_DICT_MT_THREADS_MAX];
+
+	for (size_t t = 0; t < threads; ++t)
+	{
+		tasks[t].job = job;
+		tasks[t].id = t;
+		tasks[t].lo = 0;
+		tasks[t].hi = 0;
+		tasks[t].placed = 0;
+		tasks[t].deferred = 0;
+	}
+
+	_ee_dict_mt_run(tasks, job->src_count, _ee_dict_mt_hash_fn);
+
+	// Counts become write offsets, bucket 'd' holds the entries of source range 0, 1, ... in order
+	size_t sum = 0;
+
+	for (size_t d = 0; d < job->dst_count; ++d)
+	{
+		tasks[d].lo = sum;
+
+		for (size_t s = 0; s < job->src_count; ++s)
+		{
+			size_t count = job->offsets[s * job->dst_count + d];
+
+			job->offsets[s * job->dst_count + d] = sum;
+			sum += count;
+		}
+
+		tasks[d].hi = sum;
+	}
+
+	EE_ASSERT(sum == live, "Parallel Dict build counted (%zu) of (%zu) entries", sum, live);
+
+	_ee_dict_mt_run(tasks, job->src_count, _ee_dict_mt_scatter_fn);
+	_ee_dict_mt_run(tasks, job->dst_count, _ee_dict_mt_place_fn);
+
+	for (size_t d = 0; d < job->dst_count; ++d)
+	{
+		out->count += tasks[d].placed;
+
+		for (size_t j = tasks[d].lo; j < tasks[d].lo + tasks[d].deferred; ++j)
+		{
+			DictBulkEntry entry = job->entries[j];
+
+			const u8* key = &job->keys[entry.index * job->key_stride];
+			const u8* val = &job->vals[entry.index * job->val_stride];
+
+			if (job->assume_unique)
+			{
+				size_t place = _ee_dict_first_free(out, entry.hash);
+
+				EE_ASSERT(place != (size_t)-1, "Dict has no free slot during parallel build");
+
+				out->key_cpy_fn(ee_dict_key_at(out, place), key, out->key_len);
+				out->val_cpy_fn(ee_dict_val_at(out, place), val, out->val_len);
+
+				out->ctrl.buffer[place] = entry.hash & 0x7F;
+				out->count++;
+			}
+			else
+			{
+				ee_dict_insert_hash(out, key, val, entry.hash);
+			}
+		}
+	}
+
+	out->allocator.free_fn(&out->allocator, job->offsets);
+	out->allocator.free_fn(&out->allocator, job->entries);
+	out->allocator.free_fn(&out->allocator, job->hashes);
+}
+
+// Doubles (or resizes to 'new_cap') the table on 'threads' threads, 0 uses every core.
+// Always a full grow, a pending incremental migration is finished first and 'dict->grow' is kept for later grows.
+// On one thread an EE_DICT_GROW_INPLACE table still grows in place
+EE_INLINE void ee_dict_grow_mt(Dict* dict, size_t new_cap, size_t threads)
+{
+	EE_ASSERT(dict != NULL, "Trying to grow NULL Dict");
+	EE_ASSERT(dict->image == NULL, "Trying to grow a read-only mapped Dict");
+
+#ifdef EE_DICT_STATS
+	u64 stats_start = ee_monotonic_ns();
+#endif
+
+	if (dict->old != NULL)
+	{
+		ee_dict_migrate(dict, (size_t)-1);
+	}
+
+	EE_ASSERT(ee_dict_th(ee_next_pow_2(new_cap)) >= dict->count, "New cap (%zu) can not hold (%zu) entries", new_cap, dict->count);
+
+	threads = _ee_dict_mt_threads(dict->count, threads);
+
+	// The staging buffers only pay off once there is more than one thread
+	if (threads == 1)
+	{
+		DictGrowType grow = dict->grow;
+
+		if (grow == EE_DICT_GROW_INCREMENTAL)
+			dict->grow = EE_DICT_GROW_FULL;
+
+		ee_dict_grow(dict, new_cap);
+		dict->grow = grow;
+
+		return;
+	}
+
+	DictConfig config = ee_dict_get_config(dict);
+	Dict out = ee_dict_new(new_cap, dict->key_len, dict->val_len, config);
+
+	DictMtJob job = { 0 };
+
+	job.out           = &out;
+	job.ctrl          = dict->ctrl.buffer;
+	job.keys          = dict->keys.buffer;
+	job.vals          = dict->vals.buffer;
+	job.key_stride    = dict->key_stride;
+	job.val_stride    = dict->val_stride;
+	job.total         = dict->cap;
+	job.assume_unique = EE_TRUE;
+
+	_ee_dict_mt_build(&job, dict->count, threads);
+
+	#ifdef EE_DICT_STATS
+	out.stats = dict->stats;
+	out.stats.grows++;
+	out.stats.grow_sec += _ee_dict_stats_since(stats_start);
+	#endif
+
+	_ee_dict_free_buffers(dict);
+
+	*dict = out;
+}
+
+// Parallel 'ee_dict_from_buffers', same sizing and duplicate handling (the last occurrence wins)
+EE_INLINE Dict ee_dict_from_buffers_mt(const u8* keys, const u8* vals, size_t n, size_t key_len, size_t val_len, i32 assume_unique, DictConfig config, size_t threads)
+{
+	EE_ASSERT(n == 0 || keys != NULL, "Trying to build Dict from NULL keys");
+	EE_ASSERT(n == 0 || vals != NULL || val_len == 0, "Trying to build Dict from NULL values");
+
+	threads = _ee_dict_mt_threads(n, threads);
+
+	if (threads == 1)
+	{
+		return ee_dict_from_buffers(keys, vals, n, key_len, val_len, assume_unique, config);
+	}
+
+	Dict out = ee_dict_new(_ee_dict_bulk_size(n), key_len, val_len, config);
+
+	DictMtJob job = { 0 };
+
+	job.out           = &out;
+	job.ctrl          = NULL;
+	job.keys          = keys;
+	job.vals          = vals == NULL ? keys : vals;
+	job.key_stride    = key_len;
+	job.val_stride    = val_len;
+	job.total         = n;
+	job.assume_unique = assume_unique;
+
+	_ee_dict_mt_build(&job, n, threads);
+
+	return out;
+}
+
+EE_INLINE Dict ee_dict_from_arrays_mt(const Array* keys, const Array* vals, i32 assume_unique, DictConfig config, size_t threads)
+{
+	EE_ASSERT(keys != NULL, "Trying to build Dict from NULL keys Array");
+	EE_ASSERT(vals != NULL, "Trying to build Dict from NULL values Array");
+	EE_ASSERT(ee_array_len(keys) == ee_array_len(vals), "Keys (%zu) and values (%zu) count mismatch", ee_array_len(keys), ee_array_len(vals));
+
+	return ee_dict_from_buffers_mt(keys->buffer, vals->buffer, ee_array_len(keys), keys->elem_size, vals->elem_size, assume_unique, config, threads);
+}
+
+EE_EXTERN_C_END
+
+#endif // EE_DICT_MT_H
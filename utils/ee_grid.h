@@ -5,6 +5,7 @@
 
 #include "ee_array.h"
 #include "ee_dict.h"
+#include "ee_hset.h"
 #include "ee_heap.h"
 
 #ifndef EE_INF
@@ -211,7 +212,7 @@ EE_INLINE Array ee_grid_search(Grid* grid, i32 x_0, i32 y_0, i32 x_1, i32 y_1, G
 
 	Dict score  = ee_dict_new_conf_m(start_size, GridPos, f64, config);
 	Dict parent = ee_dict_new_conf_m(start_size, GridPos, GridPos, config);
-	Dict closed = ee_dict_new_conf_m(start_size, GridPos, u64, config);
+	HashSet closed = ee_hset_new_conf_m(start_size, GridPos, config);
 
 	GridPos start_pos = { x_0, y_0 };
 	GridNode start_node = { start_pos, dist };
@@ -251,7 +252,7 @@ EE_INLINE Array ee_grid_search(Grid* grid, i32 x_0, i32 y_0, i32 x_1, i32 y_1, G
 			break;
 		}
 
-		if (ee_dict_contains(&closed, EE_RECAST_U8(current.pos)))
+		if (ee_hset_contains(&closed, EE_RECAST_U8(current.pos)))
 		{
 			continue;
 		}
@@ -272,7 +273,7 @@ EE_INLINE Array ee_grid_search(Grid* grid, i32 x_0, i32 y_0, i32 x_1, i32 y_1, G
 			continue;
 		}
 
-		ee_dict_set(&closed, EE_RECAST_U8(current.pos), EE_CONST_ONE);
+		ee_hset_insert(&closed, EE_RECAST_U8(current.pos));
 
 		for (int i = 0; i < EE_SEARCH_NEIGHS_COUNT; ++i)
 		{
@@ -286,7 +287,7 @@ EE_INLINE Array ee_grid_search(Grid* grid, i32 x_0, i32 y_0, i32 x_1, i32 y_1, G
 
 			GridPos neigh_pos = { neigh_x, neigh_y };
 
-			if (ee_dict_contains(&closed, EE_RECAST_U8(neigh_pos)))
+			if (ee_hset_contains(&closed, EE_RECAST_U8(neigh_pos)))
 			{
 				continue;
 			}
@@ -318,7 +319,7 @@ EE_INLINE Array ee_grid_search(Grid* grid, i32 x_0, i32 y_0, i32 x_1, i32 y_1, G
 
 	ee_dict_free(&score);
 	ee_dict_free(&parent);
-	ee_dict_free(&closed);
+	ee_hset_free(&closed);
 	ee_heap_free(&open_set);
 
 	return out_path;
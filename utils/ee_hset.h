@@ -0,0 +1,292 @@
+#pragma once
+
+#ifndef EE_HSET_H
+#define EE_HSET_H
+
+#include "ee_dict.h"
+
+#define ee_hset_new_m(size, key_type)                  ee_hset_new(size, sizeof(key_type), (DictConfig){ 0 })
+#define ee_hset_new_conf_m(size, key_type, config)     ee_hset_new(size, sizeof(key_type), config)
+
+// Open-addressing set on top of a Dict with zero 'val_len': same ctrl bytes, group probing, grows and
+// iteration, but no value buffer and no value copies. 'set.dict' can be passed to any read-only Dict function
+typedef struct HashSet
+{
+	Dict dict;
+} HashSet;
+
+EE_EXTERN_C_START
+
+EE_INLINE HashSet ee_hset_new(size_t size, size_t key_len, DictConfig config)
+{
+	HashSet out = { 0 };
+
+	config.val_cpy_fn = NULL;
+
+	out.dict = ee_dict_new(size, key_len, 0, config);
+
+	return out;
+}
+
+EE_INLINE void ee_hset_free(HashSet* set)
+{
+	EE_ASSERT(set != NULL, "Trying to free NULL HashSet");
+
+	ee_dict_free(&set->dict);
+}
+
+EE_INLINE size_t ee_hset_count(const HashSet* set)
+{
+	EE_ASSERT(set != NULL, "Trying to dereference NULL HashSet");
+
+	return ee_dict_count(&set->dict);
+}
+
+EE_INLINE i32 ee_hset_contains(const HashSet* set, const u8* key)
+{
+	EE_ASSERT(set != NULL, "Trying to check NULL HashSet");
+
+	return ee_dict_at(&set->dict, key) != NULL;
+}
+
+EE_INLINE size_t ee_hset_contains_batch(const HashSet* set, const u8* keys, size_t n, u8* out_flags)
+{
+	EE_ASSERT(set != NULL, "Trying to check NULL HashSet");
+
+	return ee_dict_contains_batch(&set->dict, keys, n, out_flags);
+}
+
+EE_INLINE i32 ee_hset_remove(HashSet* set, const u8* key)
+{
+	EE_ASSERT(set != NULL, "Trying to remove from NULL HashSet");
+
+	return ee_dict_remove(&set->dict, key);
+}
+
+// The key is known to be absent from both tables, so it takes the first free slot without a match scan
+EE_INLINE void _ee_hset_place(Dict* dict, const u8* key, u64 hash)
+{
+	size_t place = _ee_dict_first_free(dict, hash);
+
+	EE_ASSERT(place != (size_t)-1, "HashSet has no free slot");
+
+	dict->key_cpy_fn(ee_dict_key_at(dict, place), key, dict->key_len);
+	dict->ctrl.buffer[place] = hash & 0x7F;
+	dict->count++;
+
+	EED_STAT(dict->stats.inserts++);
+}
+
+// Makes room for 'n' more keys, so a batch never grows halfway through
+EE_INLINE void _ee_hset_reserve(Dict* dict, size_t n)
+{
+	if (dict->old != NULL)
+	{
+		ee_dict_migrate(dict, EE_DICT_MIGRATE_GROUPS);
+	}
+
+	size_t cap = dict->cap;
+
+	while (ee_dict_count(dict) + n > ee_dict_th(cap))
+	{
+		cap *= 2;
+	}
+
+	if (cap != dict->cap)
+	{
+		ee_dict_grow(dict, cap);
+	}
+}
+
+// Returns EE_TRUE if the key was not present yet
+EE_INLINE i32 ee_hset_insert(HashSet* set, const u8* key)
+{
+	EE_ASSERT(set != NULL, "Trying to insert to NULL HashSet");
+	EE_ASSERT(key != NULL, "Trying to insert NULL key");
+
+	Dict* dict = &set->dict;
+
+	_ee_hset_reserve(dict, 1);
+
+	u64 hash = dict->hash_fn(key, dict->key_len);
+
+	if (ee_dict_at_hash(dict, key, hash) != NULL)
+	{
+		return EE_FALSE;
+	}
+
+	_ee_hset_place(dict, key, hash);
+
+	return EE_TRUE;
+}
+
+// Hashes a batch up front with the home groups prefetched, then resolves the keys in order,
+// so duplicates inside a batch are still inserted once
+EE_INLINE size_t _ee_hset_insert_ptrs(Dict* dict, const u8** keys, size_t count)
+{
+	u64 hashes[EE_DICT_BATCH_SIZE];
+	size_t added = 0;
+
+	_ee_hset_reserve(dict, count);
+
+	for (size_t j = 0; j < count; ++j)
+	{
+		u64 hash = dict->hash_fn(keys[j], dict->key_len);
+		size_t group_index = ((hash >> 7) & dict->mask) & EE_GROUP_MASK;
+
+		hashes[j] = hash;
+
+		eed_prefetch((const char*)&dict->ctrl.buffer[group_index], EED_SIMD_PREFETCH_T0);
+		eed_prefetch((const char*)ee_dict_key_at(dict, group_index), EED_SIMD_PREFETCH_T0);
+	}
+
+	for (size_t j = 0; j < count; ++j)
+	{
+		if (ee_dict_at_hash(dict, keys[j], hashes[j]) != NULL)
+			continue;
+
+		_ee_hset_place(dict, keys[j], hashes[j]);
+		added++;
+	}
+
+	return added;
+}
+
+// Inserts 'n' packed keys, returns how many were not present yet
+EE_INLINE size_t ee_hset_insert_batch(HashSet* set, const u8* keys, size_t n)
+{
+	EE_ASSERT(set != NULL, "Trying to insert to NULL HashSet");
+	EE_ASSERT(keys != NULL || n == 0, "Trying to insert NULL keys");
+
+	Dict* dict = &set->dict;
+
+	const u8* ptrs[EE_DICT_BATCH_SIZE];
+	size_t added = 0;
+
+	for (size_t low = 0; low < n; low += EE_DICT_BATCH_SIZE)
+	{
+		size_t count = ee_min_u64(n - low, EE_DICT_BATCH_SIZE);
+
+		for (size_t j = 0; j < count; ++j)
+		{
+			ptrs[j] = &keys[(low + j) * dict->key_len];
+		}
+
+		added += _ee_hset_insert_ptrs(dict, ptrs, count);
+	}
+
+	return added;
+}
+
+// Key pointers stay valid until the next modification
+EE_INLINE i32 ee_hset_iter_next(DictIter* iter, u8** key_out)
+{
+	u8* val = NULL;
+
+	return ee_dict_iter_next_ptr(iter, key_out, &val);
+}
+
+// 'dst' |= 'src', returns how many keys were added to 'dst'
+EE_INLINE size_t ee_hset_union(HashSet* dst, const HashSet* src)
+{
+	EE_ASSERT(dst != NULL && src != NULL, "Trying to merge NULL HashSet");
+	EE_ASSERT(dst != src, "Trying to merge HashSet with itself");
+	EE_ASSERT(dst->dict.key_len == src->dict.key_len, "Key length mismatch (%zu) vs (%zu)", dst->dict.key_len, src->dict.key_len);
+
+	_ee_hset_reserve(&dst->dict, ee_dict_count(&src->dict));
+
+	const u8* ptrs[EE_DICT_BATCH_SIZE];
+	size_t count = 0;
+	size_t added = 0;
+
+	DictIter iter = ee_dict_iter_new(&src->dict);
+	u8* key = NULL;
+
+	while (ee_hset_iter_next(&iter, &key))
+	{
+		ptrs[count++] = key;
+
+		if (count == EE_DICT_BATCH_SIZE)
+		{
+			added += _ee_hset_insert_ptrs(&dst->dict, ptrs, count);
+			count = 0;
+		}
+	}
+
+	added += _ee_hset_insert_ptrs(&dst->dict, ptrs, count);
+
+	return added;
+}
+
+// 'dst' &= 'src', returns how many keys were removed from 'dst'
+// Live slots of 'dst' are probed in 'src' a batch at a time and the misses are turned into tombstones
+EE_INLINE size_t ee_hset_intersect(HashSet* dst, const HashSet* src)
+{
+	EE_ASSERT(dst != NULL && src != NULL, "Trying to intersect NULL HashSet");
+	EE_ASSERT(dst->dict.key_len == src->dict.key_len, "Key length mismatch (%zu) vs (%zu)", dst->dict.key_len, src->dict.key_len);
+
+	Dict* dict = &dst->dict;
+	const Dict* other = &src->dict;
+
+	if (dst == src)
+	{
+		return 0;
+	}
+
+	if (dict->old != NULL)
+	{
+		ee_dict_migrate(dict, (size_t)-1);
+	}
+
+	size_t slots[EE_DICT_BATCH_SIZE];
+	u64 hashes[EE_DICT_BATCH_SIZE];
+	size_t removed = 0;
+	size_t i = 0;
+
+	while (i < dict->cap)
+	{
+		size_t count = 0;
+
+		for (; i < dict->cap && count < EE_DICT_BATCH_SIZE; ++i)
+		{
+			if (dict->ctrl.buffer[i] & 0x80)
+				continue;
+
+			u64 hash = other->hash_fn(ee_dict_key_at(dict, i), other->key_len);
+			size_t group_index = ((hash >> 7) & other->mask) & EE_GROUP_MASK;
+
+			slots[count] = i;
+			hashes[count] = hash;
+			count++;
+
+			eed_prefetch((const char*)&other->ctrl.buffer[group_index], EED_SIMD_PREFETCH_T0);
+			eed_prefetch((const char*)ee_dict_key_at(other, group_index), EED_SIMD_PREFETCH_T0);
+		}
+
+		for (size_t j = 0; j < count; ++j)
+		{
+			if (ee_dict_at_hash(other, ee_dict_key_at(dict, slots[j]), hashes[j]) != NULL)
+				continue;
+
+			// Not '_ee_dict_erase_slot', a rehash would move slots that are still to be scanned
+			dict->ctrl.buffer[slots[j]] = EE_SLOT_DELETED;
+			dict->count--;
+			removed++;
+		}
+	}
+
+	#ifdef EE_DICT_TOMBS_REHASH
+	dict->tombs += removed;
+
+	if (dict->tombs >= dict->tombs_th)
+	{
+		ee_dict_rehash(dict);
+	}
+	#endif
+
+	return removed;
+}
+
+EE_EXTERN_C_END
+
+#endif // EE_HSET_H
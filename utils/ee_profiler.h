@@ -4,12 +4,30 @@
 #ifdef _WIN32
 #include "windows.h"
 
+typedef LARGE_INTEGER ProfTicks;
+
 #define EE_PROF_GET_TICKS(tick_ptr)                           (QueryPerformanceCounter(tick_ptr))
-#define EE_PROF_GET_FREQ(freq_ptr)                            (QueryPerformanceFrequency(freq_ptr)) 
+#define EE_PROF_GET_FREQ(freq_ptr)                            (QueryPerformanceFrequency(freq_ptr))
 #define EE_PROF_TICKS_TO_SEC(ticks_start, ticks_end, freq)    ((f64)((ticks_end).QuadPart - (ticks_start).QuadPart) / (f64)(freq).QuadPart)
 
 #else
+// Has to come before the first system header of the translation unit, 'ee_core.h' defines it as well
+#if defined(__STRICT_ANSI__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <time.h>
+
+#ifndef CLOCK_MONOTONIC
+#error "ee_profiler.h needs clock_gettime, define _POSIX_C_SOURCE 199309L before the first system header"
+#endif
+
+typedef struct timespec ProfTicks;
+
+#define EE_PROF_GET_TICKS(tick_ptr)                           (clock_gettime(CLOCK_MONOTONIC, tick_ptr))
+#define EE_PROF_GET_FREQ(freq_ptr)                            ((freq_ptr)->tv_sec = 1, (freq_ptr)->tv_nsec = 0)
+#define EE_PROF_TICKS_TO_SEC(ticks_start, ticks_end, freq)    ((f64)((ticks_end).tv_sec - (ticks_start).tv_sec) + (f64)((ticks_end).tv_nsec - (ticks_start).tv_nsec) * 1e-9)
 
 #endif
 
-#endif // EE_PROFILER_H
\ No newline at end of file
+#endif // EE_PROFILER_H
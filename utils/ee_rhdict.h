@@ -0,0 +1,446 @@
+#pragma once
+
+#ifndef EE_RHDICT_H
+#define EE_RHDICT_H
+
+#include "ee_dict.h"
+
+// Default and upper bound of the load threshold, the Dict default is 0.875
+#define EE_RHDICT_LOAD_DEF    (0.95)
+#define EE_RHDICT_LOAD_MAX    (0.99)
+
+// Longest displacement an entry may have, an insert that would push an entry further grows the table instead.
+// Bounds every lookup to that many slots no matter how full the table is, unless the hash collides
+#ifndef EE_RHDICT_MAX_DIST
+#define EE_RHDICT_MAX_DIST    (96)
+#endif
+
+// Hard bound the distance byte can hold. Runs that a grow cannot shorten (keys whose full hashes collide)
+// are placed up to it instead of growing again
+#define EE_RHDICT_DIST_LIMIT    (254)
+
+#if EE_RHDICT_MAX_DIST >= EE_RHDICT_DIST_LIMIT
+#error "EE_RHDICT_MAX_DIST must be below EE_RHDICT_DIST_LIMIT"
+#endif
+
+#define ee_rhdict_new_m(size, key_type, val_type, max_load)    ee_rhdict_new(size, sizeof(key_type), sizeof(val_type), max_load, (DictConfig){ 0 })
+
+// Dense open-addressing map for high load factors: robin-hood linear probing with backward-shift removal.
+// 'dist' holds one byte per slot, 0 for an empty slot and displacement + 1 otherwise. Inserts move richer entries
+// (closer to home) out of the way, so displacements stay short and even, and a lookup stops at the first slot
+// whose entry is closer to home than the probe. Only entries with the probe's exact displacement compare keys.
+// No tombstones, no groups: a slot costs key_len + val_len + 1 bytes, the same as a Dict slot
+typedef struct RhDict
+{
+	AlignedBuffer keys;
+	AlignedBuffer vals;
+	AlignedBuffer dist;
+
+	size_t count;
+	size_t cap;
+	size_t mask;
+	size_t th;
+	f64    max_load;
+
+	// Set once an entry sits past EE_RHDICT_MAX_DIST, a grow did not help so overflows stop growing until the next one
+	i32 long_runs;
+
+	size_t key_len;
+	size_t val_len;
+
+	Allocator allocator;
+	DictHash  hash_fn;
+	DictEq    eq_fn;
+	DictCpy   key_cpy_fn;
+	DictCpy   val_cpy_fn;
+} RhDict;
+
+typedef struct RhDictIter
+{
+	const RhDict* dict;
+	size_t it;
+} RhDictIter;
+
+EE_EXTERN_C_START
+
+EE_INLINE u8* ee_rhdict_key_at(const RhDict* dict, size_t slot)
+{
+	return &dict->keys.buffer[slot * dict->key_len];
+}
+
+EE_INLINE u8* ee_rhdict_val_at(const RhDict* dict, size_t slot)
+{
+	return &dict->vals.buffer[slot * dict->val_len];
+}
+
+EE_INLINE size_t _ee_rhdict_th(size_t cap, f64 max_load)
+{
+	size_t out = (size_t)((f64)cap * max_load);
+
+	// At least one slot stays empty, probes that reach it end
+	return out < cap ? out : cap - 1;
+}
+
+EE_INLINE void _ee_rhdict_alloc(RhDict* dict, size_t cap)
+{
+	dict->keys = ee_aligned_alloc(cap * dict->key_len, EE_MAX_ALIGN, &dict->allocator);
+	dict->vals = ee_aligned_alloc(cap * dict->val_len, EE_MAX_ALIGN, &dict->allocator);
+	dict->dist = ee_aligned_alloc(cap, EE_MAX_ALIGN, &dict->allocator);
+
+	EE_ASSERT(dict->dist.buffer != NULL, "NULL distance buffer");
+
+	memset(dict->dist.buffer, 0, cap);
+
+	dict->cap       = cap;
+	dict->mask      = cap - 1;
+	dict->th        = _ee_rhdict_th(cap, dict->max_load);
+	dict->long_runs = EE_FALSE;
+}
+
+EE_INLINE void _ee_rhdict_free_buffers(RhDict* dict)
+{
+	ee_aligned_free(&dict->keys, &dict->allocator);
+	ee_aligned_free(&dict->vals, &dict->allocator);
+	ee_aligned_free(&dict->dist, &dict->allocator);
+}
+
+// 'max_load' is the occupancy that triggers a grow, in (0, EE_RHDICT_LOAD_MAX], 0 picks EE_RHDICT_LOAD_DEF.
+// Hash, compare and copy functions are picked from 'config' the same way as for a Dict, 'grow' and 'layout' are ignored
+EE_INLINE RhDict ee_rhdict_new(size_t size, size_t key_len, size_t val_len, f64 max_load, DictConfig config)
+{
+	EE_ASSERT(key_len > 0, "Invalid key_len (%zu)", key_len);
+	EE_ASSERT(val_len > 0, "Invalid val_len (%zu), use a HashSet for keys only", val_len);
+	EE_ASSERT(max_load >= 0.0 && max_load <= EE_RHDICT_LOAD_MAX, "Invalid max_load (%f)", max_load);
+
+	RhDict out = { 0 };
+
+	if (max_load == 0.0)
+	{
+		max_load = EE_RHDICT_LOAD_DEF;
+	}
+
+	if (size < EE_DICT_START_SIZE)
+	{
+		size = EE_DICT_START_SIZE;
+	}
+
+	if (config.allocator == NULL)
+	{
+		out.allocator.alloc_fn = ee_default_alloc;
+		out.allocator.realloc_fn = ee_default_realloc;
+		out.allocator.free_fn = ee_default_free;
+		out.allocator.context = NULL;
+	}
+	else
+	{
+		memcpy(&out.allocator, config.allocator, sizeof(Allocator));
+	}
+
+	// Function selection is shared with Dict
+	Dict proto = { 0 };
+
+	proto.key_len = key_len;
+	proto.val_len = val_len;
+
+	_ee_dict_bind_fns(&proto, config);
+
+	out.key_len    = key_len;
+	out.val_len    = val_len;
+	out.max_load   = max_load;
+	out.hash_fn    = proto.hash_fn;
+	out.eq_fn      = proto.eq_fn;
+	out.key_cpy_fn = proto.key_cpy_fn;
+	out.val_cpy_fn = proto.val_cpy_fn;
+
+	_ee_rhdict_alloc(&out, ee_next_pow_2(size));
+
+	return out;
+}
+
+EE_INLINE void ee_rhdict_free(RhDict* dict)
+{
+	EE_ASSERT(dict != NULL, "Trying to free NULL RhDict");
+
+	_ee_rhdict_free_buffers(dict);
+
+	memset(dict, 0, sizeof(RhDict));
+}
+
+EE_INLINE size_t ee_rhdict_count(const RhDict* dict)
+{
+	EE_ASSERT(dict != NULL, "Trying to dereference NULL RhDict");
+
+	return dict->count;
+}
+
+// Bytes held by the table buffers
+EE_INLINE size_t ee_rhdict_mem(const RhDict* dict)
+{
+	EE_ASSERT(dict != NULL, "Trying to dereference NULL RhDict");
+
+	return dict->cap * (dict->key_len + dict->val_len + 1);
+}
+
+EE_INLINE size_t _ee_rhdict_find(const RhDict* dict, const u8* key, u64 hash)
+{
+	const u8* dist = dict->dist.buffer;
+	size_t pos = (hash >> 7) & dict->mask;
+
+	// Displacements are short, the key and value lines around home are loaded alongside the distance byte
+	eed_prefetch((const char*)ee_rhdict_key_at(dict, pos), EED_SIMD_PREFETCH_T0);
+	eed_prefetch((const char*)ee_rhdict_val_at(dict, pos), EED_SIMD_PREFETCH_T0);
+
+	// Past EE_RHDICT_MAX_DIST only with 'long_runs', otherwise an entry closer to home ends the probe first
+	for (u32 d = 1; d <= EE_RHDICT_DIST_LIMIT + 1; ++d)
+	{
+		u8 slot_dist = dist[pos];
+
+		// Empty, or an entry closer to its home than this key would be, robin-hood would have placed the key here
+		if (slot_dist < d)
+			return (size_t)-1;
+
+		if (slot_dist == d && dict->eq_fn(ee_rhdict_key_at(dict, pos), key, dict->key_len))
+			return pos;
+
+		pos = (pos + 1) & dict->mask;
+	}
+
+	return (size_t)-1;
+}
+
+EE_INLINE void ee_rhdict_grow(RhDict* dict, size_t new_cap);
+
+// Robin-hood placement of a key known to be absent, 'key' and 'val' may be overwritten (they carry displaced entries).
+// A carried entry that would pass EE_RHDICT_MAX_DIST grows the table once if 'may_grow' is set, a run the grow
+// did not shorten is placed up to EE_RHDICT_DIST_LIMIT instead. Grows place with 'may_grow' cleared, so they never nest
+EE_INLINE void _ee_rhdict_place(RhDict* dict, u8* key, u8* val, u64 hash, i32 may_grow)
+{
+	u8* temp = (u8*)EE_ALLOCA(dict->key_len + dict->val_len);
+
+	EE_ASSERT(temp != NULL, "Unable to allocate (%zu) on stack", dict->key_len + dict->val_len);
+
+	while (EE_TRUE)
+	{
+		u8* dist = dict->dist.buffer;
+		size_t pos = (hash >> 7) & dict->mask;
+		u32 limit = (may_grow && !dict->long_runs) ? EE_RHDICT_MAX_DIST + 1 : EE_RHDICT_DIST_LIMIT + 1;
+		u32 d = 1;
+
+		for (; d <= limit; ++d)
+		{
+			if (dist[pos] == 0)
+			{
+				dict->key_cpy_fn(ee_rhdict_key_at(dict, pos), key, dict->key_len);
+				dict->val_cpy_fn(ee_rhdict_val_at(dict, pos), val, dict->val_len);
+
+				dist[pos] = (u8)d;
+				dict->count++;
+
+				if (d > EE_RHDICT_MAX_DIST + 1)
+					dict->long_runs = EE_TRUE;
+
+				EE_FREEA(temp);
+				return;
+			}
+
+			// Take the slot from a richer entry and carry that one on
+			if (dist[pos] < d)
+			{
+				u8* slot_key = ee_rhdict_key_at(dict, pos);
+				u8* slot_val = ee_rhdict_val_at(dict, pos);
+				u32 slot_dist = dist[pos];
+
+				memcpy(temp, slot_key, dict->key_len);
+				memcpy(&temp[dict->key_len], slot_val, dict->val_len);
+
+				dict->key_cpy_fn(slot_key, key, dict->key_len);
+				dict->val_cpy_fn(slot_val, val, dict->val_len);
+
+				memcpy(key, temp, dict->key_len);
+				memcpy(val, &temp[dict->key_len], dict->val_len);
+
+				dist[pos] = (u8)d;
+				d = slot_dist;
+			}
+
+			pos = (pos + 1) & dict->mask;
+		}
+
+		// Even the hard bound is taken, the carried entry cannot be stored (full hashes of over 254 keys collide)
+		EE_ASSERT(limit == EE_RHDICT_MAX_DIST + 1, "RhDict run is longer than (%d) slots, the hash function collides", EE_RHDICT_DIST_LIMIT);
+
+		if (limit != EE_RHDICT_MAX_DIST + 1)
+		{
+			EE_FREEA(temp);
+			return;
+		}
+
+		// The carried entry would go past EE_RHDICT_MAX_DIST, it is out of the table so it is placed after the grow
+		hash = dict->hash_fn(key, dict->key_len);
+		may_grow = EE_FALSE;
+
+		ee_rhdict_grow(dict, dict->cap * 2);
+	}
+}
+
+EE_INLINE void ee_rhdict_grow(RhDict* dict, size_t new_cap)
+{
+	EE_ASSERT(dict != NULL, "Trying to grow NULL RhDict");
+	EE_ASSERT(ee_is_pow2(new_cap) && new_cap > dict->count, "Invalid RhDict capacity (%zu)", new_cap);
+
+	RhDict old = *dict;
+
+	u8* key = (u8*)EE_ALLOCA(dict->key_len + dict->val_len);
+
+	EE_ASSERT(key != NULL, "Unable to allocate (%zu) on stack", dict->key_len + dict->val_len);
+
+	_ee_rhdict_alloc(dict, new_cap);
+	dict->count = 0;
+
+	for (size_t i = 0; i < old.cap; ++i)
+	{
+		if (old.dist.buffer[i] == 0)
+			continue;
+
+		memcpy(key, ee_rhdict_key_at(&old, i), dict->key_len);
+		memcpy(&key[dict->key_len], ee_rhdict_val_at(&old, i), dict->val_len);
+
+		_ee_rhdict_place(dict, key, &key[dict->key_len], dict->hash_fn(key, dict->key_len), EE_FALSE);
+	}
+
+	EE_FREEA(key);
+
+	_ee_rhdict_free_buffers(&old);
+}
+
+// Inserts or overwrites, returns EE_TRUE if the key was not present yet
+EE_INLINE i32 ee_rhdict_set(RhDict* dict, const u8* key, const u8* val)
+{
+	EE_ASSERT(dict != NULL, "Trying to insert to NULL RhDict");
+	EE_ASSERT(key != NULL, "Trying to insert NULL key");
+	EE_ASSERT(val != NULL, "Trying to insert NULL value");
+
+	u64 hash = dict->hash_fn(key, dict->key_len);
+	size_t slot = _ee_rhdict_find(dict, key, hash);
+
+	if (slot != (size_t)-1)
+	{
+		dict->val_cpy_fn(ee_rhdict_val_at(dict, slot), val, dict->val_len);
+
+		return EE_FALSE;
+	}
+
+	if (dict->count >= dict->th)
+	{
+		ee_rhdict_grow(dict, dict->cap * 2);
+	}
+
+	// Placement swaps entries through these, the caller's buffers stay untouched
+	u8* carry = (u8*)EE_ALLOCA(dict->key_len + dict->val_len);
+
+	EE_ASSERT(carry != NULL, "Unable to allocate (%zu) on stack", dict->key_len + dict->val_len);
+
+	memcpy(carry, key, dict->key_len);
+	memcpy(&carry[dict->key_len], val, dict->val_len);
+
+	_ee_rhdict_place(dict, carry, &carry[dict->key_len], hash, EE_TRUE);
+
+	EE_FREEA(carry);
+
+	return EE_TRUE;
+}
+
+// Returns a pointer to the value or NULL, valid until the next modification
+EE_INLINE u8* ee_rhdict_at(const RhDict* dict, const u8* key)
+{
+	EE_ASSERT(dict != NULL, "Trying to dereference NULL RhDict");
+	EE_ASSERT(key != NULL, "Trying to dereference NULL key");
+
+	size_t slot = _ee_rhdict_find(dict, key, dict->hash_fn(key, dict->key_len));
+
+	return slot != (size_t)-1 ? ee_rhdict_val_at(dict, slot) : NULL;
+}
+
+EE_INLINE i32 ee_rhdict_contains(const RhDict* dict, const u8* key)
+{
+	return ee_rhdict_at(dict, key) != NULL;
+}
+
+// Backward-shift removal: the following entries that are away from home move back one slot, no tombstones
+EE_INLINE i32 ee_rhdict_remove(RhDict* dict, const u8* key)
+{
+	EE_ASSERT(dict != NULL, "Trying to remove from NULL RhDict");
+	EE_ASSERT(key != NULL, "Trying to remove NULL key");
+
+	size_t pos = _ee_rhdict_find(dict, key, dict->hash_fn(key, dict->key_len));
+
+	if (pos == (size_t)-1)
+	{
+		return EE_FALSE;
+	}
+
+	u8* dist = dict->dist.buffer;
+	size_t next = (pos + 1) & dict->mask;
+
+	while (dist[next] > 1)
+	{
+		dict->key_cpy_fn(ee_rhdict_key_at(dict, pos), ee_rhdict_key_at(dict, next), dict->key_len);
+		dict->val_cpy_fn(ee_rhdict_val_at(dict, pos), ee_rhdict_val_at(dict, next), dict->val_len);
+
+		dist[pos] = (u8)(dist[next] - 1);
+
+		pos = next;
+		next = (next + 1) & dict->mask;
+	}
+
+	dist[pos] = 0;
+	dict->count--;
+
+	return EE_TRUE;
+}
+
+EE_INLINE void ee_rhdict_clear(RhDict* dict)
+{
+	EE_ASSERT(dict != NULL, "Trying to clear NULL RhDict");
+
+	memset(dict->dist.buffer, 0, dict->cap);
+	dict->count     = 0;
+	dict->long_runs = EE_FALSE;
+}
+
+EE_INLINE RhDictIter ee_rhdict_iter_new(const RhDict* dict)
+{
+	RhDictIter out = { 0 };
+
+	out.dict = dict;
+	out.it = 0;
+
+	return out;
+}
+
+// Pointers stay valid until the next modification
+EE_INLINE i32 ee_rhdict_iter_next(RhDictIter* iter, u8** key_out, u8** val_out)
+{
+	const RhDict* dict = iter->dict;
+
+	while (iter->it < dict->cap)
+	{
+		size_t slot = iter->it++;
+
+		if (dict->dist.buffer[slot] == 0)
+			continue;
+
+		*key_out = ee_rhdict_key_at(dict, slot);
+
+		if (val_out != NULL)
+			*val_out = ee_rhdict_val_at(dict, slot);
+
+		return EE_TRUE;
+	}
+
+	return EE_FALSE;
+}
+
+EE_EXTERN_C_END
+
+#endif // EE_RHDICT_H
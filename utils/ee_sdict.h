@@ -0,0 +1,282 @@
+#pragma once
+
+#ifndef EE_SDICT_H
+#define EE_SDICT_H
+
+#include "ee_dict.h"
+#include "ee_array.h"
+
+#ifndef EE_SDICT_SHARDS_DEF
+#define EE_SDICT_SHARDS_DEF    (64)
+#endif
+
+#define EE_SDICT_SHARDS_MAX    (256)
+
+#define ee_sdict_new_conf_m(shards, size, key_type, val_type, config)    ee_sdict_new(shards, size, sizeof(key_type), sizeof(val_type), config)
+#define ee_sdict_def_m(size, key_type, val_type)                          ee_sdict_new(EE_SDICT_SHARDS_DEF, size, sizeof(key_type), sizeof(val_type), (DictConfig){ 0 })
+
+// Writers serialize on 'lock' and keep 'seq' odd while the shard is being modified
+// Readers never take the lock, they snapshot the Dict header, probe it and retry if 'seq' moved
+// Buffers released by a grow are parked in 'retired' so a racing reader never touches freed memory
+typedef struct DictShard
+{
+	EE_ALIGNAS(EE_CACHE_LINE) u32 seq;
+	u32 lock;
+
+	Dict  dict;
+	Array retired;
+
+	Allocator parent;
+} DictShard;
+
+typedef struct ShardedDict
+{
+	AlignedBuffer shards;
+
+	size_t shards_count;
+	size_t shards_mask;
+	size_t key_len;
+	size_t val_len;
+
+	Allocator allocator;
+	DictHash  hash_fn;
+} ShardedDict;
+
+EE_EXTERN_C_START
+
+EE_INLINE void* _ee_sdict_alloc_fn(Allocator* self, size_t size)
+{
+	DictShard* shard = (DictShard*)self->context;
+
+	return shard->parent.alloc_fn(&shard->parent, size);
+}
+
+EE_INLINE void _ee_sdict_free_fn(Allocator* self, void* buffer)
+{
+	DictShard* shard = (DictShard*)self->context;
+
+	if (buffer != NULL)
+		ee_array_push(&shard->retired, (const u8*)&buffer);
+}
+
+EE_INLINE void* _ee_sdict_realloc_fn(Allocator* self, void* buffer, size_t old_size, size_t new_size)
+{
+	void* out = _ee_sdict_alloc_fn(self, new_size);
+
+	if (buffer != NULL)
+	{
+		memcpy(out, buffer, ee_min_u64(old_size, new_size));
+		_ee_sdict_free_fn(self, buffer);
+	}
+
+	return out;
+}
+
+EE_INLINE DictShard* _ee_sdict_shard(const ShardedDict* sdict, u64 hash)
+{
+	// Top bits pick the shard, the Dict itself indexes with the low bits
+	size_t index = (size_t)(hash >> 56) & sdict->shards_mask;
+
+	return &((DictShard*)sdict->shards.buffer)[index];
+}
+
+EE_INLINE void _ee_sdict_write_begin(DictShard* shard)
+{
+	while (ee_atomic_xchg_u32(&shard->lock, 1) != 0)
+	{
+		while (ee_atomic_load_relaxed_u32(&shard->lock) != 0)
+			ee_cpu_pause();
+	}
+
+	ee_atomic_store_u32(&shard->seq, shard->seq + 1);
+	ee_atomic_fence_rel();
+}
+
+EE_INLINE void _ee_sdict_write_end(DictShard* shard)
+{
+	ee_atomic_store_u32(&shard->seq, shard->seq + 1);
+	ee_atomic_store_u32(&shard->lock, 0);
+}
+
+EE_INLINE void _ee_sdict_reclaim_shard(DictShard* shard)
+{
+	for (size_t i = 0; i < ee_array_len(&shard->retired); ++i)
+	{
+		void* buffer = *(void**)ee_array_at(&shard->retired, i);
+		shard->parent.free_fn(&shard->parent, buffer);
+	}
+
+	ee_array_clear(&shard->retired);
+}
+
+EE_INLINE ShardedDict ee_sdict_new(size_t shards, size_t size, size_t key_len, size_t val_len, DictConfig config)
+{
+	EE_ASSERT(ee_is_pow2(shards), "Shards count (%zu) should be power of two", shards);
+	EE_ASSERT(shards <= EE_SDICT_SHARDS_MAX, "Shards count (%zu) exceeds (%d)", shards, EE_SDICT_SHARDS_MAX);
+
+	ShardedDict out = { 0 };
+
+	if (config.allocator == NULL)
+	{
+		out.allocator.alloc_fn = ee_default_alloc;
+		out.allocator.realloc_fn = ee_default_realloc;
+		out.allocator.free_fn = ee_default_free;
+		out.allocator.context = NULL;
+	}
+	else
+	{
+		memcpy(&out.allocator, config.allocator, sizeof(Allocator));
+	}
+
+	out.shards_count = shards;
+	out.shards_mask  = shards - 1;
+	out.key_len      = key_len;
+	out.val_len      = val_len;
+	out.shards       = ee_aligned_alloc(shards * sizeof(DictShard), EE_CACHE_LINE, &out.allocator);
+
+	memset(out.shards.buffer, 0, shards * sizeof(DictShard));
+
+	// Incremental grow keeps a second table reachable through 'old', readers can not snapshot that safely
+	config.grow = EE_DICT_GROW_FULL;
+
+	for (size_t i = 0; i < shards; ++i)
+	{
+		DictShard* shard = &((DictShard*)out.shards.buffer)[i];
+		Allocator shard_allocator = { _ee_sdict_alloc_fn, _ee_sdict_realloc_fn, _ee_sdict_free_fn, shard };
+
+		shard->parent  = out.allocator;
+		shard->retired = ee_array_new(4, sizeof(void*), &out.allocator);
+
+		config.allocator = &shard_allocator;
+		shard->dict = ee_dict_new(size / shards, key_len, val_len, config);
+	}
+
+	out.hash_fn = ((DictShard*)out.shards.buffer)[0].dict.hash_fn;
+
+	return out;
+}
+
+EE_INLINE void ee_sdict_free(ShardedDict* sdict)
+{
+	EE_ASSERT(sdict != NULL, "Trying to free NULL ShardedDict");
+
+	for (size_t i = 0; i < sdict->shards_count; ++i)
+	{
+		DictShard* shard = &((DictShard*)sdict->shards.buffer)[i];
+
+		ee_dict_free(&shard->dict);
+		_ee_sdict_reclaim_shard(shard);
+		ee_array_free(&shard->retired);
+	}
+
+	ee_aligned_free(&sdict->shards, &sdict->allocator);
+	memset(sdict, 0, sizeof(*sdict));
+}
+
+// Frees buffers retired by grows, call only when no reader is inside the ShardedDict
+EE_INLINE void ee_sdict_reclaim(ShardedDict* sdict)
+{
+	EE_ASSERT(sdict != NULL, "Trying to reclaim NULL ShardedDict");
+
+	for (size_t i = 0; i < sdict->shards_count; ++i)
+	{
+		DictShard* shard = &((DictShard*)sdict->shards.buffer)[i];
+
+		_ee_sdict_write_begin(shard);
+		_ee_sdict_reclaim_shard(shard);
+		_ee_sdict_write_end(shard);
+	}
+}
+
+EE_INLINE i32 ee_sdict_set(ShardedDict* sdict, const u8* key, const u8* val)
+{
+	EE_ASSERT(sdict != NULL, "Trying to insert to NULL ShardedDict");
+	EE_ASSERT(key != NULL, "Trying to insert NULL key");
+
+	u64 hash = sdict->hash_fn(key, sdict->key_len);
+	DictShard* shard = _ee_sdict_shard(sdict, hash);
+
+	_ee_sdict_write_begin(shard);
+	i32 out = ee_dict_set(&shard->dict, key, val);
+	_ee_sdict_write_end(shard);
+
+	return out;
+}
+
+EE_INLINE i32 ee_sdict_remove(ShardedDict* sdict, const u8* key)
+{
+	EE_ASSERT(sdict != NULL, "Trying to remove from NULL ShardedDict");
+	EE_ASSERT(key != NULL, "Trying to remove NULL key");
+
+	u64 hash = sdict->hash_fn(key, sdict->key_len);
+	DictShard* shard = _ee_sdict_shard(sdict, hash);
+
+	_ee_sdict_write_begin(shard);
+	i32 out = ee_dict_remove(&shard->dict, key);
+	_ee_sdict_write_end(shard);
+
+	return out;
+}
+
+// Copies the value into 'val_out' (may be NULL), pointers into the table are never handed out
+// because a concurrent writer can move the entry right after the lookup
+EE_INLINE i32 ee_sdict_get(const ShardedDict* sdict, const u8* key, u8* val_out)
+{
+	EE_ASSERT(sdict != NULL, "Trying to dereference NULL ShardedDict");
+	EE_ASSERT(key != NULL, "Trying to dereference NULL key");
+
+	u64 hash = sdict->hash_fn(key, sdict->key_len);
+	DictShard* shard = _ee_sdict_shard(sdict, hash);
+
+	for (;;)
+	{
+		u32 seq = ee_atomic_load_u32(&shard->seq);
+
+		if (seq & 1)
+		{
+			ee_cpu_pause();
+			continue;
+		}
+
+		Dict snapshot;
+		memcpy(&snapshot, &shard->dict, sizeof(Dict));
+
+		// A torn header could pair a new buffer with an old mask, validate it before probing
+		ee_atomic_fence_acq();
+
+		if (ee_atomic_load_relaxed_u32(&shard->seq) != seq)
+			continue;
+
+		u8* val = ee_dict_at_hash(&snapshot, key, hash);
+
+		if (val != NULL && val_out != NULL)
+			memcpy(val_out, val, snapshot.val_len);
+
+		ee_atomic_fence_acq();
+
+		if (ee_atomic_load_relaxed_u32(&shard->seq) == seq)
+			return val != NULL;
+	}
+}
+
+EE_INLINE i32 ee_sdict_contains(const ShardedDict* sdict, const u8* key)
+{
+	return ee_sdict_get(sdict, key, NULL);
+}
+
+// Exact only while there are no concurrent writers
+EE_INLINE size_t ee_sdict_count(const ShardedDict* sdict)
+{
+	EE_ASSERT(sdict != NULL, "Trying to dereference NULL ShardedDict");
+
+	size_t out = 0;
+
+	for (size_t i = 0; i < sdict->shards_count; ++i)
+		out += ((const DictShard*)sdict->shards.buffer)[i].dict.count;
+
+	return out;
+}
+
+EE_EXTERN_C_END
+
+#endif // EE_SDICT_H
@@ -0,0 +1,234 @@
+#pragma once
+
+#ifndef EE_STRDICT_H
+#define EE_STRDICT_H
+
+#include "ee_dict.h"
+#include "ee_arena.h"
+
+#ifndef EE_STRDICT_SLAB_SIZE
+#define EE_STRDICT_SLAB_SIZE    (EE_NKB(64))
+#endif
+
+#define ee_strdict_new_m(size, val_type)    ee_strdict_new(size, sizeof(val_type), (DictConfig){ 0 })
+
+// Slot record, key bytes live in the slab (NUL-terminated) and never move until 'ee_strdict_compact'.
+// The full hash is kept so grows never touch the slab and lookups reject most candidates without reading key bytes
+typedef struct DictStrKey
+{
+	u64         hash;
+	const char* str;
+	size_t      len;
+} DictStrKey;
+
+typedef struct StrDict
+{
+	Dict         dict;
+	Linked_Arena slab;
+
+	// Slab bytes owned by removed keys
+	size_t dead;
+
+	DictHash hash_fn;
+} StrDict;
+
+EE_EXTERN_C_START
+
+// Short keys leave the byte hashes with structured low bits (e.g. "key-1000", "key-1001"), which both
+// the 7-bit tag and the home index come from, so every key hash goes through a final avalanche
+EE_INLINE u64 _ee_strdict_mix(u64 hash)
+{
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ull;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+EE_INLINE u64 _ee_strdict_hash_fn(const u8* key, size_t len)
+{
+	EE_UNUSED(len);
+
+	u64 hash;
+	memcpy(&hash, key, sizeof(hash));
+
+	return hash;
+}
+
+EE_INLINE i32 _ee_strdict_eq_fn(const u8* a, const u8* b, size_t len)
+{
+	EE_UNUSED(len);
+
+	const DictStrKey* key_a = (const DictStrKey*)a;
+	const DictStrKey* key_b = (const DictStrKey*)b;
+
+	return key_a->hash == key_b->hash && key_a->len == key_b->len && memcmp(key_a->str, key_b->str, key_a->len) == 0;
+}
+
+// 'config.hash_fn' hashes the raw key bytes (default 'eed_hash', the function 'ee_hash_cstr_*' wraps),
+// 'config.eq_fn' and 'config.key_cpy_fn' are replaced by the record callbacks
+EE_INLINE StrDict ee_strdict_new(size_t size, size_t val_len, DictConfig config)
+{
+	StrDict out = { 0 };
+
+	out.hash_fn = config.hash_fn == NULL ? eed_hash : config.hash_fn;
+
+	config.hash_fn    = _ee_strdict_hash_fn;
+	config.eq_fn      = _ee_strdict_eq_fn;
+	config.key_cpy_fn = NULL;
+
+	out.dict = ee_dict_new(size, sizeof(DictStrKey), val_len, config);
+	out.slab = ee_linked_arena_new(EE_STRDICT_SLAB_SIZE, EE_NO_REWIND, &out.dict.allocator);
+	out.dead = 0;
+
+	return out;
+}
+
+EE_INLINE void ee_strdict_free(StrDict* sdict)
+{
+	EE_ASSERT(sdict != NULL, "Trying to free NULL StrDict");
+
+	ee_dict_free(&sdict->dict);
+	ee_linked_arena_free(&sdict->slab);
+
+	memset(sdict, 0, sizeof(*sdict));
+}
+
+EE_INLINE DictStrKey ee_strdict_key(const StrDict* sdict, const char* key, size_t len)
+{
+	DictStrKey out = { 0 };
+
+	out.hash = _ee_strdict_mix(sdict->hash_fn((const u8*)key, len));
+	out.str  = key;
+	out.len  = len;
+
+	return out;
+}
+
+EE_INLINE size_t ee_strdict_count(const StrDict* sdict)
+{
+	EE_ASSERT(sdict != NULL, "Trying to dereference NULL StrDict");
+
+	return ee_dict_count(&sdict->dict);
+}
+
+EE_INLINE u8* ee_strdict_at(const StrDict* sdict, const char* key, size_t len)
+{
+	EE_ASSERT(sdict != NULL, "Trying to dereference NULL StrDict");
+	EE_ASSERT(key != NULL || len == 0, "Trying to dereference NULL key");
+
+	DictStrKey probe = ee_strdict_key(sdict, key, len);
+
+	return ee_dict_at_hash(&sdict->dict, (const u8*)&probe, probe.hash);
+}
+
+EE_INLINE u8* ee_strdict_at_cstr(const StrDict* sdict, const char* key)
+{
+	return ee_strdict_at(sdict, key, strlen(key));
+}
+
+EE_INLINE i32 ee_strdict_contains(const StrDict* sdict, const char* key, size_t len)
+{
+	return ee_strdict_at(sdict, key, len) != NULL;
+}
+
+// Overwrites the value of a present key in place, key bytes are copied into the slab only for new keys
+EE_INLINE i32 ee_strdict_set(StrDict* sdict, const char* key, size_t len, const u8* val)
+{
+	EE_ASSERT(sdict != NULL, "Trying to insert to NULL StrDict");
+	EE_ASSERT(key != NULL || len == 0, "Trying to insert NULL key");
+	EE_ASSERT(val != NULL, "Trying to insert NULL value");
+
+	DictStrKey probe = ee_strdict_key(sdict, key, len);
+	u8* val_at = ee_dict_at_hash(&sdict->dict, (const u8*)&probe, probe.hash);
+
+	if (val_at != NULL)
+	{
+		sdict->dict.val_cpy_fn(val_at, val, sdict->dict.val_len);
+
+		return EE_TRUE;
+	}
+
+	char* str = (char*)ee_linked_arena_alloc_al(&sdict->slab, len + 1, 1);
+
+	memcpy(str, key, len);
+	str[len] = '\0';
+
+	probe.str = str;
+
+	return ee_dict_set(&sdict->dict, (const u8*)&probe, val);
+}
+
+EE_INLINE i32 ee_strdict_set_cstr(StrDict* sdict, const char* key, const u8* val)
+{
+	return ee_strdict_set(sdict, key, strlen(key), val);
+}
+
+EE_INLINE i32 ee_strdict_remove(StrDict* sdict, const char* key, size_t len)
+{
+	EE_ASSERT(sdict != NULL, "Trying to remove from NULL StrDict");
+	EE_ASSERT(key != NULL || len == 0, "Trying to remove NULL key");
+
+	DictStrKey probe = ee_strdict_key(sdict, key, len);
+	i32 out = ee_dict_remove(&sdict->dict, (const u8*)&probe);
+
+	if (out)
+		sdict->dead += len + 1;
+
+	return out;
+}
+
+EE_INLINE i32 ee_strdict_remove_cstr(StrDict* sdict, const char* key)
+{
+	return ee_strdict_remove(sdict, key, strlen(key));
+}
+
+// Record pointers stay valid until the next modification, 'str' is NUL-terminated
+EE_INLINE i32 ee_strdict_iter_next(DictIter* iter, const DictStrKey** key_out, u8** val_out)
+{
+	u8* key = NULL;
+	i32 out = ee_dict_iter_next_ptr(iter, &key, val_out);
+
+	if (key_out != NULL)
+		*key_out = (const DictStrKey*)key;
+
+	return out;
+}
+
+// Copies live keys into a fresh slab and releases the old one, records are patched in place without rehashing
+EE_INLINE void ee_strdict_compact(StrDict* sdict)
+{
+	EE_ASSERT(sdict != NULL, "Trying to compact NULL StrDict");
+
+	Dict* dict = &sdict->dict;
+
+	if (dict->old != NULL)
+	{
+		ee_dict_migrate(dict, (size_t)-1);
+	}
+
+	Linked_Arena slab = ee_linked_arena_new(EE_STRDICT_SLAB_SIZE, EE_NO_REWIND, &dict->allocator);
+
+	for (size_t i = 0; i < dict->cap; ++i)
+	{
+		if (dict->ctrl.buffer[i] & 0x80)
+			continue;
+
+		DictStrKey* record = (DictStrKey*)ee_dict_key_at(dict, i);
+		char* str = (char*)ee_linked_arena_alloc_al(&slab, record->len + 1, 1);
+
+		memcpy(str, record->str, record->len + 1);
+		record->str = str;
+	}
+
+	ee_linked_arena_free(&sdict->slab);
+
+	sdict->slab = slab;
+	sdict->dead = 0;
+}
+
+EE_EXTERN_C_END
+
+#endif // EE_STRDICT_H
@@ -268,48 +268,30 @@ EE_INLINE size_t ee_str_find_b(const Str* str, const Str* target, size_t low, si
 
 	size_t target_len = target->top;
 
+	EE_ASSERT(target_len > 0, "Trying to search an empty target");
 	EE_ASSERT(target_len <= high - low, "Target too long for bounds");
 
-	ee_simd_i mask = ee_set1_epi8(target->buffer[0]);
+	SimdFindFn find_8 = ee_simd_kernels()->find_8;
 
+	// Only positions where the whole target fits are candidates
+	size_t last = high - target_len + 1;
 	size_t i = low;
-	size_t upper = (high & ~(EE_SIMD_BYTES - 1));
-	size_t start_block = (low + EE_SIMD_BYTES - 1) & ~(EE_SIMD_BYTES - 1);
 
-	for (; i < start_block && i + target_len <= high; ++i)
+	while (i < last)
 	{
-		if (memcmp(&str->buffer[i], target->buffer, target_len) == 0)
-		{
-			return i;
-		}
-	}
-
-	for (; i < upper; i += EE_SIMD_BYTES)
-	{
-		ee_simd_i group = ee_loadu_si((const ee_simd_i*)&str->buffer[i]);
-		ee_simd_i match = ee_cmpeq_epi8(group, mask);
-		i32 match_mask = ee_movemask_epi8(match);
+		i += find_8((const u8*)&str->buffer[i], last - i, (const u8*)target->buffer);
 
-		while (match_mask)
+		if (i == last)
 		{
-			i32 first = ee_first_bit_u32(match_mask);
-
-			if ((i + first + target_len <= high) &&
-				memcmp(&str->buffer[i + first], target->buffer, target_len) == 0)
-			{
-				return i + first;
-			}
-
-			match_mask &= match_mask - 1;
+			break;
 		}
-	}
 
-	for (; i < high && i + target_len <= high; ++i)
-	{
 		if (memcmp(&str->buffer[i], target->buffer, target_len) == 0)
 		{
 			return i;
 		}
+
+		i++;
 	}
 
 	return EE_STR_INVALID;
@@ -328,55 +310,33 @@ EE_INLINE size_t ee_str_count_b(const Str* str, const Str* target, size_t low, s
 
 	size_t target_len = target->top;
 
+	EE_ASSERT(target_len > 0, "Trying to count an empty target");
 	EE_ASSERT(target_len <= high - low, "Target too long for bounds");
 
-	ee_simd_i mask = ee_set1_epi8(target->buffer[0]);
+	SimdFindFn find_8 = ee_simd_kernels()->find_8;
 
+	size_t last = high - target_len + 1;
 	size_t out = 0;
 	size_t i = low;
-	size_t upper = (high & ~(EE_SIMD_BYTES - 1));
-	size_t start_block = (low + EE_SIMD_BYTES - 1) & ~(EE_SIMD_BYTES - 1);
-
-	for (; i < start_block && i + target_len <= high; ++i)
-	{
-		if (memcmp(&str->buffer[i], target->buffer, target_len) == 0)
-		{
-			out++;
-			i += target_len - 1;
-		}
-	}
 
-	for (; i < upper; i += EE_SIMD_BYTES)
+	// Non-overlapping occurrences, scanning resumes right after each match
+	while (i < last)
 	{
-		ee_simd_i group = ee_loadu_si((const ee_simd_i*)&str->buffer[i]);
-		ee_simd_i match = ee_cmpeq_epi8(group, mask);
-		
-		i32 match_mask = ee_movemask_epi8(match);
+		i += find_8((const u8*)&str->buffer[i], last - i, (const u8*)target->buffer);
 
-		while (match_mask)
+		if (i == last)
 		{
-			i32 first = ee_first_bit_u32(match_mask);
-
-			if ((i + first + target_len <= high) && memcmp(&str->buffer[i + first], target->buffer, target_len) == 0)
-			{
-				out++;
-
-				u64 remove = (1ull << (first + target_len)) - 1ull;
-				match_mask &= ~(i32)remove;
-			}
-			else
-			{
-				match_mask &= match_mask - 1;
-			}
+			break;
 		}
-	}
 
-	for (; i < high && i + target_len <= high; ++i)
-	{
 		if (memcmp(&str->buffer[i], target->buffer, target_len) == 0)
 		{
 			out++;
-			i += target_len - 1;
+			i += target_len;
+		}
+		else
+		{
+			i++;
 		}
 	}
 
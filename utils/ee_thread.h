@@ -1,7 +1,100 @@
 #ifndef EE_THREAD_H
 #define EE_THREAD_H
 
+#include "ee_core.h"
+
+#ifdef _WIN32
 #include "windows.h"
+#else
+#include "pthread.h"
+#include "unistd.h"
+#endif
+
+//
+// OS threads
+//
+
+typedef void (*ThreadFn)(void* context);
+
+typedef struct Thread
+{
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    ThreadFn fn;
+    void* context;
+} Thread;
+
+#ifdef _WIN32
+EE_INLINE DWORD WINAPI _ee_thread_entry(LPVOID context)
+{
+    Thread* thread = (Thread*)context;
+    thread->fn(thread->context);
+
+    return 0;
+}
+#else
+EE_INLINE void* _ee_thread_entry(void* context)
+{
+    Thread* thread = (Thread*)context;
+    thread->fn(thread->context);
+
+    return NULL;
+}
+#endif
+
+EE_INLINE i32 ee_get_cpu_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+
+    return info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return count > 0 ? (i32)count : 1;
+#endif
+}
+
+// 'thread' must stay alive until 'ee_thread_join'
+EE_INLINE void ee_thread_start(Thread* thread, ThreadFn fn, void* context)
+{
+    EE_ASSERT(thread != NULL, "Trying to start NULL Thread");
+    EE_ASSERT(fn != NULL, "Trying to start Thread with NULL function");
+
+    thread->fn = fn;
+    thread->context = context;
+
+#ifdef _WIN32
+    thread->handle = CreateThread(NULL, 0, _ee_thread_entry, thread, 0, NULL);
+    EE_ASSERT(thread->handle != NULL, "Unable to create thread (%lu)", GetLastError());
+#else
+    i32 res = pthread_create(&thread->handle, NULL, _ee_thread_entry, thread);
+    EE_ASSERT(res == 0, "Unable to create thread (%d)", res);
+    EE_UNUSED(res);
+#endif
+}
+
+EE_INLINE void ee_thread_join(Thread* thread)
+{
+    EE_ASSERT(thread != NULL, "Trying to join NULL Thread");
+
+#ifdef _WIN32
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+}
+
+//
+// Fiber dispatcher (Windows only)
+//
+
+#ifdef _WIN32
 
 #include "ee_deq.h"
 
@@ -79,14 +172,6 @@ EE_ALIGNAS(EE_SIMD_BYTES) static DWORD   _id_map[EE_MAX_WORKERS]  = { 0 };
 static CRITICAL_SECTION _deq_cs = { 0 };
 static Dispatcher       _disp   = { 0 };
 
-EE_INLINE i32 ee_get_cpu_count(void)
-{
-    SYSTEM_INFO info;
-    GetSystemInfo(&info);
-
-    return info.dwNumberOfProcessors;
-}
-
 EE_INLINE i32 ee_get_current_id(void)
 {
 #if !EE_W_NUM_SIMD_ROUND_32
@@ -468,4 +553,6 @@ EE_INLINE void ee_mt_wait_all(void)
     }
 }
 
+#endif // _WIN32
+
 #endif // EE_THREAD_H